@@ -22,3 +22,28 @@
 
 #define MB4 BIT(3)
 #define MB5 BIT(4)
+
+/* Mouse move and scroll behaviors */
+/* Speeds are packed as two signed 16-bit values: X in the high half, Y in the low half. */
+#define ZMK_MOUSE_MOVE_X(hor) (((hor)&0xFFFF) << 16)
+#define ZMK_MOUSE_MOVE_Y(vert) ((vert)&0xFFFF)
+
+/* Pointer speed in pixels per second */
+#ifndef ZMK_MOUSE_DEFAULT_MOVE_VAL
+#define ZMK_MOUSE_DEFAULT_MOVE_VAL 600
+#endif
+
+/* Scroll speed in wheel detents per second */
+#ifndef ZMK_MOUSE_DEFAULT_SCRL_VAL
+#define ZMK_MOUSE_DEFAULT_SCRL_VAL 10
+#endif
+
+#define MOVE_UP ZMK_MOUSE_MOVE_Y(-ZMK_MOUSE_DEFAULT_MOVE_VAL)
+#define MOVE_DOWN ZMK_MOUSE_MOVE_Y(ZMK_MOUSE_DEFAULT_MOVE_VAL)
+#define MOVE_LEFT ZMK_MOUSE_MOVE_X(-ZMK_MOUSE_DEFAULT_MOVE_VAL)
+#define MOVE_RIGHT ZMK_MOUSE_MOVE_X(ZMK_MOUSE_DEFAULT_MOVE_VAL)
+
+#define SCRL_UP ZMK_MOUSE_MOVE_Y(ZMK_MOUSE_DEFAULT_SCRL_VAL)
+#define SCRL_DOWN ZMK_MOUSE_MOVE_Y(-ZMK_MOUSE_DEFAULT_SCRL_VAL)
+#define SCRL_LEFT ZMK_MOUSE_MOVE_X(-ZMK_MOUSE_DEFAULT_SCRL_VAL)
+#define SCRL_RIGHT ZMK_MOUSE_MOVE_X(ZMK_MOUSE_DEFAULT_SCRL_VAL)
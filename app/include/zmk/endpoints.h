@@ -63,6 +63,15 @@ int zmk_endpoint_instance_to_index(struct zmk_endpoint_instance endpoint);
 int zmk_endpoints_select_transport(enum zmk_transport transport);
 int zmk_endpoints_toggle_transport(void);
 
+/**
+ * Enables or disables mirroring. While mirroring, reports are sent to both USB and the active BLE
+ * profile whenever both are ready, instead of only to the selected endpoint. The selected endpoint
+ * is still used for any per-endpoint state, such as HID indicators.
+ */
+int zmk_endpoints_set_mirror(bool mirror);
+int zmk_endpoints_toggle_mirror(void);
+bool zmk_endpoints_is_mirroring(void);
+
 /**
  * Gets the currently-selected endpoint.
  */
@@ -15,7 +15,12 @@ struct zmk_position_state_changed {
     uint8_t source;
     uint32_t position;
     bool state;
+    /** Uptime in milliseconds when the key was read. */
     int64_t timestamp;
+#if IS_ENABLED(CONFIG_ZMK_POSITION_TIMESTAMP_TICKS)
+    /** Uptime in ticks when the key was read. */
+    int64_t timestamp_ticks;
+#endif
 };
 
 ZMK_EVENT_DECLARE(zmk_position_state_changed);
@@ -0,0 +1,18 @@
+/*
+ * Copyright (c) 2023 The ZMK Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#pragma once
+
+#include <zephyr/kernel.h>
+#include <zmk/event_manager.h>
+#include <zmk/split/stats.h>
+
+struct zmk_split_link_stats_changed {
+    uint8_t link;
+    struct zmk_split_link_stats stats;
+};
+
+ZMK_EVENT_DECLARE(zmk_split_link_stats_changed);
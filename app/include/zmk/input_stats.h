@@ -0,0 +1,36 @@
+/*
+ * Copyright (c) 2023 The ZMK Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#pragma once
+
+#include <zephyr/kernel.h>
+
+struct zmk_input_stats {
+    // Key changes handled since the last reset.
+    uint32_t events;
+    // Worst-case time from a key being read to its position event being handled.
+    uint32_t max_latency_us;
+    // Stack size and worst-case usage of the thread handling key input.
+    size_t stack_size;
+    size_t stack_used;
+};
+
+#if IS_ENABLED(CONFIG_ZMK_INPUT_STATS)
+
+/**
+ * Record that a key change read at @p read_ticks, from k_uptime_ticks(), has been handled.
+ */
+void zmk_input_stats_record(int64_t read_ticks);
+
+int zmk_input_stats_get(struct zmk_input_stats *stats);
+
+void zmk_input_stats_reset(void);
+
+#else
+
+static inline void zmk_input_stats_record(int64_t read_ticks) {}
+
+#endif // IS_ENABLED(CONFIG_ZMK_INPUT_STATS)
@@ -6,7 +6,56 @@
 
 #pragma once
 
+#include <zephyr/kernel.h>
 #include <dt-bindings/zmk/mouse.h>
+#include <zmk/endpoints_types.h>
 
 typedef uint8_t zmk_mouse_button_flags_t;
 typedef uint16_t zmk_mouse_button_t;
+
+// Scroll distances are tracked in fractions of a wheel detent so that hosts which enable high
+// resolution scrolling receive every step, while other hosts receive whole detents.
+#define ZMK_MOUSE_SCROLL_UNITS_PER_DETENT 120
+
+struct zmk_mouse_vector {
+    int16_t x;
+    int16_t y;
+};
+
+struct zmk_mouse_acceleration_config {
+    uint16_t delay_ms;
+    uint16_t time_to_max_speed_ms;
+    uint8_t acceleration_exponent;
+};
+
+/**
+ * Queue relative pointer movement for the next mouse report. Movement is accumulated and sent at
+ * most once per report interval of the selected endpoint.
+ */
+int zmk_mouse_add_movement(int32_t dx, int32_t dy);
+
+/**
+ * Queue scrolling for the next mouse report, in units of
+ * 1/ZMK_MOUSE_SCROLL_UNITS_PER_DETENT of a wheel detent. Positive y scrolls up, positive x
+ * scrolls right.
+ */
+int zmk_mouse_add_scroll(int32_t dx, int32_t dy);
+
+#if IS_ENABLED(CONFIG_ZMK_MOUSE_SMOOTH_SCROLLING)
+
+struct zmk_hid_mouse_resolution_feature_report_body;
+
+struct zmk_mouse_resolution_multipliers {
+    uint8_t wheel;
+    uint8_t hor_wheel;
+};
+
+struct zmk_mouse_resolution_multipliers zmk_mouse_resolution_multipliers_get_current_profile(void);
+struct zmk_mouse_resolution_multipliers
+zmk_mouse_resolution_multipliers_get_profile(struct zmk_endpoint_instance endpoint);
+
+void zmk_mouse_resolution_multipliers_process_report(
+    const struct zmk_hid_mouse_resolution_feature_report_body *report,
+    struct zmk_endpoint_instance endpoint);
+
+#endif // IS_ENABLED(CONFIG_ZMK_MOUSE_SMOOTH_SCROLLING)
@@ -30,3 +30,12 @@ struct zmk_sensor_channel_data {
     struct sensor_value value;
     enum sensor_channel channel;
 } __packed;
+
+/**
+ * Add sensor data to earlier data of the same channels, so data that was not handled yet can be
+ * combined instead of queued.
+ *
+ * @retval false if the channels differ. The earlier data is left unchanged.
+ */
+bool zmk_sensor_channel_data_add(struct zmk_sensor_channel_data *total, size_t total_size,
+                                 const struct zmk_sensor_channel_data *data, size_t data_size);
@@ -18,6 +18,35 @@ struct sensor_event {
     struct zmk_sensor_channel_data channel_data[ZMK_SENSOR_EVENT_MAX_CHANNELS];
 } __packed;
 
+// Each position events notification starts with this header, followed by one or more events.
+struct zmk_split_position_events_header {
+    // Uptime of the peripheral in milliseconds when the last event in the notification happened,
+    // truncated to 32 bits. Translated to the central's clock once the clocks are synchronized.
+    uint32_t timestamp;
+    // Milliseconds between the last event in the notification and sending it, saturated at
+    // UINT16_MAX. Used until the clocks are synchronized, e.g. for events that happened while the
+    // peripheral was reconnecting.
+    uint16_t age;
+} __packed;
+
+// Set in zmk_split_position_event.position if the position was pressed.
+#define ZMK_SPLIT_POSITION_EVENT_PRESSED BIT(15)
+#define ZMK_SPLIT_POSITION_EVENT_MAX_POSITIONS ZMK_SPLIT_POSITION_EVENT_PRESSED
+
+// A single key position change, as sent on the position events characteristic. Several of these
+// are packed into each notification, in the order the changes happened on the peripheral.
+struct zmk_split_position_event {
+    // Incremented for every event, so the central can detect events that were dropped.
+    uint8_t sequence;
+    // The key position, with ZMK_SPLIT_POSITION_EVENT_PRESSED set if it was pressed.
+    uint16_t position;
+    // Milliseconds since the previous event, saturated at UINT16_MAX.
+    uint16_t dt;
+} __packed;
+
+// Payload of the legacy run behavior characteristic, which invokes a behavior by name. Its layout
+// is shared with older firmware, so it only fits positions up to UINT8_MAX; larger positions need
+// the behaviors characteristic.
 struct zmk_split_run_behavior_data {
     uint8_t position;
     uint8_t state;
@@ -30,8 +59,22 @@ struct zmk_split_run_behavior_payload {
     char behavior_dev[ZMK_SPLIT_RUN_BEHAVIOR_DEV_LEN];
 } __packed;
 
-int zmk_split_bt_position_pressed(uint8_t position);
-int zmk_split_bt_position_released(uint8_t position);
+// Set in zmk_split_run_behavior_indexed.behavior if the behavior is pressed.
+#define ZMK_SPLIT_RUN_BEHAVIOR_PRESSED BIT(15)
+
+// A behavior invocation, as written to the behaviors characteristic. Several of these can be
+// packed into a single write.
+struct zmk_split_run_behavior_indexed {
+    // Index of the behavior in the peripheral's behavior table, with ZMK_SPLIT_RUN_BEHAVIOR_PRESSED
+    // set if it is pressed.
+    uint16_t behavior;
+    uint16_t position;
+    uint32_t param1;
+    uint32_t param2;
+} __packed;
+
+int zmk_split_bt_position_pressed(uint32_t position, int64_t timestamp);
+int zmk_split_bt_position_released(uint32_t position, int64_t timestamp);
 int zmk_split_bt_sensor_triggered(uint8_t sensor_index,
                                   const struct zmk_sensor_channel_data channel_data[],
                                   size_t channel_data_size);
@@ -0,0 +1,62 @@
+/*
+ * Copyright (c) 2023 The ZMK Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#pragma once
+
+#include <zmk/behavior.h>
+#include <zmk/events/sensor_event.h>
+
+#if IS_ENABLED(CONFIG_ZMK_SPLIT_PERIPHERAL_HID_INDICATORS)
+#include <zmk/hid_indicators_types.h>
+#endif // IS_ENABLED(CONFIG_ZMK_SPLIT_PERIPHERAL_HID_INDICATORS)
+
+#if IS_ENABLED(CONFIG_ZMK_SPLIT_BLE)
+#define ZMK_SPLIT_CENTRAL_PERIPHERAL_COUNT CONFIG_ZMK_SPLIT_BLE_CENTRAL_PERIPHERALS
+#else
+#define ZMK_SPLIT_CENTRAL_PERIPHERAL_COUNT 1
+#endif
+
+/**
+ * Invoke a behavior on the given peripheral, using whichever split transport is enabled.
+ */
+int zmk_split_central_invoke_behavior(uint8_t source, struct zmk_behavior_binding *binding,
+                                      struct zmk_behavior_binding_event event, bool state);
+
+#if IS_ENABLED(CONFIG_ZMK_SPLIT_PERIPHERAL_HID_INDICATORS)
+
+int zmk_split_central_update_hid_indicator(zmk_hid_indicators_t indicators);
+
+#endif // IS_ENABLED(CONFIG_ZMK_SPLIT_PERIPHERAL_HID_INDICATORS)
+
+/**
+ * Queue a position state change received from a peripheral. Safe to call from any context, but
+ * only one context may queue events for each peripheral. The events are raised from the input
+ * work queue once zmk_split_central_position_events_ready() is called.
+ *
+ * @retval -ENOMEM if the peripheral's queue is full. The event is dropped and counted, and the
+ * transport should report the position again once the queue has drained, see
+ * zmk_split_transport_central_api.position_events_drained.
+ */
+int zmk_split_central_position_state_changed(uint8_t source, uint32_t position, bool pressed,
+                                             int64_t timestamp);
+
+/**
+ * Schedule raising the queued position state changes. Call it once after queuing all events of a
+ * message from a peripheral.
+ */
+void zmk_split_central_position_events_ready(void);
+
+/**
+ * @retval The number of position state changes of the given peripheral dropped because its queue
+ * was full.
+ */
+uint32_t zmk_split_central_dropped_position_events(uint8_t source);
+
+/**
+ * Queue a sensor event received from a peripheral. Safe to call from any context; the event is
+ * raised from the system work queue.
+ */
+void zmk_split_central_sensor_event(uint8_t source, const struct zmk_sensor_event *ev);
@@ -0,0 +1,85 @@
+/*
+ * Copyright (c) 2023 The ZMK Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#pragma once
+
+#include <zephyr/kernel.h>
+
+#if IS_ENABLED(CONFIG_ZMK_SPLIT_ROLE_CENTRAL)
+#include <zmk/split/central.h>
+#define ZMK_SPLIT_STATS_LINK_COUNT ZMK_SPLIT_CENTRAL_PERIPHERAL_COUNT
+#else
+// A peripheral only has the link to the central.
+#define ZMK_SPLIT_STATS_LINK_COUNT 1
+#define ZMK_SPLIT_STATS_CENTRAL_LINK 0
+#endif
+
+// Reported as the RSSI of a link when it is not known, as defined by the Bluetooth specification.
+#define ZMK_SPLIT_STATS_RSSI_UNKNOWN 127
+
+enum zmk_split_stat {
+    // Notifications or messages sent to the other half.
+    ZMK_SPLIT_STAT_TX,
+    // Notifications or messages received from the other half.
+    ZMK_SPLIT_STAT_RX,
+    // Failed or repeated sends, such as GATT write or notify errors and retransmissions.
+    ZMK_SPLIT_STAT_TX_ERROR,
+    // Events dropped because a queue was full.
+    ZMK_SPLIT_STAT_QUEUE_DROP,
+    // Connection parameter updates.
+    ZMK_SPLIT_STAT_CONN_PARAM_UPDATE,
+    ZMK_SPLIT_STAT_COUNT,
+};
+
+struct zmk_split_link_stats {
+    uint32_t counts[ZMK_SPLIT_STAT_COUNT];
+    int8_t rssi;
+    // Estimated one-way latency of the link in microseconds, or -1 if not known.
+    int32_t latency_us;
+};
+
+/**
+ * Refreshes statistics of a link that the transport has to ask for, such as the RSSI. Called from
+ * the low priority work queue, so it may wait for the controller.
+ */
+typedef void (*zmk_split_stats_refresh_cb)(uint8_t link);
+
+#if IS_ENABLED(CONFIG_ZMK_SPLIT_STATS)
+
+void zmk_split_stats_inc(uint8_t link, enum zmk_split_stat stat);
+
+void zmk_split_stats_set_rssi(uint8_t link, int8_t rssi);
+
+void zmk_split_stats_set_latency(uint8_t link, int32_t latency_us);
+
+/**
+ * Start refreshing the statistics of a link that came up every CONFIG_ZMK_SPLIT_STATS_INTERVAL
+ * milliseconds. @p refresh may be NULL.
+ */
+void zmk_split_stats_link_up(uint8_t link, zmk_split_stats_refresh_cb refresh);
+
+/**
+ * Forget the RSSI and latency of a link that went down. The counters are kept.
+ */
+void zmk_split_stats_link_down(uint8_t link);
+
+int zmk_split_stats_get(uint8_t link, struct zmk_split_link_stats *stats);
+
+void zmk_split_stats_reset(void);
+
+#else
+
+static inline void zmk_split_stats_inc(uint8_t link, enum zmk_split_stat stat) {}
+
+static inline void zmk_split_stats_set_rssi(uint8_t link, int8_t rssi) {}
+
+static inline void zmk_split_stats_set_latency(uint8_t link, int32_t latency_us) {}
+
+static inline void zmk_split_stats_link_up(uint8_t link, zmk_split_stats_refresh_cb refresh) {}
+
+static inline void zmk_split_stats_link_down(uint8_t link) {}
+
+#endif // IS_ENABLED(CONFIG_ZMK_SPLIT_STATS)
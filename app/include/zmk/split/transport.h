@@ -0,0 +1,79 @@
+/*
+ * Copyright (c) 2023 The ZMK Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#pragma once
+
+#include <zephyr/sys/iterable_sections.h>
+
+#include <zmk/behavior.h>
+#include <zmk/hid_indicators_types.h>
+#include <zmk/events/sensor_event.h>
+
+/**
+ * Operations the central performs on its peripherals. Messages received from the peripherals are
+ * passed on with zmk_split_central_position_state_changed() and zmk_split_central_sensor_event().
+ */
+struct zmk_split_transport_central_api {
+    int (*invoke_behavior)(uint8_t source, struct zmk_behavior_binding *binding,
+                           struct zmk_behavior_binding_event event, bool state);
+    // May be NULL if the transport cannot forward HID indicators.
+    int (*update_hid_indicator)(zmk_hid_indicators_t indicators);
+    // May be NULL. Called from the input work queue once the queued position events were raised,
+    // so a transport that had events dropped can catch up on the peripheral's position state.
+    void (*position_events_drained)(uint8_t source);
+};
+
+/**
+ * Operations a peripheral performs to report its local events to the central.
+ */
+struct zmk_split_transport_peripheral_api {
+    int (*send_position_event)(uint32_t position, bool pressed, int64_t timestamp);
+    // May be NULL if the transport cannot forward sensor events.
+    int (*send_sensor_event)(const struct zmk_sensor_event *ev);
+};
+
+struct zmk_split_transport_central {
+    const char *name;
+    const struct zmk_split_transport_central_api *api;
+};
+
+struct zmk_split_transport_peripheral {
+    const char *name;
+    const struct zmk_split_transport_peripheral_api *api;
+};
+
+/**
+ * Registers @p api_ptr as the central side of the split transport @p name. Only one transport is
+ * expected to be registered for each role; the Kconfig choice ZMK_SPLIT_TRANSPORT selects which.
+ */
+#define ZMK_SPLIT_TRANSPORT_CENTRAL_REGISTER(name, api_ptr)                                        \
+    static const STRUCT_SECTION_ITERABLE(zmk_split_transport_central,                              \
+                                         _CONCAT(zmk_split_transport_central_, name)) = {          \
+        .name = STRINGIFY(name),                                                                   \
+        .api = api_ptr,                                                                            \
+    }
+
+/**
+ * Registers @p api_ptr as the peripheral side of the split transport @p name.
+ */
+#define ZMK_SPLIT_TRANSPORT_PERIPHERAL_REGISTER(name, api_ptr)                                     \
+    static const STRUCT_SECTION_ITERABLE(zmk_split_transport_peripheral,                           \
+                                         _CONCAT(zmk_split_transport_peripheral_, name)) = {       \
+        .name = STRINGIFY(name),                                                                   \
+        .api = api_ptr,                                                                            \
+    }
+
+/**
+ * @retval The registered central transport.
+ * @retval NULL if no split transport is enabled for the central role.
+ */
+const struct zmk_split_transport_central *zmk_split_transport_central_get(void);
+
+/**
+ * @retval The registered peripheral transport.
+ * @retval NULL if no split transport is enabled for the peripheral role.
+ */
+const struct zmk_split_transport_peripheral *zmk_split_transport_peripheral_get(void);
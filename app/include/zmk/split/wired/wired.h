@@ -0,0 +1,83 @@
+/*
+ * Copyright (c) 2023 The ZMK Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#pragma once
+
+#include <zephyr/kernel.h>
+
+#include <zmk/matrix.h>
+#include <zmk/sensors.h>
+#include <zmk/events/sensor_event.h>
+
+// Every frame is COBS encoded and terminated by a zero byte. Before encoding, it consists of the
+// message type, a sequence number, the message payload and a CRC-16/CCITT of everything before it.
+//
+// Each message other than an acknowledgement is acknowledged by an ACK frame carrying its sequence
+// number. Only one message is in flight at a time, and it is sent again if no acknowledgement
+// arrives in time. A message received twice, because its acknowledgement was lost, is only
+// acknowledged again.
+enum zmk_split_wired_msg_type {
+    ZMK_SPLIT_WIRED_MSG_ACK,
+    // Sent by the central to (re)start the link. The central forgets the sequence number it last
+    // received and the peripheral takes the one of the hello, so the first message after it is
+    // never mistaken for a repeat. The sequence numbers sent keep counting on.
+    ZMK_SPLIT_WIRED_MSG_HELLO,
+    // Sent by the central when the link has been idle, to notice the peripheral going away.
+    ZMK_SPLIT_WIRED_MSG_PING,
+    ZMK_SPLIT_WIRED_MSG_POSITION_EVENT,
+    ZMK_SPLIT_WIRED_MSG_POSITION_STATE,
+    ZMK_SPLIT_WIRED_MSG_SENSOR_EVENT,
+    ZMK_SPLIT_WIRED_MSG_RUN_BEHAVIOR,
+    ZMK_SPLIT_WIRED_MSG_HID_INDICATORS,
+};
+
+// Set in zmk_split_wired_position_event.position if the position was pressed.
+#define ZMK_SPLIT_WIRED_POSITION_PRESSED BIT(15)
+
+struct zmk_split_wired_position_event {
+    uint16_t position;
+} __packed;
+
+struct zmk_split_wired_sensor_event {
+    uint8_t sensor_index;
+    uint8_t channel_data_size;
+    struct zmk_sensor_channel_data channel_data[ZMK_SENSOR_EVENT_MAX_CHANNELS];
+} __packed;
+
+// Followed by the behavior name, without a null terminator, up to the end of the payload.
+struct zmk_split_wired_run_behavior {
+    uint16_t position;
+    uint8_t state;
+    uint32_t param1;
+    uint32_t param2;
+} __packed;
+
+#define ZMK_SPLIT_WIRED_BEHAVIOR_NAME_MAX_LEN 32
+
+#define ZMK_SPLIT_WIRED_POSITION_STATE_LEN DIV_ROUND_UP(ZMK_KEYMAP_LEN, 8)
+
+#define ZMK_SPLIT_WIRED_MAX_PAYLOAD_LEN                                                            \
+    MAX(ZMK_SPLIT_WIRED_POSITION_STATE_LEN,                                                        \
+        MAX(sizeof(struct zmk_split_wired_sensor_event),                                           \
+            sizeof(struct zmk_split_wired_run_behavior) + ZMK_SPLIT_WIRED_BEHAVIOR_NAME_MAX_LEN))
+
+typedef void (*zmk_split_wired_receive_cb)(uint8_t type, const uint8_t *data, size_t len);
+typedef void (*zmk_split_wired_link_cb)(bool connected);
+
+/**
+ * Start the link to the other half. Both callbacks are called from the wired split work queue.
+ */
+int zmk_split_wired_init(zmk_split_wired_receive_cb receive_cb, zmk_split_wired_link_cb link_cb);
+
+/**
+ * Queue a message to be sent reliably to the other half.
+ *
+ * @retval -ENOTCONN if the link is down. The message is dropped.
+ * @retval -ENOMSG if the queue is full. The message is dropped, messages already queued are kept.
+ */
+int zmk_split_wired_send(uint8_t type, const void *data, size_t len);
+
+bool zmk_split_wired_is_connected(void);
@@ -1 +1,7 @@
 struct k_work_q *zmk_workqueue_lowprio_work_q(void);
+
+/**
+ * The work queue that handles key input, from scanning through to HID reports. This is the system
+ * work queue unless CONFIG_ZMK_INPUT_WORK_QUEUE is enabled.
+ */
+struct k_work_q *zmk_workqueue_input_work_q(void);
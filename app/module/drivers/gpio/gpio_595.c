@@ -19,6 +19,8 @@
 #include <zephyr/drivers/gpio.h>
 #include <zephyr/drivers/spi.h>
 
+#include <drivers/gpio_595.h>
+
 #define LOG_LEVEL CONFIG_GPIO_LOG_LEVEL
 #include <zephyr/logging/log.h>
 LOG_MODULE_REGISTER(gpio_595);
@@ -38,9 +40,16 @@ struct reg_595_drv_data {
     /* gpio_driver_data needs to be first */
     struct gpio_driver_config data;
 
-    struct k_sem lock;
+    /* Recursive, so pins can be set while the same thread holds a transaction open */
+    struct k_mutex lock;
 
+    /* Desired state of the outputs */
     uint32_t gpio_cache;
+    /* State last written to the registers, valid once written is set */
+    uint32_t reg_state;
+    bool written;
+    /* Nesting depth of gpio_595_begin() calls; writes are deferred while non-zero */
+    uint8_t transaction_depth;
 };
 
 static int reg_595_write_registers(const struct device *dev, uint32_t value) {
@@ -48,6 +57,13 @@ static int reg_595_write_registers(const struct device *dev, uint32_t value) {
     struct reg_595_drv_data *const drv_data = (struct reg_595_drv_data *const)dev->data;
     int ret = 0;
 
+    drv_data->gpio_cache = value;
+
+    /* Skip the transfer while buffering, or if the registers already hold the value */
+    if (drv_data->transaction_depth > 0 || (drv_data->written && drv_data->reg_state == value)) {
+        return 0;
+    }
+
     uint8_t nwrite = config->ngpios / 8;
     uint32_t reg_data = sys_cpu_to_be32(value);
 
@@ -68,7 +84,8 @@ static int reg_595_write_registers(const struct device *dev, uint32_t value) {
         return ret;
     }
 
-    drv_data->gpio_cache = value;
+    drv_data->reg_state = value;
+    drv_data->written = true;
     return 0;
 }
 
@@ -121,14 +138,14 @@ static int reg_595_port_set_masked_raw(const struct device *dev, uint32_t mask,
         return -EWOULDBLOCK;
     }
 
-    k_sem_take(&drv_data->lock, K_FOREVER);
+    k_mutex_lock(&drv_data->lock, K_FOREVER);
 
     buf = drv_data->gpio_cache;
     buf = (buf & ~mask) | (mask & value);
 
     ret = reg_595_write_registers(dev, buf);
 
-    k_sem_give(&drv_data->lock);
+    k_mutex_unlock(&drv_data->lock);
     return ret;
 }
 
@@ -150,14 +167,14 @@ static int reg_595_port_toggle_bits(const struct device *dev, uint32_t mask) {
         return -EWOULDBLOCK;
     }
 
-    k_sem_take(&drv_data->lock, K_FOREVER);
+    k_mutex_lock(&drv_data->lock, K_FOREVER);
 
     buf = drv_data->gpio_cache;
     buf ^= mask;
 
     ret = reg_595_write_registers(dev, buf);
 
-    k_sem_give(&drv_data->lock);
+    k_mutex_unlock(&drv_data->lock);
     return ret;
 }
 
@@ -170,6 +187,46 @@ static const struct gpio_driver_api api_table = {
     .port_toggle_bits = reg_595_port_toggle_bits,
 };
 
+int gpio_595_begin(const struct device *dev) {
+    struct reg_595_drv_data *const drv_data = (struct reg_595_drv_data *const)dev->data;
+
+    if (dev->api != &api_table) {
+        return -ENOTSUP;
+    }
+
+    /* Can't do SPI bus operations from an ISR */
+    if (k_is_in_isr()) {
+        return -EWOULDBLOCK;
+    }
+
+    /* Held until the matching commit, so other threads can't write a half-built state */
+    k_mutex_lock(&drv_data->lock, K_FOREVER);
+    drv_data->transaction_depth++;
+
+    return 0;
+}
+
+int gpio_595_commit(const struct device *dev) {
+    struct reg_595_drv_data *const drv_data = (struct reg_595_drv_data *const)dev->data;
+    int ret = 0;
+
+    if (dev->api != &api_table) {
+        return -ENOTSUP;
+    }
+
+    /* Can't do SPI bus operations from an ISR */
+    if (k_is_in_isr()) {
+        return -EWOULDBLOCK;
+    }
+
+    if (--drv_data->transaction_depth == 0) {
+        ret = reg_595_write_registers(dev, drv_data->gpio_cache);
+    }
+
+    k_mutex_unlock(&drv_data->lock);
+    return ret;
+}
+
 /**
  * @brief Initialization function of 595
  *
@@ -185,7 +242,7 @@ static int reg_595_init(const struct device *dev) {
         return -ENODEV;
     }
 
-    k_sem_init(&drv_data->lock, 1, 1);
+    k_mutex_init(&drv_data->lock);
 
     return 0;
 }
@@ -0,0 +1,421 @@
+/*
+ * Copyright (c) 2023 The ZMK Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+/**
+ * @file Keyboard scan driver for chained 74HC165 parallel-in shift registers read over SPI.
+ */
+
+#include "kscan_gpio_work_q.h"
+
+#include <zephyr/device.h>
+#include <zephyr/devicetree.h>
+#include <zephyr/drivers/gpio.h>
+#include <zephyr/drivers/kscan.h>
+#include <zephyr/drivers/spi.h>
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/pm/device.h>
+#include <zephyr/sys/byteorder.h>
+#include <zephyr/sys/util.h>
+
+#include <drivers/kscan_batch.h>
+#include <zmk/debounce.h>
+
+LOG_MODULE_DECLARE(zmk, CONFIG_ZMK_LOG_LEVEL);
+
+#define DT_DRV_COMPAT zmk_kscan_165
+
+#define INST_DEBOUNCE_ALGORITHM(n) DT_INST_ENUM_IDX(n, debounce_algorithm)
+
+#if CONFIG_ZMK_KSCAN_DEBOUNCE_PRESS_MS >= 0
+#define INST_DEBOUNCE_PRESS_MS(n) CONFIG_ZMK_KSCAN_DEBOUNCE_PRESS_MS
+#else
+#define INST_DEBOUNCE_PRESS_MS(n) DT_INST_PROP(n, debounce_press_ms)
+#endif
+
+#if CONFIG_ZMK_KSCAN_DEBOUNCE_RELEASE_MS >= 0
+#define INST_DEBOUNCE_RELEASE_MS(n) CONFIG_ZMK_KSCAN_DEBOUNCE_RELEASE_MS
+#else
+#define INST_DEBOUNCE_RELEASE_MS(n) DT_INST_PROP(n, debounce_release_ms)
+#endif
+
+#define INST_INPUTS_LEN(n) DT_INST_PROP(n, ngpios)
+#define INST_GROUPS_LEN(n) DIV_ROUND_UP(INST_INPUTS_LEN(n), ZMK_DEBOUNCE_GROUP_SIZE)
+
+struct kscan_165_data {
+    const struct device *dev;
+    kscan_callback_t callback;
+    zmk_kscan_batch_callback_t batch_callback;
+    struct k_work_delayable work;
+    struct gpio_callback irq_callback;
+    /** Timestamp of the current or scheduled scan. */
+    int64_t scan_time;
+    /**
+     * Receive buffer for the SPI transfer. Register 0 (the one wired to MISO) is read first, so
+     * byte i holds inputs 8*i to 8*i+7 and each word holds one debounce group in little endian.
+     */
+    uint32_t *scan_state;
+    /** Current state of the inputs as an array of debounce groups of length config->groups_len */
+    struct zmk_debounce_group *pin_state;
+};
+
+struct kscan_165_config {
+    struct spi_dt_spec bus;
+    struct gpio_dt_spec load;
+    /** Optional line which is active while any input is active. */
+    struct gpio_dt_spec sense;
+    struct zmk_debounce_config debounce_config;
+    size_t inputs_len;
+    size_t groups_len;
+    int32_t debounce_scan_period_ms;
+    int32_t poll_period_ms;
+    bool active_low;
+};
+
+static bool kscan_165_use_interrupt(const struct kscan_165_config *config) {
+    return config->sense.port != NULL;
+}
+
+static int kscan_165_interrupt_configure(const struct device *dev, const gpio_flags_t flags) {
+    const struct kscan_165_config *config = dev->config;
+    const struct gpio_dt_spec *gpio = &config->sense;
+
+    int err = gpio_pin_interrupt_configure_dt(gpio, flags);
+    if (err) {
+        LOG_ERR("Unable to configure interrupt for pin %u on %s", gpio->pin, gpio->port->name);
+        return err;
+    }
+
+    return 0;
+}
+
+static void kscan_165_irq_callback(const struct device *port, struct gpio_callback *cb,
+                                   const gpio_port_pins_t pin) {
+    struct kscan_165_data *data = CONTAINER_OF(cb, struct kscan_165_data, irq_callback);
+
+    // Disable our interrupt to avoid re-entry while we scan.
+    kscan_165_interrupt_configure(data->dev, GPIO_INT_DISABLE);
+    data->scan_time = k_uptime_get();
+    k_work_reschedule_for_queue(kscan_gpio_work_q(), &data->work, K_NO_WAIT);
+}
+
+static void kscan_165_read_continue(const struct device *dev) {
+    const struct kscan_165_config *config = dev->config;
+    struct kscan_165_data *data = dev->data;
+
+    data->scan_time += config->debounce_scan_period_ms;
+
+    k_work_reschedule_for_queue(kscan_gpio_work_q(), &data->work,
+                                K_TIMEOUT_ABS_MS(data->scan_time));
+}
+
+static void kscan_165_read_end(const struct device *dev) {
+    struct kscan_165_data *data = dev->data;
+    const struct kscan_165_config *config = dev->config;
+
+    if (kscan_165_use_interrupt(config)) {
+        // Return to waiting for an interrupt.
+        kscan_165_interrupt_configure(dev, GPIO_INT_LEVEL_ACTIVE);
+    } else {
+        data->scan_time += config->poll_period_ms;
+
+        // Return to polling slowly.
+        k_work_reschedule_for_queue(kscan_gpio_work_q(), &data->work,
+                                    K_TIMEOUT_ABS_MS(data->scan_time));
+    }
+}
+
+/**
+ * Latches the inputs of every register in the chain and shifts them all out in a single SPI
+ * transfer.
+ */
+static int kscan_165_read_registers(const struct device *dev) {
+    const struct kscan_165_config *config = dev->config;
+    struct kscan_165_data *data = dev->data;
+
+    // The registers copy their inputs while the load line is active, and shift while it is not.
+    int err = gpio_pin_set_dt(&config->load, 1);
+    if (err) {
+        LOG_ERR("Failed to latch inputs: %i", err);
+        return err;
+    }
+
+    err = gpio_pin_set_dt(&config->load, 0);
+    if (err) {
+        LOG_ERR("Failed to latch inputs: %i", err);
+        return err;
+    }
+
+    const struct spi_buf rx_buf[1] = {{
+        .buf = data->scan_state,
+        .len = config->inputs_len / 8,
+    }};
+
+    const struct spi_buf_set rx = {
+        .buffers = rx_buf,
+        .count = ARRAY_SIZE(rx_buf),
+    };
+
+    err = spi_read_dt(&config->bus, &rx);
+    if (err) {
+        LOG_ERR("Failed to read shift registers: %i", err);
+        return err;
+    }
+
+    return 0;
+}
+
+static uint32_t kscan_165_group_state(const struct kscan_165_config *config,
+                                      const uint32_t *scan_state, size_t g) {
+    uint32_t state = sys_le32_to_cpu(scan_state[g]);
+
+    if (config->active_low) {
+        state = ~state;
+    }
+
+    // Ignore the unused bits of a partial last group.
+    const size_t remaining = config->inputs_len - (g * ZMK_DEBOUNCE_GROUP_SIZE);
+    if (remaining < ZMK_DEBOUNCE_GROUP_SIZE) {
+        state &= BIT_MASK(remaining);
+    }
+
+    return state;
+}
+
+static int kscan_165_read(const struct device *dev) {
+    struct kscan_165_data *data = dev->data;
+    const struct kscan_165_config *config = dev->config;
+    const int64_t timestamp_ticks = k_uptime_ticks();
+
+    int err = kscan_165_read_registers(dev);
+    if (err) {
+        // Keep scanning so a transient bus error does not stop the keyboard.
+        kscan_165_read_end(dev);
+        return err;
+    }
+
+    // Process the new state.
+    bool continue_scan = false;
+    struct zmk_kscan_batch_writer batch;
+
+    zmk_kscan_batch_writer_init(&batch, dev, data->callback, data->batch_callback,
+                                timestamp_ticks);
+
+    for (int g = 0; g < config->groups_len; g++) {
+        struct zmk_debounce_group *group = &data->pin_state[g];
+
+        uint32_t changed = zmk_debounce_group_update(
+            group, kscan_165_group_state(config, data->scan_state, g),
+            config->debounce_scan_period_ms, &config->debounce_config);
+        const uint32_t pressed = zmk_debounce_group_get_pressed(group);
+
+        // Only visit the switches that changed, lowest input first.
+        for (; changed != 0; changed &= changed - 1) {
+            const int bit = find_lsb_set(changed) - 1;
+            const int index = (g * ZMK_DEBOUNCE_GROUP_SIZE) + bit;
+            const bool is_pressed = (pressed & BIT(bit)) != 0;
+
+            LOG_DBG("Sending event at 0,%i state %s", index, is_pressed ? "on" : "off");
+            zmk_kscan_batch_writer_add(&batch, 0, index, is_pressed);
+        }
+
+        continue_scan = continue_scan || zmk_debounce_group_get_active(group) != 0;
+    }
+
+    zmk_kscan_batch_writer_flush(&batch);
+
+    if (continue_scan) {
+        // At least one key is pressed or the debouncer has not yet decided if
+        // it is pressed. Poll quickly until everything is released.
+        kscan_165_read_continue(dev);
+    } else {
+        // All keys are released. Return to normal.
+        kscan_165_read_end(dev);
+    }
+
+    return 0;
+}
+
+static void kscan_165_work_handler(struct k_work *work) {
+    struct k_work_delayable *dwork = CONTAINER_OF(work, struct k_work_delayable, work);
+    struct kscan_165_data *data = CONTAINER_OF(dwork, struct kscan_165_data, work);
+    kscan_165_read(data->dev);
+}
+
+static int kscan_165_configure(const struct device *dev, kscan_callback_t callback) {
+    struct kscan_165_data *data = dev->data;
+
+    if (!callback) {
+        return -EINVAL;
+    }
+
+    data->callback = callback;
+    data->batch_callback = NULL;
+    return 0;
+}
+
+static int kscan_165_configure_batch(const struct device *dev,
+                                     zmk_kscan_batch_callback_t callback) {
+    struct kscan_165_data *data = dev->data;
+
+    if (!callback) {
+        return -EINVAL;
+    }
+
+    data->batch_callback = callback;
+    data->callback = NULL;
+    return 0;
+}
+
+static int kscan_165_enable(const struct device *dev) {
+    struct kscan_165_data *data = dev->data;
+
+    data->scan_time = k_uptime_get();
+
+    // Read will automatically start interrupts/polling once done.
+    return kscan_165_read(dev);
+}
+
+static int kscan_165_disable(const struct device *dev) {
+    const struct kscan_165_config *config = dev->config;
+    struct kscan_165_data *data = dev->data;
+
+    k_work_cancel_delayable(&data->work);
+
+    if (kscan_165_use_interrupt(config)) {
+        return kscan_165_interrupt_configure(dev, GPIO_INT_DISABLE);
+    }
+
+    return 0;
+}
+
+static int kscan_165_init_interrupt(const struct device *dev) {
+    struct kscan_165_data *data = dev->data;
+    const struct kscan_165_config *config = dev->config;
+    const struct gpio_dt_spec *gpio = &config->sense;
+
+    if (!device_is_ready(gpio->port)) {
+        LOG_ERR("GPIO is not ready: %s", gpio->port->name);
+        return -ENODEV;
+    }
+
+    int err = gpio_pin_configure_dt(gpio, GPIO_INPUT);
+    if (err) {
+        LOG_ERR("Unable to configure pin %u on %s for input", gpio->pin, gpio->port->name);
+        return err;
+    }
+
+    gpio_init_callback(&data->irq_callback, kscan_165_irq_callback, BIT(gpio->pin));
+    err = gpio_add_callback(gpio->port, &data->irq_callback);
+    if (err) {
+        LOG_ERR("Error adding the callback to the input device: %i", err);
+    }
+    return err;
+}
+
+static int kscan_165_init(const struct device *dev) {
+    struct kscan_165_data *data = dev->data;
+    const struct kscan_165_config *config = dev->config;
+
+    data->dev = dev;
+
+    if (!spi_is_ready_dt(&config->bus)) {
+        LOG_ERR("SPI bus is not ready: %s", config->bus.bus->name);
+        return -ENODEV;
+    }
+
+    if (!device_is_ready(config->load.port)) {
+        LOG_ERR("GPIO is not ready: %s", config->load.port->name);
+        return -ENODEV;
+    }
+
+    int err = gpio_pin_configure_dt(&config->load, GPIO_OUTPUT_INACTIVE);
+    if (err) {
+        LOG_ERR("Unable to configure pin %u on %s for output", config->load.pin,
+                config->load.port->name);
+        return err;
+    }
+
+    if (kscan_165_use_interrupt(config)) {
+        err = kscan_165_init_interrupt(dev);
+        if (err) {
+            return err;
+        }
+    }
+
+    k_work_init_delayable(&data->work, kscan_165_work_handler);
+
+    return 0;
+}
+
+#if IS_ENABLED(CONFIG_PM_DEVICE)
+
+static int kscan_165_pm_action(const struct device *dev, enum pm_device_action action) {
+    switch (action) {
+    case PM_DEVICE_ACTION_SUSPEND:
+        return kscan_165_disable(dev);
+    case PM_DEVICE_ACTION_RESUME:
+        return kscan_165_enable(dev);
+    default:
+        return -ENOTSUP;
+    }
+}
+
+#endif // IS_ENABLED(CONFIG_PM_DEVICE)
+
+static const struct zmk_kscan_batch_driver_api kscan_165_api = {
+    .kscan =
+        {
+            .config = kscan_165_configure,
+            .enable_callback = kscan_165_enable,
+            .disable_callback = kscan_165_disable,
+        },
+    .config_batch = kscan_165_configure_batch,
+};
+
+#define KSCAN_165_INIT(n)                                                                          \
+    BUILD_ASSERT(INST_DEBOUNCE_PRESS_MS(n) <= DEBOUNCE_COUNTER_MAX,                                \
+                 "ZMK_KSCAN_DEBOUNCE_PRESS_MS or debounce-press-ms is too large");                 \
+    BUILD_ASSERT(INST_DEBOUNCE_RELEASE_MS(n) <= DEBOUNCE_COUNTER_MAX,                              \
+                 "ZMK_KSCAN_DEBOUNCE_RELEASE_MS or debounce-release-ms is too large");             \
+    BUILD_ASSERT(INST_INPUTS_LEN(n) > 0 && INST_INPUTS_LEN(n) % 8 == 0,                            \
+                 "ngpios must be a multiple of 8");                                                \
+                                                                                                   \
+    static uint32_t kscan_165_scan_state_##n[INST_GROUPS_LEN(n)];                                  \
+    static struct zmk_debounce_group kscan_165_state_##n[INST_GROUPS_LEN(n)];                      \
+                                                                                                   \
+    static struct kscan_165_data kscan_165_data_##n = {                                            \
+        .scan_state = kscan_165_scan_state_##n,                                                    \
+        .pin_state = kscan_165_state_##n,                                                          \
+    };                                                                                             \
+                                                                                                   \
+    static const struct kscan_165_config kscan_165_config_##n = {                                  \
+        .bus = SPI_DT_SPEC_INST_GET(n, SPI_OP_MODE_MASTER | SPI_TRANSFER_MSB | SPI_WORD_SET(8),    \
+                                    0),                                                            \
+        .load = GPIO_DT_SPEC_INST_GET(n, load_gpios),                                              \
+        .sense = GPIO_DT_SPEC_INST_GET_OR(n, sense_gpios, {0}),                                    \
+        .debounce_config =                                                                         \
+            {                                                                                      \
+                .debounce_press_ms = INST_DEBOUNCE_PRESS_MS(n),                                    \
+                .debounce_release_ms = INST_DEBOUNCE_RELEASE_MS(n),                                \
+                .algorithm = INST_DEBOUNCE_ALGORITHM(n),                                           \
+            },                                                                                     \
+        .inputs_len = INST_INPUTS_LEN(n),                                                          \
+        .groups_len = INST_GROUPS_LEN(n),                                                          \
+        .debounce_scan_period_ms = DT_INST_PROP(n, debounce_scan_period_ms),                       \
+        .poll_period_ms = DT_INST_PROP(n, poll_period_ms),                                         \
+        .active_low = DT_INST_PROP(n, active_low),                                                 \
+    };                                                                                             \
+                                                                                                   \
+    ZMK_KSCAN_BATCH_DEVICE_DEFINE(DT_DRV_INST(n));                                                 \
+                                                                                                   \
+    PM_DEVICE_DT_INST_DEFINE(n, kscan_165_pm_action);                                              \
+                                                                                                   \
+    DEVICE_DT_INST_DEFINE(n, &kscan_165_init, PM_DEVICE_DT_INST_GET(n), &kscan_165_data_##n,       \
+                          &kscan_165_config_##n, POST_KERNEL, CONFIG_ZMK_KSCAN_165_INIT_PRIORITY,  \
+                          &kscan_165_api);
+
+DT_INST_FOREACH_STATUS_OKAY(KSCAN_165_INIT);
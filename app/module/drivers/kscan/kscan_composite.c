@@ -8,9 +8,12 @@
 
 #include <zephyr/device.h>
 #include <zephyr/drivers/kscan.h>
+#include <zephyr/kernel.h>
 #include <zephyr/logging/log.h>
 LOG_MODULE_DECLARE(zmk, CONFIG_ZMK_LOG_LEVEL);
 
+#include <drivers/kscan_batch.h>
+
 #define MATRIX_NODE_ID DT_DRV_INST(0)
 #define MATRIX_ROWS DT_PROP(MATRIX_NODE_ID, rows)
 #define MATRIX_COLS DT_PROP(MATRIX_NODE_ID, columns)
@@ -33,6 +36,7 @@ struct kscan_composite_config {};
 
 struct kscan_composite_data {
     kscan_callback_t callback;
+    zmk_kscan_batch_callback_t batch_callback;
 
     const struct device *dev;
 };
@@ -68,7 +72,50 @@ static void kscan_composite_child_callback(const struct device *child_dev, uint3
             continue;
         }
 
-        data->callback(dev, row + cfg->row_offset, column + cfg->column_offset, pressed);
+        if (data->batch_callback) {
+            const struct zmk_kscan_change change = {.row = row + cfg->row_offset,
+                                                    .column = column + cfg->column_offset,
+                                                    .pressed = pressed};
+            const struct zmk_kscan_batch batch = {
+                .timestamp_ticks = k_uptime_ticks(), .len = 1, .changes = &change};
+
+            data->batch_callback(dev, &batch);
+        } else {
+            data->callback(dev, row + cfg->row_offset, column + cfg->column_offset, pressed);
+        }
+    }
+}
+
+static void kscan_composite_child_batch_callback(const struct device *child_dev,
+                                                 const struct zmk_kscan_batch *child_batch) {
+    const struct device *dev = DEVICE_DT_GET(DT_DRV_INST(0));
+    struct kscan_composite_data *data = dev->data;
+
+    for (int i = 0; i < ARRAY_SIZE(kscan_composite_children); i++) {
+        const struct kscan_composite_child_config *cfg = &kscan_composite_children[i];
+
+        if (cfg->child != child_dev) {
+            continue;
+        }
+
+        // Children without offsets share our coordinates, so their batches can be passed on as is.
+        if (data->batch_callback && cfg->row_offset == 0 && cfg->column_offset == 0) {
+            data->batch_callback(dev, child_batch);
+            continue;
+        }
+
+        struct zmk_kscan_batch_writer batch;
+        zmk_kscan_batch_writer_init(&batch, dev, data->callback, data->batch_callback,
+                                    child_batch->timestamp_ticks);
+
+        for (int c = 0; c < child_batch->len; c++) {
+            const struct zmk_kscan_change *change = &child_batch->changes[c];
+
+            zmk_kscan_batch_writer_add(&batch, change->row + cfg->row_offset,
+                                       change->column + cfg->column_offset, change->pressed);
+        }
+
+        zmk_kscan_batch_writer_flush(&batch);
     }
 }
 
@@ -86,6 +133,31 @@ static int kscan_composite_configure(const struct device *dev, kscan_callback_t
     }
 
     data->callback = callback;
+    data->batch_callback = NULL;
+
+    return 0;
+}
+
+static int kscan_composite_configure_batch(const struct device *dev,
+                                           zmk_kscan_batch_callback_t callback) {
+    struct kscan_composite_data *data = dev->data;
+
+    if (!callback) {
+        return -EINVAL;
+    }
+
+    for (int i = 0; i < ARRAY_SIZE(kscan_composite_children); i++) {
+        const struct kscan_composite_child_config *cfg = &kscan_composite_children[i];
+
+        if (zmk_kscan_batch_is_supported(cfg->child)) {
+            zmk_kscan_batch_config(cfg->child, &kscan_composite_child_batch_callback);
+        } else {
+            kscan_config(cfg->child, &kscan_composite_child_callback);
+        }
+    }
+
+    data->batch_callback = callback;
+    data->callback = NULL;
 
     return 0;
 }
@@ -98,12 +170,18 @@ static int kscan_composite_init(const struct device *dev) {
     return 0;
 }
 
-static const struct kscan_driver_api mock_driver_api = {
-    .config = kscan_composite_configure,
-    .enable_callback = kscan_composite_enable_callback,
-    .disable_callback = kscan_composite_disable_callback,
+static const struct zmk_kscan_batch_driver_api mock_driver_api = {
+    .kscan =
+        {
+            .config = kscan_composite_configure,
+            .enable_callback = kscan_composite_enable_callback,
+            .disable_callback = kscan_composite_disable_callback,
+        },
+    .config_batch = kscan_composite_configure_batch,
 };
 
+ZMK_KSCAN_BATCH_DEVICE_DEFINE(DT_DRV_INST(0));
+
 static const struct kscan_composite_config kscan_composite_config = {};
 
 static struct kscan_composite_data kscan_composite_data;
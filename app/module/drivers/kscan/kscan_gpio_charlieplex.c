@@ -4,8 +4,12 @@
  * SPDX-License-Identifier: MIT
  */
 
+#include "kscan_gpio_work_q.h"
+
+#include <drivers/kscan_batch.h>
 #include <zmk/debounce.h>
 
+#include <string.h>
 #include <zephyr/device.h>
 #include <zephyr/devicetree.h>
 #include <zephyr/drivers/gpio.h>
@@ -20,7 +24,11 @@ LOG_MODULE_DECLARE(zmk, CONFIG_ZMK_LOG_LEVEL);
 #define DT_DRV_COMPAT zmk_kscan_gpio_charlieplex
 
 #define INST_LEN(n) DT_INST_PROP_LEN(n, gpios)
-#define INST_CHARLIEPLEX_LEN(n) (INST_LEN(n) * INST_LEN(n))
+#define INST_ROW_GROUPS(n) DIV_ROUND_UP(INST_LEN(n), ZMK_DEBOUNCE_GROUP_SIZE)
+#define INST_CHARLIEPLEX_LEN(n) (INST_LEN(n) * INST_ROW_GROUPS(n))
+#define INST_GROUP_WORDS(n) DIV_ROUND_UP(INST_CHARLIEPLEX_LEN(n), 32)
+
+#define INST_DEBOUNCE_ALGORITHM(n) DT_INST_ENUM_IDX(n, debounce_algorithm)
 
 #if CONFIG_ZMK_KSCAN_DEBOUNCE_PRESS_MS >= 0
 #define INST_DEBOUNCE_PRESS_MS(n) CONFIG_ZMK_KSCAN_DEBOUNCE_PRESS_MS
@@ -55,14 +63,23 @@ LOG_MODULE_DECLARE(zmk, CONFIG_ZMK_LOG_LEVEL);
 struct kscan_charlieplex_data {
     const struct device *dev;
     kscan_callback_t callback;
+    zmk_kscan_batch_callback_t batch_callback;
     struct k_work_delayable work;
     int64_t scan_time; /* Timestamp of the current or scheduled scan. */
     struct gpio_callback irq_callback;
+    /** Raw state of the row read by the current scan, of length config->row_groups */
+    uint32_t *row_state;
+    /**
+     * Current state of the matrix as a flattened 2D array of debounce groups of length
+     * (config->cells.len * config->row_groups). Each row has one group for every
+     * ZMK_DEBOUNCE_GROUP_SIZE columns.
+     */
+    struct zmk_debounce_group *charlieplex_state;
     /**
-     * Current state of the matrix as a flattened 2D array of length
-     * (config->cells.length ^2)
+     * Bitmap with one bit per group in charlieplex_state, set if any of its switches are pressed
+     * or still being debounced.
      */
-    struct zmk_debounce_state *charlieplex_state;
+    uint32_t *active_groups;
 };
 
 struct kscan_gpio_list {
@@ -77,6 +94,9 @@ struct kscan_gpio_list {
 struct kscan_charlieplex_config {
     struct kscan_gpio_list cells;
     struct zmk_debounce_config debounce_config;
+    size_t row_groups;
+    /** Length of the active_groups bitmap. */
+    size_t group_words;
     int32_t debounce_scan_period_ms;
     int32_t poll_period_ms;
     bool use_interrupt;
@@ -84,7 +104,7 @@ struct kscan_charlieplex_config {
 };
 
 /**
- * Get the index into a matrix state array from a row and column.
+ * Get the index into a matrix state array of the group containing a row and column.
  * There are effectively (n) cols and (n-1) rows, but we use the full col x row space
  * as a safety measure against someone accidentally defining a transform RC at (p,p)
  */
@@ -92,9 +112,8 @@ static int state_index(const struct kscan_charlieplex_config *config, const int
                        const int col) {
     __ASSERT(row < config->cells.len, "Invalid row %i", row);
     __ASSERT(col < config->cells.len, "Invalid column %i", col);
-    __ASSERT(col != row, "Invalid column row pair %i, %i", col, row);
 
-    return (col * config->cells.len) + row;
+    return (row * config->row_groups) + (col / ZMK_DEBOUNCE_GROUP_SIZE);
 }
 
 static int kscan_charlieplex_set_as_input(const struct gpio_dt_spec *gpio) {
@@ -199,7 +218,7 @@ static void kscan_charlieplex_irq_callback(const struct device *port, struct gpi
     // Disable our interrupt to avoid re-entry while we scan.
     kscan_charlieplex_interrupt_configure(data->dev, GPIO_INT_DISABLE);
     data->scan_time = k_uptime_get();
-    k_work_reschedule(&data->work, K_NO_WAIT);
+    k_work_reschedule_for_queue(kscan_gpio_work_q(), &data->work, K_NO_WAIT);
 }
 
 static void kscan_charlieplex_read_continue(const struct device *dev) {
@@ -208,7 +227,8 @@ static void kscan_charlieplex_read_continue(const struct device *dev) {
 
     data->scan_time += config->debounce_scan_period_ms;
 
-    k_work_reschedule(&data->work, K_TIMEOUT_ABS_MS(data->scan_time));
+    k_work_reschedule_for_queue(kscan_gpio_work_q(), &data->work,
+                                K_TIMEOUT_ABS_MS(data->scan_time));
 }
 
 static void kscan_charlieplex_read_end(const struct device *dev) {
@@ -222,14 +242,18 @@ static void kscan_charlieplex_read_end(const struct device *dev) {
         data->scan_time += config->poll_period_ms;
 
         // Return to polling slowly.
-        k_work_reschedule(&data->work, K_TIMEOUT_ABS_MS(data->scan_time));
+        k_work_reschedule_for_queue(kscan_gpio_work_q(), &data->work,
+                                    K_TIMEOUT_ABS_MS(data->scan_time));
     }
 }
 
 static int kscan_charlieplex_read(const struct device *dev) {
     struct kscan_charlieplex_data *data = dev->data;
     const struct kscan_charlieplex_config *config = dev->config;
-    bool continue_scan = false;
+    struct zmk_kscan_batch_writer batch;
+
+    zmk_kscan_batch_writer_init(&batch, dev, data->callback, data->batch_callback,
+                                k_uptime_ticks());
 
     // NOTE: RR vs MATRIX: set all pins as input, in case there was a failure on a
     // previous scan, and one of the pins is still set as output
@@ -243,6 +267,7 @@ static int kscan_charlieplex_read(const struct device *dev) {
         const struct gpio_dt_spec *out_gpio = &config->cells.gpios[row];
         err = kscan_charlieplex_set_as_output(out_gpio);
         if (err) {
+            zmk_kscan_batch_writer_flush(&batch);
             return err;
         }
 
@@ -250,30 +275,55 @@ static int kscan_charlieplex_read(const struct device *dev) {
         k_busy_wait(CONFIG_ZMK_KSCAN_CHARLIEPLEX_WAIT_BEFORE_INPUTS);
 #endif
 
+        memset(data->row_state, 0, config->row_groups * sizeof(uint32_t));
+
         for (int col = 0; col < config->cells.len; col++) {
             if (col == row) {
                 continue; // pin can't drive itself
             }
             const struct gpio_dt_spec *in_gpio = &config->cells.gpios[col];
-            const int index = state_index(config, row, col);
 
-            struct zmk_debounce_state *state = &data->charlieplex_state[index];
-            zmk_debounce_update(state, gpio_pin_get_dt(in_gpio), config->debounce_scan_period_ms,
-                                &config->debounce_config);
+            if (gpio_pin_get_dt(in_gpio) > 0) {
+                data->row_state[col / ZMK_DEBOUNCE_GROUP_SIZE] |=
+                    BIT(col % ZMK_DEBOUNCE_GROUP_SIZE);
+            }
+        }
+
+        // NOTE: RR vs MATRIX: because we don't need an input/output => row/column
+        // setup, we can update each row as soon as it is read.
+        for (int g = 0; g < config->row_groups; g++) {
+            const int index = state_index(config, row, g * ZMK_DEBOUNCE_GROUP_SIZE);
+            struct zmk_debounce_group *group = &data->charlieplex_state[index];
+
+            // A group with nothing read active and nothing pressed or being debounced is idle,
+            // and debouncing it would change nothing.
+            const bool was_active = (data->active_groups[index / 32] & BIT(index % 32)) != 0;
+            if (data->row_state[g] == 0 && !was_active) {
+                continue;
+            }
+
+            uint32_t changed = zmk_debounce_group_update(group, data->row_state[g],
+                                                         config->debounce_scan_period_ms,
+                                                         &config->debounce_config);
+            const uint32_t pressed = zmk_debounce_group_get_pressed(group);
 
-            // NOTE: RR vs MATRIX: because we don't need an input/output => row/column
-            // setup, we can update in the same loop.
-            if (zmk_debounce_get_changed(state)) {
-                const bool pressed = zmk_debounce_is_pressed(state);
+            // Only visit the switches that changed, lowest column first.
+            for (; changed != 0; changed &= changed - 1) {
+                const int bit = find_lsb_set(changed) - 1;
+                const int col = (g * ZMK_DEBOUNCE_GROUP_SIZE) + bit;
+                const bool is_pressed = (pressed & BIT(bit)) != 0;
 
-                LOG_DBG("Sending event at %i,%i state %s", row, col, pressed ? "on" : "off");
-                data->callback(dev, row, col, pressed);
+                LOG_DBG("Sending event at %i,%i state %s", row, col, is_pressed ? "on" : "off");
+                zmk_kscan_batch_writer_add(&batch, row, col, is_pressed);
             }
-            continue_scan = continue_scan || zmk_debounce_is_active(state);
+
+            WRITE_BIT(data->active_groups[index / 32], index % 32,
+                      zmk_debounce_group_get_active(group) != 0);
         }
 
         err = kscan_charlieplex_set_as_input(out_gpio);
         if (err) {
+            zmk_kscan_batch_writer_flush(&batch);
             return err;
         }
 #if CONFIG_ZMK_KSCAN_CHARLIEPLEX_WAIT_BETWEEN_OUTPUTS > 0
@@ -281,6 +331,13 @@ static int kscan_charlieplex_read(const struct device *dev) {
 #endif
     }
 
+    zmk_kscan_batch_writer_flush(&batch);
+
+    bool continue_scan = false;
+    for (int w = 0; w < config->group_words; w++) {
+        continue_scan = continue_scan || data->active_groups[w] != 0;
+    }
+
     if (continue_scan) {
         // At least one key is pressed or the debouncer has not yet decided if
         // it is pressed. Poll quickly until everything is released.
@@ -306,6 +363,19 @@ static int kscan_charlieplex_configure(const struct device *dev, const kscan_cal
 
     struct kscan_charlieplex_data *data = dev->data;
     data->callback = callback;
+    data->batch_callback = NULL;
+    return 0;
+}
+
+static int kscan_charlieplex_configure_batch(const struct device *dev,
+                                             const zmk_kscan_batch_callback_t callback) {
+    if (!callback) {
+        return -EINVAL;
+    }
+
+    struct kscan_charlieplex_data *data = dev->data;
+    data->batch_callback = callback;
+    data->callback = NULL;
     return 0;
 }
 
@@ -375,10 +445,14 @@ static int kscan_charlieplex_init(const struct device *dev) {
     return 0;
 }
 
-static const struct kscan_driver_api kscan_charlieplex_api = {
-    .config = kscan_charlieplex_configure,
-    .enable_callback = kscan_charlieplex_enable,
-    .disable_callback = kscan_charlieplex_disable,
+static const struct zmk_kscan_batch_driver_api kscan_charlieplex_api = {
+    .kscan =
+        {
+            .config = kscan_charlieplex_configure,
+            .enable_callback = kscan_charlieplex_enable,
+            .disable_callback = kscan_charlieplex_disable,
+        },
+    .config_batch = kscan_charlieplex_configure_batch,
 };
 
 #define KSCAN_CHARLIEPLEX_INIT(n)                                                                  \
@@ -387,25 +461,34 @@ static const struct kscan_driver_api kscan_charlieplex_api = {
     BUILD_ASSERT(INST_DEBOUNCE_RELEASE_MS(n) <= DEBOUNCE_COUNTER_MAX,                              \
                  "ZMK_KSCAN_DEBOUNCE_RELEASE_MS or debounce-release-ms is too large");             \
                                                                                                    \
-    static struct zmk_debounce_state kscan_charlieplex_state_##n[INST_CHARLIEPLEX_LEN(n)];         \
+    static uint32_t kscan_charlieplex_row_state_##n[INST_ROW_GROUPS(n)];                           \
+    static struct zmk_debounce_group kscan_charlieplex_state_##n[INST_CHARLIEPLEX_LEN(n)];         \
+    static uint32_t kscan_charlieplex_active_groups_##n[INST_GROUP_WORDS(n)];                      \
     static const struct gpio_dt_spec kscan_charlieplex_cells_##n[] = {                             \
         LISTIFY(INST_LEN(n), KSCAN_GPIO_CFG_INIT, (, ), n)};                                       \
     static struct kscan_charlieplex_data kscan_charlieplex_data_##n = {                            \
+        .row_state = kscan_charlieplex_row_state_##n,                                              \
         .charlieplex_state = kscan_charlieplex_state_##n,                                          \
+        .active_groups = kscan_charlieplex_active_groups_##n,                                      \
     };                                                                                             \
                                                                                                    \
     static struct kscan_charlieplex_config kscan_charlieplex_config_##n = {                        \
         .cells = KSCAN_GPIO_LIST(kscan_charlieplex_cells_##n),                                     \
+        .row_groups = INST_ROW_GROUPS(n),                                                          \
+        .group_words = INST_GROUP_WORDS(n),                                                        \
         .debounce_config =                                                                         \
             {                                                                                      \
                 .debounce_press_ms = INST_DEBOUNCE_PRESS_MS(n),                                    \
                 .debounce_release_ms = INST_DEBOUNCE_RELEASE_MS(n),                                \
+                .algorithm = INST_DEBOUNCE_ALGORITHM(n),                                           \
             },                                                                                     \
         .debounce_scan_period_ms = DT_INST_PROP(n, debounce_scan_period_ms),                       \
         COND_ANY_POLLING((.poll_period_ms = DT_INST_PROP(n, poll_period_ms), ))                    \
             COND_THIS_INTERRUPT(n, (.use_interrupt = INST_INTR_DEFINED(n), ))                      \
                 COND_THIS_INTERRUPT(n, (.interrupt = KSCAN_INTR_CFG_INIT(n), ))};                  \
                                                                                                    \
+    ZMK_KSCAN_BATCH_DEVICE_DEFINE(DT_DRV_INST(n));                                                 \
+                                                                                                   \
     DEVICE_DT_INST_DEFINE(n, &kscan_charlieplex_init, NULL, &kscan_charlieplex_data_##n,           \
                           &kscan_charlieplex_config_##n, POST_KERNEL, CONFIG_KSCAN_INIT_PRIORITY,  \
                           &kscan_charlieplex_api);
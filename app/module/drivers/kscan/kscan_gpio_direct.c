@@ -5,7 +5,9 @@
  */
 
 #include "kscan_gpio.h"
+#include "kscan_gpio_work_q.h"
 
+#include <string.h>
 #include <zephyr/device.h>
 #include <zephyr/devicetree.h>
 #include <zephyr/drivers/gpio.h>
@@ -15,12 +17,15 @@
 #include <zephyr/pm/device.h>
 #include <zephyr/sys/util.h>
 
+#include <drivers/kscan_batch.h>
 #include <zmk/debounce.h>
 
 LOG_MODULE_DECLARE(zmk, CONFIG_ZMK_LOG_LEVEL);
 
 #define DT_DRV_COMPAT zmk_kscan_gpio_direct
 
+#define INST_DEBOUNCE_ALGORITHM(n) DT_INST_ENUM_IDX(n, debounce_algorithm)
+
 #if CONFIG_ZMK_KSCAN_DEBOUNCE_PRESS_MS >= 0
 #define INST_DEBOUNCE_PRESS_MS(n) CONFIG_ZMK_KSCAN_DEBOUNCE_PRESS_MS
 #else
@@ -45,6 +50,7 @@ LOG_MODULE_DECLARE(zmk, CONFIG_ZMK_LOG_LEVEL);
 #define INST_INPUTS_LEN(n)                                                                         \
     COND_CODE_1(DT_INST_NODE_HAS_PROP(n, input_gpios), (DT_INST_PROP_LEN(n, input_gpios)),         \
                 (DT_INST_PROP_LEN(n, input_keys)))
+#define INST_GROUPS_LEN(n) DIV_ROUND_UP(INST_INPUTS_LEN(n), ZMK_DEBOUNCE_GROUP_SIZE)
 
 #define KSCAN_GPIO_DIRECT_INPUT_CFG_INIT(idx, inst_idx)                                            \
     KSCAN_GPIO_GET_BY_IDX(DT_DRV_INST(inst_idx), input_gpios, idx)
@@ -60,6 +66,7 @@ struct kscan_direct_data {
     const struct device *dev;
     struct kscan_gpio_list inputs;
     kscan_callback_t callback;
+    zmk_kscan_batch_callback_t batch_callback;
     struct k_work_delayable work;
 #if USE_INTERRUPTS
     /** Array of length config->inputs.len */
@@ -67,8 +74,13 @@ struct kscan_direct_data {
 #endif
     /** Timestamp of the current or scheduled scan. */
     int64_t scan_time;
-    /** Current state of the inputs as an array of length config->inputs.len */
-    struct zmk_debounce_state *pin_state;
+    /** Raw state of the inputs read by the current scan, laid out like pin_state. */
+    uint32_t *scan_state;
+    /**
+     * Current state of the inputs as an array of debounce groups of length
+     * DIV_ROUND_UP(config->inputs.len, ZMK_DEBOUNCE_GROUP_SIZE)
+     */
+    struct zmk_debounce_group *pin_state;
 };
 
 struct kscan_direct_config {
@@ -120,7 +132,7 @@ static void kscan_direct_irq_callback_handler(const struct device *port, struct
 
     data->scan_time = k_uptime_get();
 
-    k_work_reschedule(&data->work, K_NO_WAIT);
+    k_work_reschedule_for_queue(kscan_gpio_work_q(), &data->work, K_NO_WAIT);
 }
 #endif
 
@@ -149,13 +161,25 @@ static int kscan_inputs_set_flags(const struct kscan_gpio_list *inputs,
     return 0;
 }
 
+static const struct kscan_gpio *kscan_inputs_get_by_index(const struct kscan_gpio_list *inputs,
+                                                           const size_t index) {
+    // Inputs are sorted by port, so this can't index the list directly.
+    for (int i = 0; i < inputs->len; i++) {
+        if (inputs->gpios[i].index == index) {
+            return &inputs->gpios[i];
+        }
+    }
+    return NULL;
+}
+
 static void kscan_direct_read_continue(const struct device *dev) {
     const struct kscan_direct_config *config = dev->config;
     struct kscan_direct_data *data = dev->data;
 
     data->scan_time += config->debounce_scan_period_ms;
 
-    k_work_reschedule(&data->work, K_TIMEOUT_ABS_MS(data->scan_time));
+    k_work_reschedule_for_queue(kscan_gpio_work_q(), &data->work,
+                                K_TIMEOUT_ABS_MS(data->scan_time));
 }
 
 static void kscan_direct_read_end(const struct device *dev) {
@@ -169,13 +193,19 @@ static void kscan_direct_read_end(const struct device *dev) {
     data->scan_time += config->poll_period_ms;
 
     // Return to polling slowly.
-    k_work_reschedule(&data->work, K_TIMEOUT_ABS_MS(data->scan_time));
+    k_work_reschedule_for_queue(kscan_gpio_work_q(), &data->work,
+                                K_TIMEOUT_ABS_MS(data->scan_time));
 #endif
 }
 
 static int kscan_direct_read(const struct device *dev) {
     struct kscan_direct_data *data = dev->data;
     const struct kscan_direct_config *config = dev->config;
+    const int64_t timestamp_ticks = k_uptime_ticks();
+
+    const size_t groups_len = DIV_ROUND_UP(data->inputs.len, ZMK_DEBOUNCE_GROUP_SIZE);
+
+    memset(data->scan_state, 0, groups_len * sizeof(uint32_t));
 
     // Read the inputs.
     struct kscan_gpio_port_state state = {0};
@@ -189,30 +219,46 @@ static int kscan_direct_read(const struct device *dev) {
             return active;
         }
 
-        zmk_debounce_update(&data->pin_state[gpio->index], active, config->debounce_scan_period_ms,
-                            &config->debounce_config);
+        if (active) {
+            data->scan_state[gpio->index / ZMK_DEBOUNCE_GROUP_SIZE] |=
+                BIT(gpio->index % ZMK_DEBOUNCE_GROUP_SIZE);
+        }
     }
 
     // Process the new state.
     bool continue_scan = false;
+    struct zmk_kscan_batch_writer batch;
 
-    for (int i = 0; i < data->inputs.len; i++) {
-        const struct kscan_gpio *gpio = &data->inputs.gpios[i];
-        struct zmk_debounce_state *deb_state = &data->pin_state[gpio->index];
+    zmk_kscan_batch_writer_init(&batch, dev, data->callback, data->batch_callback,
+                                timestamp_ticks);
+
+    for (int g = 0; g < groups_len; g++) {
+        struct zmk_debounce_group *group = &data->pin_state[g];
 
-        if (zmk_debounce_get_changed(deb_state)) {
-            const bool pressed = zmk_debounce_is_pressed(deb_state);
+        uint32_t changed = zmk_debounce_group_update(group, data->scan_state[g],
+                                                     config->debounce_scan_period_ms,
+                                                     &config->debounce_config);
+        const uint32_t pressed = zmk_debounce_group_get_pressed(group);
 
-            LOG_DBG("Sending event at 0,%i state %s", gpio->index, pressed ? "on" : "off");
-            data->callback(dev, 0, gpio->index, pressed);
-            if (config->toggle_mode && pressed) {
+        // Only visit the switches that changed, lowest input first.
+        for (; changed != 0; changed &= changed - 1) {
+            const int bit = find_lsb_set(changed) - 1;
+            const int index = (g * ZMK_DEBOUNCE_GROUP_SIZE) + bit;
+            const bool is_pressed = (pressed & BIT(bit)) != 0;
+
+            LOG_DBG("Sending event at 0,%i state %s", index, is_pressed ? "on" : "off");
+            zmk_kscan_batch_writer_add(&batch, 0, index, is_pressed);
+            if (config->toggle_mode && is_pressed) {
+                const struct kscan_gpio *gpio = kscan_inputs_get_by_index(&data->inputs, index);
                 kscan_inputs_set_flags(&data->inputs, &gpio->spec);
             }
         }
 
-        continue_scan = continue_scan || zmk_debounce_is_active(deb_state);
+        continue_scan = continue_scan || zmk_debounce_group_get_active(group) != 0;
     }
 
+    zmk_kscan_batch_writer_flush(&batch);
+
     if (continue_scan) {
         // At least one key is pressed or the debouncer has not yet decided if
         // it is pressed. Poll quickly until everything is released.
@@ -239,6 +285,20 @@ static int kscan_direct_configure(const struct device *dev, kscan_callback_t cal
     }
 
     data->callback = callback;
+    data->batch_callback = NULL;
+    return 0;
+}
+
+static int kscan_direct_configure_batch(const struct device *dev,
+                                        zmk_kscan_batch_callback_t callback) {
+    struct kscan_direct_data *data = dev->data;
+
+    if (!callback) {
+        return -EINVAL;
+    }
+
+    data->batch_callback = callback;
+    data->callback = NULL;
     return 0;
 }
 
@@ -339,10 +399,14 @@ static int kscan_direct_pm_action(const struct device *dev, enum pm_device_actio
 
 #endif // IS_ENABLED(CONFIG_PM_DEVICE)
 
-static const struct kscan_driver_api kscan_direct_api = {
-    .config = kscan_direct_configure,
-    .enable_callback = kscan_direct_enable,
-    .disable_callback = kscan_direct_disable,
+static const struct zmk_kscan_batch_driver_api kscan_direct_api = {
+    .kscan =
+        {
+            .config = kscan_direct_configure,
+            .enable_callback = kscan_direct_enable,
+            .disable_callback = kscan_direct_disable,
+        },
+    .config_batch = kscan_direct_configure_batch,
 };
 
 #define KSCAN_DIRECT_INIT(n)                                                                       \
@@ -356,13 +420,15 @@ static const struct kscan_driver_api kscan_direct_api = {
                     (LISTIFY(INST_INPUTS_LEN(n), KSCAN_GPIO_DIRECT_INPUT_CFG_INIT, (, ), n)),      \
                     (LISTIFY(INST_INPUTS_LEN(n), KSCAN_KEY_DIRECT_INPUT_CFG_INIT, (, ), n)))};     \
                                                                                                    \
-    static struct zmk_debounce_state kscan_direct_state_##n[INST_INPUTS_LEN(n)];                   \
+    static uint32_t kscan_direct_scan_state_##n[INST_GROUPS_LEN(n)];                               \
+    static struct zmk_debounce_group kscan_direct_state_##n[INST_GROUPS_LEN(n)];                   \
                                                                                                    \
     COND_INTERRUPTS(                                                                               \
         (static struct kscan_direct_irq_callback kscan_direct_irqs_##n[INST_INPUTS_LEN(n)];))      \
                                                                                                    \
     static struct kscan_direct_data kscan_direct_data_##n = {                                      \
         .inputs = KSCAN_GPIO_LIST(kscan_direct_inputs_##n),                                        \
+        .scan_state = kscan_direct_scan_state_##n,                                                 \
         .pin_state = kscan_direct_state_##n,                                                       \
         COND_INTERRUPTS((.irqs = kscan_direct_irqs_##n, ))};                                       \
                                                                                                    \
@@ -371,12 +437,15 @@ static const struct kscan_driver_api kscan_direct_api = {
             {                                                                                      \
                 .debounce_press_ms = INST_DEBOUNCE_PRESS_MS(n),                                    \
                 .debounce_release_ms = INST_DEBOUNCE_RELEASE_MS(n),                                \
+                .algorithm = INST_DEBOUNCE_ALGORITHM(n),                                           \
             },                                                                                     \
         .debounce_scan_period_ms = DT_INST_PROP(n, debounce_scan_period_ms),                       \
         .poll_period_ms = DT_INST_PROP(n, poll_period_ms),                                         \
         .toggle_mode = DT_INST_PROP(n, toggle_mode),                                               \
     };                                                                                             \
                                                                                                    \
+    ZMK_KSCAN_BATCH_DEVICE_DEFINE(DT_DRV_INST(n));                                                 \
+                                                                                                   \
     PM_DEVICE_DT_INST_DEFINE(n, kscan_direct_pm_action);                                           \
                                                                                                    \
     DEVICE_DT_INST_DEFINE(n, &kscan_direct_init, PM_DEVICE_DT_INST_GET(n), &kscan_direct_data_##n, \
@@ -5,9 +5,12 @@
  */
 
 #include "kscan_gpio.h"
+#include "kscan_gpio_work_q.h"
 
+#include <string.h>
 #include <zephyr/device.h>
 #include <zephyr/devicetree.h>
+#include <zephyr/drivers/counter.h>
 #include <zephyr/drivers/gpio.h>
 #include <zephyr/drivers/kscan.h>
 #include <zephyr/pm/device.h>
@@ -16,6 +19,8 @@
 #include <zephyr/sys/__assert.h>
 #include <zephyr/sys/util.h>
 
+#include <drivers/gpio_595.h>
+#include <drivers/kscan_batch.h>
 #include <zmk/debounce.h>
 
 LOG_MODULE_DECLARE(zmk, CONFIG_ZMK_LOG_LEVEL);
@@ -28,8 +33,15 @@ LOG_MODULE_DECLARE(zmk, CONFIG_ZMK_LOG_LEVEL);
 
 #define INST_ROWS_LEN(n) DT_INST_PROP_LEN(n, row_gpios)
 #define INST_COLS_LEN(n) DT_INST_PROP_LEN(n, col_gpios)
-#define INST_MATRIX_LEN(n) (INST_ROWS_LEN(n) * INST_COLS_LEN(n))
 #define INST_INPUTS_LEN(n) COND_DIODE_DIR(n, (INST_COLS_LEN(n)), (INST_ROWS_LEN(n)))
+#define INST_OUTPUTS_LEN(n) COND_DIODE_DIR(n, (INST_ROWS_LEN(n)), (INST_COLS_LEN(n)))
+#define INST_INPUT_GROUPS(n) DIV_ROUND_UP(INST_INPUTS_LEN(n), ZMK_DEBOUNCE_GROUP_SIZE)
+#define INST_GROUPS_LEN(n) (INST_OUTPUTS_LEN(n) * INST_INPUT_GROUPS(n))
+#define INST_GROUP_WORDS(n) DIV_ROUND_UP(INST_GROUPS_LEN(n), 32)
+
+#define INST_DEBOUNCE_ALGORITHM(n) DT_INST_ENUM_IDX(n, debounce_algorithm)
+
+#define COND_ANTI_GHOSTING(n, code) COND_CODE_1(DT_INST_PROP(n, anti_ghosting), code, ())
 
 #if CONFIG_ZMK_KSCAN_DEBOUNCE_PRESS_MS >= 0
 #define INST_DEBOUNCE_PRESS_MS(n) CONFIG_ZMK_KSCAN_DEBOUNCE_PRESS_MS
@@ -52,6 +64,18 @@ LOG_MODULE_DECLARE(zmk, CONFIG_ZMK_LOG_LEVEL);
 #define COND_POLL_OR_INTERRUPTS(pollcode, intcode)                                                 \
     COND_CODE_1(CONFIG_ZMK_KSCAN_MATRIX_POLLING, pollcode, intcode)
 
+// Without a delay to let an output settle after it is set inactive, the next output is set active
+// in the same step, so outputs on a shift register can be changed with a single write.
+#define COMBINE_OUTPUT_CHANGES (CONFIG_ZMK_KSCAN_MATRIX_WAIT_BETWEEN_OUTPUTS == 0)
+
+#define USE_TIMER IS_ENABLED(CONFIG_ZMK_KSCAN_MATRIX_TIMER)
+
+#define COND_TIMER(code) COND_CODE_1(CONFIG_ZMK_KSCAN_MATRIX_TIMER, code, ())
+
+#define INST_SCAN_TIMER(n)                                                                         \
+    COND_CODE_1(DT_INST_NODE_HAS_PROP(n, scan_timer),                                              \
+                (DEVICE_DT_GET(DT_INST_PHANDLE(n, scan_timer))), (NULL))
+
 #define KSCAN_GPIO_ROW_CFG_INIT(idx, inst_idx)                                                     \
     KSCAN_GPIO_GET_BY_IDX(DT_DRV_INST(inst_idx), row_gpios, idx)
 #define KSCAN_GPIO_COL_CFG_INIT(idx, inst_idx)                                                     \
@@ -67,10 +91,21 @@ struct kscan_matrix_irq_callback {
     struct gpio_callback callback;
 };
 
+#if USE_TIMER
+/** Switches of one group that changed in a timer scan. */
+struct kscan_matrix_change {
+    int64_t timestamp_ticks;
+    uint32_t changed;
+    uint32_t pressed;
+    uint16_t index;
+};
+#endif
+
 struct kscan_matrix_data {
     const struct device *dev;
     struct kscan_gpio_list inputs;
     kscan_callback_t callback;
+    zmk_kscan_batch_callback_t batch_callback;
     struct k_work_delayable work;
 #if USE_INTERRUPTS
     /** Array of length config->inputs.len */
@@ -79,10 +114,49 @@ struct kscan_matrix_data {
     /** Timestamp of the current or scheduled scan. */
     int64_t scan_time;
     /**
-     * Current state of the matrix as a flattened 2D array of length
-     * (config->rows * config->cols)
+     * Raw state of the inputs read by the current scan, laid out like matrix_state with one bit
+     * per input.
+     */
+    uint32_t *scan_state;
+    /**
+     * Current state of the matrix as a flattened 2D array of debounce groups of length
+     * (config->outputs.len * config->input_groups). Each output has one group for every
+     * ZMK_DEBOUNCE_GROUP_SIZE inputs.
+     */
+    struct zmk_debounce_group *matrix_state;
+    /** Bitmap with one bit per group in matrix_state, set if any of its inputs were read active. */
+    uint32_t *scan_groups;
+    /**
+     * Bitmap with one bit per group in matrix_state, set if any of its switches are pressed or
+     * still being debounced. Groups with neither bit set are left alone after a scan.
+     */
+    uint32_t *active_groups;
+    /**
+     * Inputs of each group that are ambiguous because of ghosting in the current scan, laid out
+     * like matrix_state. NULL if anti-ghosting is disabled.
      */
-    struct zmk_debounce_state *matrix_state;
+    uint32_t *ghost_mask;
+#if USE_TIMER
+    /** Pressed state last reported for each group in matrix_state. */
+    uint32_t *reported_state;
+    /** Reports the changes found by timer scans, which run in interrupt context. */
+    struct k_work report_work;
+    /** Protects the fields below, which are set by timer scans. */
+    struct k_spinlock lock;
+    /** Changes found by timer scans that have not been reported yet, as a ring buffer. */
+    struct kscan_matrix_change changes[CONFIG_ZMK_KSCAN_MATRIX_TIMER_QUEUE_SIZE];
+    size_t changes_head;
+    size_t changes_len;
+    /**
+     * The ring buffer filled up and changes were dropped. Nothing more is queued until
+     * report_work reports the current state instead.
+     */
+    bool changes_overflow;
+    /** Timestamp of the first timer scan whose changes were dropped. */
+    int64_t overflow_ticks;
+    /** The timer stopped because no key is active. */
+    bool timer_idle;
+#endif
 };
 
 struct kscan_matrix_config {
@@ -90,45 +164,114 @@ struct kscan_matrix_config {
     struct zmk_debounce_config debounce_config;
     size_t rows;
     size_t cols;
+    size_t input_groups;
+    /** Length of the scan_groups and active_groups bitmaps. */
+    size_t group_words;
     int32_t debounce_scan_period_ms;
     int32_t poll_period_ms;
     enum kscan_diode_direction diode_direction;
+#if USE_TIMER
+    /** Counter that drives scans while any key is active, or NULL to scan from a work queue. */
+    const struct device *scan_timer;
+    uint32_t scan_period_us;
+#endif
 };
 
 /**
- * Get the index into a matrix state array from a row and column.
+ * Get the index into a matrix state array of the group containing the given input/output pins.
  */
-static int state_index_rc(const struct kscan_matrix_config *config, const int row, const int col) {
-    __ASSERT(row < config->rows, "Invalid row %i", row);
-    __ASSERT(col < config->cols, "Invalid column %i", col);
+static int state_index_io(const struct kscan_matrix_config *config, const int input_idx,
+                          const int output_idx) {
+    __ASSERT(input_idx < config->input_groups * ZMK_DEBOUNCE_GROUP_SIZE, "Invalid input %i",
+             input_idx);
+    __ASSERT(output_idx < config->outputs.len, "Invalid output %i", output_idx);
 
-    return (col * config->rows) + row;
+    return (output_idx * config->input_groups) + (input_idx / ZMK_DEBOUNCE_GROUP_SIZE);
 }
 
 /**
- * Get the index into a matrix state array from input/output pin indices.
+ * Buffer changes to outputs on shift registers until kscan_matrix_outputs_commit(), so each
+ * register is written once. Outputs on other GPIO controllers are set immediately.
  */
-static int state_index_io(const struct kscan_matrix_config *config, const int input_idx,
-                          const int output_idx) {
-    return (config->diode_direction == KSCAN_ROW2COL)
-               ? state_index_rc(config, output_idx, input_idx)
-               : state_index_rc(config, input_idx, output_idx);
+static void kscan_matrix_outputs_begin(const struct kscan_matrix_config *config) {
+#if IS_ENABLED(CONFIG_GPIO_595)
+    // Transactions nest, so a register shared by several outputs can be begun once per output.
+    for (int i = 0; i < config->outputs.len; i++) {
+        gpio_595_begin(config->outputs.gpios[i].spec.port);
+    }
+#endif
+}
+
+static int kscan_matrix_outputs_commit(const struct kscan_matrix_config *config) {
+    int ret = 0;
+
+#if IS_ENABLED(CONFIG_GPIO_595)
+    for (int i = 0; i < config->outputs.len; i++) {
+        const int err = gpio_595_commit(config->outputs.gpios[i].spec.port);
+        if (err && err != -ENOTSUP && ret == 0) {
+            LOG_ERR("Failed to write outputs: %i", err);
+            ret = err;
+        }
+    }
+#endif
+
+    return ret;
 }
 
 static int kscan_matrix_set_all_outputs(const struct device *dev, const int value) {
     const struct kscan_matrix_config *config = dev->config;
+    int err = 0;
 
-    for (int i = 0; i < config->outputs.len; i++) {
+    kscan_matrix_outputs_begin(config);
+
+    for (int i = 0; i < config->outputs.len && !err; i++) {
         const struct gpio_dt_spec *gpio = &config->outputs.gpios[i].spec;
 
-        int err = gpio_pin_set_dt(gpio, value);
+        err = gpio_pin_set_dt(gpio, value);
         if (err) {
             LOG_ERR("Failed to set output %i to %i: %i", i, value, err);
-            return err;
         }
     }
 
-    return 0;
+    const int commit_err = kscan_matrix_outputs_commit(config);
+    return err ? err : commit_err;
+}
+
+/**
+ * Set output @p prev inactive, then output @p next active. Either may be -1 to skip it. If both
+ * are on the same shift register, it is written once with both changes.
+ */
+static int kscan_matrix_select_output(const struct kscan_matrix_config *config, const int prev,
+                                      const int next) {
+    const struct kscan_gpio *prev_gpio = prev >= 0 ? &config->outputs.gpios[prev] : NULL;
+    const struct kscan_gpio *next_gpio = next >= 0 ? &config->outputs.gpios[next] : NULL;
+    const struct device *port = next_gpio ? next_gpio->spec.port : prev_gpio->spec.port;
+    const bool buffered = gpio_595_begin(port) == 0;
+    int err = 0;
+
+    if (prev_gpio) {
+        err = gpio_pin_set_dt(&prev_gpio->spec, 0);
+        if (err) {
+            LOG_ERR("Failed to set output %i inactive: %i", prev_gpio->index, err);
+        }
+    }
+
+    if (next_gpio && !err) {
+        err = gpio_pin_set_dt(&next_gpio->spec, 1);
+        if (err) {
+            LOG_ERR("Failed to set output %i active: %i", next_gpio->index, err);
+        }
+    }
+
+    if (buffered) {
+        const int commit_err = gpio_595_commit(port);
+        if (commit_err && !err) {
+            LOG_ERR("Failed to write outputs: %i", commit_err);
+            err = commit_err;
+        }
+    }
+
+    return err;
 }
 
 #if USE_INTERRUPTS
@@ -175,6 +318,10 @@ static int kscan_matrix_interrupt_disable(const struct device *dev) {
 }
 #endif
 
+#if USE_TIMER
+static int kscan_matrix_timer_start(const struct device *dev);
+#endif
+
 #if USE_INTERRUPTS
 static void kscan_matrix_irq_callback_handler(const struct device *port, struct gpio_callback *cb,
                                               const gpio_port_pins_t pin) {
@@ -185,9 +332,18 @@ static void kscan_matrix_irq_callback_handler(const struct device *port, struct
     // Disable our interrupts temporarily to avoid re-entry while we scan.
     kscan_matrix_interrupt_disable(data->dev);
 
+#if USE_TIMER
+    const struct kscan_matrix_config *config = data->dev->config;
+
+    if (config->scan_timer) {
+        kscan_matrix_timer_start(data->dev);
+        return;
+    }
+#endif
+
     data->scan_time = k_uptime_get();
 
-    k_work_reschedule(&data->work, K_NO_WAIT);
+    k_work_reschedule_for_queue(kscan_gpio_work_q(), &data->work, K_NO_WAIT);
 }
 #endif
 
@@ -195,9 +351,17 @@ static void kscan_matrix_read_continue(const struct device *dev) {
     const struct kscan_matrix_config *config = dev->config;
     struct kscan_matrix_data *data = dev->data;
 
+#if USE_TIMER
+    if (config->scan_timer) {
+        kscan_matrix_timer_start(dev);
+        return;
+    }
+#endif
+
     data->scan_time += config->debounce_scan_period_ms;
 
-    k_work_reschedule(&data->work, K_TIMEOUT_ABS_MS(data->scan_time));
+    k_work_reschedule_for_queue(kscan_gpio_work_q(), &data->work,
+                                K_TIMEOUT_ABS_MS(data->scan_time));
 }
 
 static void kscan_matrix_read_end(const struct device *dev) {
@@ -211,21 +375,83 @@ static void kscan_matrix_read_end(const struct device *dev) {
     data->scan_time += config->poll_period_ms;
 
     // Return to polling slowly.
-    k_work_reschedule(&data->work, K_TIMEOUT_ABS_MS(data->scan_time));
+    k_work_reschedule_for_queue(kscan_gpio_work_q(), &data->work,
+                                K_TIMEOUT_ABS_MS(data->scan_time));
 #endif
 }
 
-static int kscan_matrix_read(const struct device *dev) {
+/**
+ * In a matrix without diodes, pressing three corners of a rectangle of switches connects the
+ * fourth as well, so any two outputs that share two or more active inputs might be showing a
+ * phantom press. Hold the inputs they share at their debounced state until the pattern goes away.
+ */
+static void kscan_matrix_block_ghosts(const struct device *dev) {
     struct kscan_matrix_data *data = dev->data;
     const struct kscan_matrix_config *config = dev->config;
+    const size_t groups = config->input_groups;
+    bool found = false;
+
+    memset(data->ghost_mask, 0, config->outputs.len * groups * sizeof(uint32_t));
+
+    for (int a = 0; a < config->outputs.len; a++) {
+        const uint32_t *state_a = &data->scan_state[state_index_io(config, 0, a)];
+
+        for (int b = a + 1; b < config->outputs.len; b++) {
+            const uint32_t *state_b = &data->scan_state[state_index_io(config, 0, b)];
+            uint32_t shared = 0;
+            bool ghost = false;
+
+            for (int g = 0; g < groups && !ghost; g++) {
+                const uint32_t common = state_a[g] & state_b[g];
+
+                // Two shared inputs, either in this group or one here and one in an earlier group.
+                ghost = (common & (common - 1)) != 0 || (common != 0 && shared != 0);
+                shared |= common;
+            }
+
+            if (!ghost) {
+                continue;
+            }
+
+            for (int g = 0; g < groups; g++) {
+                const uint32_t common = state_a[g] & state_b[g];
+
+                data->ghost_mask[state_index_io(config, 0, a) + g] |= common;
+                data->ghost_mask[state_index_io(config, 0, b) + g] |= common;
+            }
+
+            found = true;
+        }
+    }
+
+    if (!found) {
+        return;
+    }
+
+    for (int i = 0; i < config->outputs.len * groups; i++) {
+        const uint32_t mask = data->ghost_mask[i];
+        const uint32_t pressed = zmk_debounce_group_get_pressed(&data->matrix_state[i]);
+
+        data->scan_state[i] = (data->scan_state[i] & ~mask) | (pressed & mask);
+    }
+}
+
+/**
+ * Read the raw state of every switch into data->scan_state.
+ */
+static int kscan_matrix_read_inputs(const struct device *dev) {
+    struct kscan_matrix_data *data = dev->data;
+    const struct kscan_matrix_config *config = dev->config;
+
+    memset(data->scan_state, 0, config->outputs.len * config->input_groups * sizeof(uint32_t));
+    memset(data->scan_groups, 0, config->group_words * sizeof(uint32_t));
 
     // Scan the matrix.
     for (int i = 0; i < config->outputs.len; i++) {
         const struct kscan_gpio *out_gpio = &config->outputs.gpios[i];
 
-        int err = gpio_pin_set_dt(&out_gpio->spec, 1);
+        int err = kscan_matrix_select_output(config, COMBINE_OUTPUT_CHANGES ? i - 1 : -1, i);
         if (err) {
-            LOG_ERR("Failed to set output %i active: %i", out_gpio->index, err);
             return err;
         }
 
@@ -244,41 +470,179 @@ static int kscan_matrix_read(const struct device *dev) {
                 return active;
             }
 
-            zmk_debounce_update(&data->matrix_state[index], active, config->debounce_scan_period_ms,
-                                &config->debounce_config);
+            if (active) {
+                data->scan_state[index] |= BIT(in_gpio->index % ZMK_DEBOUNCE_GROUP_SIZE);
+                data->scan_groups[index / 32] |= BIT(index % 32);
+            }
         }
 
-        err = gpio_pin_set_dt(&out_gpio->spec, 0);
+#if !COMBINE_OUTPUT_CHANGES
+        err = kscan_matrix_select_output(config, i, -1);
         if (err) {
-            LOG_ERR("Failed to set output %i inactive: %i", out_gpio->index, err);
             return err;
         }
 
-#if CONFIG_ZMK_KSCAN_MATRIX_WAIT_BETWEEN_OUTPUTS > 0
         k_busy_wait(CONFIG_ZMK_KSCAN_MATRIX_WAIT_BETWEEN_OUTPUTS);
 #endif
     }
 
-    // Process the new state.
-    bool continue_scan = false;
+#if COMBINE_OUTPUT_CHANGES
+    int err = kscan_matrix_select_output(config, config->outputs.len - 1, -1);
+    if (err) {
+        return err;
+    }
+#endif
+
+    if (data->ghost_mask) {
+        kscan_matrix_block_ghosts(dev);
+    }
+
+    return 0;
+}
+
+/**
+ * Add the switches in @p changed for the given output and input group to a batch.
+ */
+static void kscan_matrix_add_changes(struct zmk_kscan_batch_writer *batch,
+                                     const struct kscan_matrix_config *config, const int output,
+                                     const int input_group, uint32_t changed,
+                                     const uint32_t pressed) {
+    // Only visit the switches that changed, lowest input first.
+    for (; changed != 0; changed &= changed - 1) {
+        const int bit = find_lsb_set(changed) - 1;
+        const int input = (input_group * ZMK_DEBOUNCE_GROUP_SIZE) + bit;
+        const int r = (config->diode_direction == KSCAN_ROW2COL) ? output : input;
+        const int c = (config->diode_direction == KSCAN_ROW2COL) ? input : output;
+        const bool is_pressed = (pressed & BIT(bit)) != 0;
+
+        LOG_DBG("Sending event at %i,%i state %s", r, c, is_pressed ? "on" : "off");
+        zmk_kscan_batch_writer_add(batch, r, c, is_pressed);
+    }
+}
+
+#if USE_TIMER
+/**
+ * Queue a change found by a timer scan for report_work. Each scan's changes keep their own
+ * timestamp, so a press and release found by different scans are both reported even if
+ * report_work doesn't run in between.
+ */
+static void kscan_matrix_queue_change(struct kscan_matrix_data *data, const int64_t timestamp_ticks,
+                                      const int index, const uint32_t changed,
+                                      const uint32_t pressed) {
+    k_spinlock_key_t key = k_spin_lock(&data->lock);
+
+    if (data->changes_overflow) {
+        // Already dropping changes. report_work will report the current state.
+    } else if (data->changes_len == ARRAY_SIZE(data->changes)) {
+        data->changes_overflow = true;
+        data->overflow_ticks = timestamp_ticks;
+    } else {
+        const size_t slot = (data->changes_head + data->changes_len) % ARRAY_SIZE(data->changes);
+
+        data->changes[slot] = (struct kscan_matrix_change){
+            .timestamp_ticks = timestamp_ticks,
+            .changed = changed,
+            .pressed = pressed,
+            .index = index,
+        };
+        data->changes_len++;
+    }
+
+    k_spin_unlock(&data->lock, key);
+}
+#endif // USE_TIMER
 
-    for (int r = 0; r < config->rows; r++) {
-        for (int c = 0; c < config->cols; c++) {
-            const int index = state_index_rc(config, r, c);
-            struct zmk_debounce_state *state = &data->matrix_state[index];
+/**
+ * Debounce the groups that were read active by the last scan or are still active from earlier
+ * scans. Every other group has all switches released and idle, so debouncing it would change
+ * nothing.
+ *
+ * @param elapsed_us Time since the previous scan in microseconds.
+ * @param timestamp_ticks Time of the scan.
+ * @param batch If not NULL, the changes are added to this batch. Otherwise they are queued for
+ * report_work.
+ * @returns whether any switch changed.
+ */
+static bool kscan_matrix_debounce(const struct device *dev, const uint32_t elapsed_us,
+                                  const int64_t timestamp_ticks,
+                                  struct zmk_kscan_batch_writer *batch) {
+    struct kscan_matrix_data *data = dev->data;
+    const struct kscan_matrix_config *config = dev->config;
+    bool any_changed = false;
+
+    for (int w = 0; w < config->group_words; w++) {
+        uint32_t pending = data->scan_groups[w] | data->active_groups[w];
+
+        // Lowest group first, which is the same as visiting each output's groups in order.
+        for (; pending != 0; pending &= pending - 1) {
+            const int bit = find_lsb_set(pending) - 1;
+            const int index = (w * 32) + bit;
+            struct zmk_debounce_group *group = &data->matrix_state[index];
+
+            const uint32_t changed = zmk_debounce_group_update_us(
+                group, data->scan_state[index], elapsed_us, &config->debounce_config);
 
-            if (zmk_debounce_get_changed(state)) {
-                const bool pressed = zmk_debounce_is_pressed(state);
+            WRITE_BIT(data->active_groups[w], bit, zmk_debounce_group_get_active(group) != 0);
 
-                LOG_DBG("Sending event at %i,%i state %s", r, c, pressed ? "on" : "off");
-                data->callback(dev, r, c, pressed);
+            if (changed == 0) {
+                continue;
             }
 
-            continue_scan = continue_scan || zmk_debounce_is_active(state);
+            any_changed = true;
+
+            const uint32_t pressed = zmk_debounce_group_get_pressed(group);
+
+            if (batch) {
+                kscan_matrix_add_changes(batch, config, index / config->input_groups,
+                                         index % config->input_groups, changed, pressed);
+#if USE_TIMER
+                data->reported_state[index] = pressed;
+            } else {
+                kscan_matrix_queue_change(data, timestamp_ticks, index, changed, pressed);
+#endif
+            }
         }
     }
 
-    if (continue_scan) {
+    return any_changed;
+}
+
+/**
+ * @returns whether any switch is pressed or still being debounced.
+ */
+static bool kscan_matrix_is_active(const struct device *dev) {
+    const struct kscan_matrix_data *data = dev->data;
+    const struct kscan_matrix_config *config = dev->config;
+
+    for (int w = 0; w < config->group_words; w++) {
+        if (data->active_groups[w] != 0) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+static int kscan_matrix_read(const struct device *dev) {
+    struct kscan_matrix_data *data = dev->data;
+    const struct kscan_matrix_config *config = dev->config;
+    const int64_t timestamp_ticks = k_uptime_ticks();
+
+    int err = kscan_matrix_read_inputs(dev);
+    if (err) {
+        return err;
+    }
+
+    // Process the new state.
+    struct zmk_kscan_batch_writer batch;
+
+    zmk_kscan_batch_writer_init(&batch, dev, data->callback, data->batch_callback,
+                                timestamp_ticks);
+    kscan_matrix_debounce(dev, config->debounce_scan_period_ms * USEC_PER_MSEC, timestamp_ticks,
+                          &batch);
+    zmk_kscan_batch_writer_flush(&batch);
+
+    if (kscan_matrix_is_active(dev)) {
         // At least one key is pressed or the debouncer has not yet decided if
         // it is pressed. Poll quickly until everything is released.
         kscan_matrix_read_continue(dev);
@@ -290,6 +654,158 @@ static int kscan_matrix_read(const struct device *dev) {
     return 0;
 }
 
+#if USE_TIMER
+static void kscan_matrix_timer_handler(const struct device *timer, void *user_data) {
+    const struct device *dev = user_data;
+    struct kscan_matrix_data *data = dev->data;
+    const struct kscan_matrix_config *config = dev->config;
+    const int64_t timestamp_ticks = k_uptime_ticks();
+
+    // Only the GPIO reads and debouncing happen here. Reporting the changes runs callbacks that
+    // may invoke behaviors, so that is left to the work queue.
+    if (kscan_matrix_read_inputs(dev) != 0) {
+        return;
+    }
+
+    const bool changed = kscan_matrix_debounce(dev, config->scan_period_us, timestamp_ticks, NULL);
+    const bool active = kscan_matrix_is_active(dev);
+
+    if (!active) {
+        // All keys are released. Stop fast scanning until the next interrupt or poll.
+        counter_stop(timer);
+    }
+
+    if (changed || !active) {
+        k_spinlock_key_t key = k_spin_lock(&data->lock);
+        data->timer_idle = !active;
+        k_spin_unlock(&data->lock, key);
+
+        k_work_submit_to_queue(kscan_gpio_work_q(), &data->report_work);
+    }
+}
+
+static int kscan_matrix_timer_start(const struct device *dev) {
+    const struct kscan_matrix_config *config = dev->config;
+    const struct counter_top_cfg top_cfg = {
+        .ticks = counter_us_to_ticks(config->scan_timer, config->scan_period_us),
+        .callback = kscan_matrix_timer_handler,
+        .user_data = (void *)dev,
+    };
+
+    int err = counter_set_top_value(config->scan_timer, &top_cfg);
+    if (err) {
+        LOG_ERR("Failed to set the scan timer period: %i", err);
+        return err;
+    }
+
+    return counter_start(config->scan_timer);
+}
+
+/**
+ * Report the switches in @p changed that differ from the last reported state. Changes already
+ * covered by a report of the current state after an overflow are skipped.
+ */
+static void kscan_matrix_report_change(struct kscan_matrix_data *data,
+                                       const struct kscan_matrix_config *config,
+                                       struct zmk_kscan_batch_writer *batch, const int index,
+                                       const uint32_t changed, const uint32_t pressed) {
+    const uint32_t report = changed & (pressed ^ data->reported_state[index]);
+
+    kscan_matrix_add_changes(batch, config, index / config->input_groups,
+                             index % config->input_groups, report, pressed);
+    data->reported_state[index] ^= report;
+}
+
+/**
+ * Get the oldest change queued by a timer scan.
+ *
+ * @returns false if there are none.
+ */
+static bool kscan_matrix_get_change(struct kscan_matrix_data *data,
+                                    struct kscan_matrix_change *change) {
+    bool found = false;
+
+    k_spinlock_key_t key = k_spin_lock(&data->lock);
+
+    if (data->changes_len > 0) {
+        *change = data->changes[data->changes_head];
+        data->changes_head = (data->changes_head + 1) % ARRAY_SIZE(data->changes);
+        data->changes_len--;
+        found = true;
+    }
+
+    k_spin_unlock(&data->lock, key);
+
+    return found;
+}
+
+static void kscan_matrix_report_work_handler(struct k_work *work) {
+    struct kscan_matrix_data *data = CONTAINER_OF(work, struct kscan_matrix_data, report_work);
+    const struct device *dev = data->dev;
+    const struct kscan_matrix_config *config = dev->config;
+    struct zmk_kscan_batch_writer batch;
+    struct kscan_matrix_change change;
+
+    bool first = true;
+    int64_t batch_ticks = 0;
+
+    // Report every queued change with the time of the scan that found it, so a tap that was
+    // pressed and released before this ran is still reported as two changes. Changes from the
+    // same scan are reported as one batch.
+    while (kscan_matrix_get_change(data, &change)) {
+        if (first || change.timestamp_ticks != batch_ticks) {
+            if (!first) {
+                zmk_kscan_batch_writer_flush(&batch);
+            }
+
+            batch_ticks = change.timestamp_ticks;
+            zmk_kscan_batch_writer_init(&batch, dev, data->callback, data->batch_callback,
+                                        batch_ticks);
+            first = false;
+        }
+
+        kscan_matrix_report_change(data, config, &batch, change.index, change.changed,
+                                   change.pressed);
+    }
+
+    if (!first) {
+        zmk_kscan_batch_writer_flush(&batch);
+    }
+
+    k_spinlock_key_t key = k_spin_lock(&data->lock);
+
+    // The queue is empty, so the timer scan can start queueing again once the flag is cleared.
+    // Anything it queues before the state is read below is skipped as already reported.
+    const bool overflow = data->changes_overflow;
+    const int64_t overflow_ticks = data->overflow_ticks;
+    const bool idle = data->timer_idle;
+    data->changes_overflow = false;
+    data->timer_idle = false;
+
+    k_spin_unlock(&data->lock, key);
+
+    if (overflow) {
+        LOG_WRN("Matrix change queue full, reporting the current state");
+
+        zmk_kscan_batch_writer_init(&batch, dev, data->callback, data->batch_callback,
+                                    overflow_ticks);
+
+        for (int i = 0; i < config->outputs.len * config->input_groups; i++) {
+            const uint32_t pressed = zmk_debounce_group_get_pressed(&data->matrix_state[i]);
+
+            kscan_matrix_report_change(data, config, &batch, i, UINT32_MAX, pressed);
+        }
+
+        zmk_kscan_batch_writer_flush(&batch);
+    }
+
+    if (idle) {
+        data->scan_time = k_uptime_get();
+        kscan_matrix_read_end(dev);
+    }
+}
+#endif // USE_TIMER
+
 static void kscan_matrix_work_handler(struct k_work *work) {
     struct k_work_delayable *dwork = k_work_delayable_from_work(work);
     struct kscan_matrix_data *data = CONTAINER_OF(dwork, struct kscan_matrix_data, work);
@@ -304,12 +820,35 @@ static int kscan_matrix_configure(const struct device *dev, const kscan_callback
     }
 
     data->callback = callback;
+    data->batch_callback = NULL;
+    return 0;
+}
+
+static int kscan_matrix_configure_batch(const struct device *dev,
+                                        const zmk_kscan_batch_callback_t callback) {
+    struct kscan_matrix_data *data = dev->data;
+
+    if (!callback) {
+        return -EINVAL;
+    }
+
+    data->batch_callback = callback;
+    data->callback = NULL;
     return 0;
 }
 
 static int kscan_matrix_enable(const struct device *dev) {
     struct kscan_matrix_data *data = dev->data;
 
+#if USE_TIMER
+    const struct kscan_matrix_config *config = dev->config;
+
+    if (config->scan_timer && !device_is_ready(config->scan_timer)) {
+        LOG_ERR("Scan timer %s is not ready", config->scan_timer->name);
+        return -ENODEV;
+    }
+#endif
+
     data->scan_time = k_uptime_get();
 
     // Read will automatically start interrupts/polling once done.
@@ -321,6 +860,15 @@ static int kscan_matrix_disable(const struct device *dev) {
 
     k_work_cancel_delayable(&data->work);
 
+#if USE_TIMER
+    const struct kscan_matrix_config *config = dev->config;
+
+    if (config->scan_timer) {
+        counter_stop(config->scan_timer);
+        k_work_cancel(&data->report_work);
+    }
+#endif
+
 #if USE_INTERRUPTS
     return kscan_matrix_interrupt_disable(dev);
 #else
@@ -418,6 +966,9 @@ static int kscan_matrix_init(const struct device *dev) {
     kscan_matrix_set_all_outputs(dev, 0);
 
     k_work_init_delayable(&data->work, kscan_matrix_work_handler);
+#if USE_TIMER
+    k_work_init(&data->report_work, kscan_matrix_report_work_handler);
+#endif
 
     return 0;
 }
@@ -437,10 +988,14 @@ static int kscan_matrix_pm_action(const struct device *dev, enum pm_device_actio
 
 #endif // IS_ENABLED(CONFIG_PM_DEVICE)
 
-static const struct kscan_driver_api kscan_matrix_api = {
-    .config = kscan_matrix_configure,
-    .enable_callback = kscan_matrix_enable,
-    .disable_callback = kscan_matrix_disable,
+static const struct zmk_kscan_batch_driver_api kscan_matrix_api = {
+    .kscan =
+        {
+            .config = kscan_matrix_configure,
+            .enable_callback = kscan_matrix_enable,
+            .disable_callback = kscan_matrix_disable,
+        },
+    .config_batch = kscan_matrix_configure_batch,
 };
 
 #define KSCAN_MATRIX_INIT(n)                                                                       \
@@ -448,6 +1003,17 @@ static const struct kscan_driver_api kscan_matrix_api = {
                  "ZMK_KSCAN_DEBOUNCE_PRESS_MS or debounce-press-ms is too large");                 \
     BUILD_ASSERT(INST_DEBOUNCE_RELEASE_MS(n) <= DEBOUNCE_COUNTER_MAX,                              \
                  "ZMK_KSCAN_DEBOUNCE_RELEASE_MS or debounce-release-ms is too large");             \
+    BUILD_ASSERT(DT_INST_PROP(n, scan_period_us) > 0, "scan-period-us must be positive");          \
+    BUILD_ASSERT(!DT_INST_NODE_HAS_PROP(n, scan_timer) ||                                          \
+                     INST_DEBOUNCE_PRESS_MS(n) * 1000ULL <=                                        \
+                         DEBOUNCE_COUNTER_MAX * (uint64_t)DT_INST_PROP(n, scan_period_us),         \
+                 "Press debounce time is longer than DEBOUNCE_COUNTER_MAX scans of "               \
+                 "scan-period-us");                                                                \
+    BUILD_ASSERT(!DT_INST_NODE_HAS_PROP(n, scan_timer) ||                                          \
+                     INST_DEBOUNCE_RELEASE_MS(n) * 1000ULL <=                                      \
+                         DEBOUNCE_COUNTER_MAX * (uint64_t)DT_INST_PROP(n, scan_period_us),         \
+                 "Release debounce time is longer than DEBOUNCE_COUNTER_MAX scans of "             \
+                 "scan-period-us");                                                                \
                                                                                                    \
     static struct kscan_gpio kscan_matrix_rows_##n[] = {                                           \
         LISTIFY(INST_ROWS_LEN(n), KSCAN_GPIO_ROW_CFG_INIT, (, ), n)};                              \
@@ -455,7 +1021,12 @@ static const struct kscan_driver_api kscan_matrix_api = {
     static struct kscan_gpio kscan_matrix_cols_##n[] = {                                           \
         LISTIFY(INST_COLS_LEN(n), KSCAN_GPIO_COL_CFG_INIT, (, ), n)};                              \
                                                                                                    \
-    static struct zmk_debounce_state kscan_matrix_state_##n[INST_MATRIX_LEN(n)];                   \
+    static uint32_t kscan_matrix_scan_state_##n[INST_GROUPS_LEN(n)];                               \
+    static struct zmk_debounce_group kscan_matrix_state_##n[INST_GROUPS_LEN(n)];                   \
+    static uint32_t kscan_matrix_scan_groups_##n[INST_GROUP_WORDS(n)];                             \
+    static uint32_t kscan_matrix_active_groups_##n[INST_GROUP_WORDS(n)];                           \
+    COND_ANTI_GHOSTING(n, (static uint32_t kscan_matrix_ghost_mask_##n[INST_GROUPS_LEN(n)];))      \
+    COND_TIMER((static uint32_t kscan_matrix_reported_state_##n[INST_GROUPS_LEN(n)];))             \
                                                                                                    \
     COND_INTERRUPTS(                                                                               \
         (static struct kscan_matrix_irq_callback kscan_matrix_irqs_##n[INST_INPUTS_LEN(n)];))      \
@@ -463,24 +1034,36 @@ static const struct kscan_driver_api kscan_matrix_api = {
     static struct kscan_matrix_data kscan_matrix_data_##n = {                                      \
         .inputs =                                                                                  \
             KSCAN_GPIO_LIST(COND_DIODE_DIR(n, (kscan_matrix_cols_##n), (kscan_matrix_rows_##n))),  \
+        .scan_state = kscan_matrix_scan_state_##n,                                                 \
         .matrix_state = kscan_matrix_state_##n,                                                    \
+        .scan_groups = kscan_matrix_scan_groups_##n,                                               \
+        .active_groups = kscan_matrix_active_groups_##n,                                           \
+        COND_ANTI_GHOSTING(n, (.ghost_mask = kscan_matrix_ghost_mask_##n, ))                       \
+        COND_TIMER((.reported_state = kscan_matrix_reported_state_##n, ))                          \
         COND_INTERRUPTS((.irqs = kscan_matrix_irqs_##n, ))};                                       \
                                                                                                    \
     static struct kscan_matrix_config kscan_matrix_config_##n = {                                  \
         .rows = ARRAY_SIZE(kscan_matrix_rows_##n),                                                 \
         .cols = ARRAY_SIZE(kscan_matrix_cols_##n),                                                 \
+        .input_groups = INST_INPUT_GROUPS(n),                                                      \
+        .group_words = INST_GROUP_WORDS(n),                                                        \
         .outputs =                                                                                 \
             KSCAN_GPIO_LIST(COND_DIODE_DIR(n, (kscan_matrix_rows_##n), (kscan_matrix_cols_##n))),  \
         .debounce_config =                                                                         \
             {                                                                                      \
                 .debounce_press_ms = INST_DEBOUNCE_PRESS_MS(n),                                    \
                 .debounce_release_ms = INST_DEBOUNCE_RELEASE_MS(n),                                \
+                .algorithm = INST_DEBOUNCE_ALGORITHM(n),                                           \
             },                                                                                     \
         .debounce_scan_period_ms = DT_INST_PROP(n, debounce_scan_period_ms),                       \
         .poll_period_ms = DT_INST_PROP(n, poll_period_ms),                                         \
         .diode_direction = INST_DIODE_DIR(n),                                                      \
+        COND_TIMER((.scan_timer = INST_SCAN_TIMER(n),                                              \
+                    .scan_period_us = DT_INST_PROP(n, scan_period_us), ))                          \
     };                                                                                             \
                                                                                                    \
+    ZMK_KSCAN_BATCH_DEVICE_DEFINE(DT_DRV_INST(n));                                                 \
+                                                                                                   \
     PM_DEVICE_DT_INST_DEFINE(n, kscan_matrix_pm_action);                                           \
                                                                                                    \
     DEVICE_DT_INST_DEFINE(n, &kscan_matrix_init, PM_DEVICE_DT_INST_GET(n), &kscan_matrix_data_##n, \
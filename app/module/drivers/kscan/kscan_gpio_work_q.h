@@ -0,0 +1,25 @@
+/*
+ * Copyright (c) 2023 The ZMK Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#pragma once
+
+#include <zephyr/kernel.h>
+
+#if IS_ENABLED(CONFIG_ZMK_INPUT_WORK_QUEUE)
+// Provided by the application, which handles the rest of the key input on the same queue.
+struct k_work_q *zmk_workqueue_input_work_q(void);
+#endif
+
+/**
+ * Get the work queue that scans should run on.
+ */
+static inline struct k_work_q *kscan_gpio_work_q(void) {
+#if IS_ENABLED(CONFIG_ZMK_INPUT_WORK_QUEUE)
+    return zmk_workqueue_input_work_q();
+#else
+    return &k_sys_work_q;
+#endif
+}
@@ -0,0 +1,110 @@
+/*
+ * Copyright (c) 2023 The ZMK Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#define DT_DRV_COMPAT zmk_pointing_mock
+
+#include <zephyr/device.h>
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+
+#include <drivers/pointing.h>
+#include <dt-bindings/zmk/pointing_mock.h>
+
+LOG_MODULE_DECLARE(zmk, CONFIG_ZMK_LOG_LEVEL);
+
+struct pointing_mock_config {
+    const uint32_t *events;
+    size_t events_len;
+};
+
+struct pointing_mock_data {
+    pointing_callback_t callback;
+
+    uint32_t event_index;
+    struct k_work_delayable work;
+    const struct device *dev;
+};
+
+static void pointing_mock_schedule_next_event(const struct device *dev) {
+    struct pointing_mock_data *data = dev->data;
+    const struct pointing_mock_config *cfg = dev->config;
+
+    if (data->event_index < cfg->events_len) {
+        uint32_t ev = cfg->events[data->event_index];
+        k_work_schedule(&data->work, K_MSEC(ZMK_POINTING_MOCK_MSEC(ev)));
+    }
+}
+
+static void pointing_mock_work_handler(struct k_work *work) {
+    struct k_work_delayable *d_work = k_work_delayable_from_work(work);
+    struct pointing_mock_data *data = CONTAINER_OF(d_work, struct pointing_mock_data, work);
+    const struct pointing_mock_config *cfg = data->dev->config;
+    uint32_t ev = cfg->events[data->event_index++];
+
+    LOG_DBG("dx %d dy %d", ZMK_POINTING_MOCK_DX(ev), ZMK_POINTING_MOCK_DY(ev));
+    data->callback(data->dev, ZMK_POINTING_MOCK_DX(ev), ZMK_POINTING_MOCK_DY(ev));
+
+    pointing_mock_schedule_next_event(data->dev);
+}
+
+static int pointing_mock_configure(const struct device *dev, pointing_callback_t callback) {
+    struct pointing_mock_data *data = dev->data;
+
+    if (!callback) {
+        return -EINVAL;
+    }
+
+    data->event_index = 0;
+    data->callback = callback;
+
+    return 0;
+}
+
+static int pointing_mock_enable_callback(const struct device *dev) {
+    struct pointing_mock_data *data = dev->data;
+
+    if (!data->callback) {
+        return -EINVAL;
+    }
+
+    pointing_mock_schedule_next_event(dev);
+    return 0;
+}
+
+static int pointing_mock_disable_callback(const struct device *dev) {
+    struct pointing_mock_data *data = dev->data;
+
+    k_work_cancel_delayable(&data->work);
+    return 0;
+}
+
+static int pointing_mock_init(const struct device *dev) {
+    struct pointing_mock_data *data = dev->data;
+
+    data->dev = dev;
+    k_work_init_delayable(&data->work, pointing_mock_work_handler);
+
+    return 0;
+}
+
+static const struct pointing_driver_api pointing_mock_driver_api = {
+    .config = pointing_mock_configure,
+    .enable_callback = pointing_mock_enable_callback,
+    .disable_callback = pointing_mock_disable_callback,
+};
+
+#define POINTING_MOCK_INST(n)                                                                      \
+    static const uint32_t pointing_mock_events_##n[] = DT_INST_PROP(n, events);                    \
+    static struct pointing_mock_data pointing_mock_data_##n;                                       \
+    static const struct pointing_mock_config pointing_mock_config_##n = {                          \
+        .events = pointing_mock_events_##n,                                                        \
+        .events_len = ARRAY_SIZE(pointing_mock_events_##n),                                        \
+    };                                                                                             \
+    DEVICE_DT_INST_DEFINE(n, pointing_mock_init, NULL, &pointing_mock_data_##n,                    \
+                          &pointing_mock_config_##n, POST_KERNEL,                                  \
+                          CONFIG_KERNEL_INIT_PRIORITY_DEFAULT, &pointing_mock_driver_api);
+
+DT_INST_FOREACH_STATUS_OKAY(POINTING_MOCK_INST)
@@ -0,0 +1,59 @@
+/*
+ * Copyright (c) 2023 The ZMK Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#pragma once
+
+#include <errno.h>
+#include <zephyr/device.h>
+#include <zephyr/sys/util.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#if IS_ENABLED(CONFIG_GPIO_595) || defined(__DOXYGEN__)
+
+/**
+ * @brief Start buffering output changes on a 595 shift register.
+ *
+ * Until the matching gpio_595_commit(), pin changes made by the calling thread only update the
+ * cached register state, and other threads writing to the device block. Calls may be nested; the
+ * registers are written once the outermost transaction is committed.
+ *
+ * @param dev Pointer to the device structure for the driver instance.
+ *
+ * @retval 0 If successful.
+ * @retval -ENOTSUP If @p dev is not a 595 shift register.
+ * @retval -EWOULDBLOCK If called from an ISR.
+ */
+int gpio_595_begin(const struct device *dev);
+
+/**
+ * @brief Finish a transaction started with gpio_595_begin().
+ *
+ * If this ends the outermost transaction, the buffered state is written with a single SPI
+ * transfer, unless it matches what the registers already hold.
+ *
+ * @param dev Pointer to the device structure for the driver instance.
+ *
+ * @retval 0 If successful.
+ * @retval -ENOTSUP If @p dev is not a 595 shift register.
+ * @retval -EWOULDBLOCK If called from an ISR.
+ * @retval Negative errno code if the write failed.
+ */
+int gpio_595_commit(const struct device *dev);
+
+#else
+
+static inline int gpio_595_begin(const struct device *dev) { return -ENOTSUP; }
+
+static inline int gpio_595_commit(const struct device *dev) { return -ENOTSUP; }
+
+#endif
+
+#ifdef __cplusplus
+}
+#endif
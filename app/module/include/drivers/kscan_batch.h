@@ -0,0 +1,179 @@
+/*
+ * Copyright (c) 2023 The ZMK Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#pragma once
+
+#include <errno.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <zephyr/device.h>
+#include <zephyr/drivers/kscan.h>
+#include <zephyr/sys/iterable_sections.h>
+#include <zephyr/sys/util.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** A single switch change reported by a scan. */
+struct zmk_kscan_change {
+    uint16_t row;
+    uint16_t column;
+    bool pressed;
+};
+
+/** The switch changes found by one scan pass. */
+struct zmk_kscan_batch {
+    /** Uptime in ticks, from k_uptime_ticks(), when the scan that found the changes was read. */
+    int64_t timestamp_ticks;
+    size_t len;
+    const struct zmk_kscan_change *changes;
+};
+
+/**
+ * @brief Batched kscan callback.
+ *
+ * Called by the driver with every change found by a scan. The batch is only valid for the
+ * duration of the call.
+ *
+ * @param dev Pointer to the device structure for the driver instance.
+ * @param batch The changes found by the scan.
+ */
+typedef void (*zmk_kscan_batch_callback_t)(const struct device *dev,
+                                           const struct zmk_kscan_batch *batch);
+
+/**
+ * @cond INTERNAL_HIDDEN
+ *
+ * Batched kscan driver API definition. Extends the Zephyr kscan API, so drivers implementing it
+ * can still be used through kscan_config().
+ *
+ * (Internal use only.)
+ */
+
+typedef int (*zmk_kscan_batch_config_t)(const struct device *dev,
+                                        zmk_kscan_batch_callback_t callback);
+
+__subsystem struct zmk_kscan_batch_driver_api {
+    struct kscan_driver_api kscan;
+    zmk_kscan_batch_config_t config_batch;
+};
+
+struct zmk_kscan_batch_device {
+    const struct device *dev;
+};
+
+/**
+ * @endcond
+ */
+
+/**
+ * Marks the device for devicetree node @p node_id as implementing zmk_kscan_batch_driver_api.
+ */
+#define ZMK_KSCAN_BATCH_DEVICE_DEFINE(node_id)                                                     \
+    static const STRUCT_SECTION_ITERABLE(                                                          \
+        zmk_kscan_batch_device, _CONCAT(zmk_kscan_batch_device_, DT_DEP_ORD(node_id))) = {         \
+        .dev = DEVICE_DT_GET(node_id),                                                             \
+    }
+
+/**
+ * @brief Check whether a kscan device can report changes in batches.
+ * @param dev Pointer to the device structure for the driver instance.
+ */
+static inline bool zmk_kscan_batch_is_supported(const struct device *dev) {
+    STRUCT_SECTION_FOREACH(zmk_kscan_batch_device, entry) {
+        if (entry->dev == dev) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/**
+ * @brief Configure a kscan device to report changes in batches. This replaces any callback set
+ * with kscan_config().
+ * @param dev Pointer to the device structure for the driver instance.
+ * @param callback Called with the changes found by each scan.
+ *
+ * @retval 0 If successful.
+ * @retval -ENOTSUP If the device does not support batches.
+ * @retval Negative errno code if failure.
+ */
+static inline int zmk_kscan_batch_config(const struct device *dev,
+                                         zmk_kscan_batch_callback_t callback) {
+    if (!zmk_kscan_batch_is_supported(dev)) {
+        return -ENOTSUP;
+    }
+
+    const struct zmk_kscan_batch_driver_api *api =
+        (const struct zmk_kscan_batch_driver_api *)dev->api;
+
+    return api->config_batch(dev, callback);
+}
+
+/**
+ * Helper for drivers to collect the changes from one scan and report them to whichever callback
+ * is configured. Intended to live on the stack of the scan function.
+ */
+struct zmk_kscan_batch_writer {
+    const struct device *dev;
+    kscan_callback_t callback;
+    zmk_kscan_batch_callback_t batch_callback;
+    struct zmk_kscan_batch batch;
+    struct zmk_kscan_change changes[CONFIG_ZMK_KSCAN_BATCH_CHANGES_MAX];
+};
+
+/**
+ * Starts collecting changes for a scan read at @p timestamp_ticks. Changes are passed to
+ * @p batch_callback if it is set, otherwise they are passed to @p callback one at a time.
+ */
+static inline void zmk_kscan_batch_writer_init(struct zmk_kscan_batch_writer *writer,
+                                               const struct device *dev,
+                                               kscan_callback_t callback,
+                                               zmk_kscan_batch_callback_t batch_callback,
+                                               int64_t timestamp_ticks) {
+    writer->dev = dev;
+    writer->callback = callback;
+    writer->batch_callback = batch_callback;
+    writer->batch =
+        (struct zmk_kscan_batch){.timestamp_ticks = timestamp_ticks, .changes = writer->changes};
+}
+
+/**
+ * Reports the changes collected so far.
+ */
+static inline void zmk_kscan_batch_writer_flush(struct zmk_kscan_batch_writer *writer) {
+    if (writer->batch.len > 0) {
+        writer->batch_callback(writer->dev, &writer->batch);
+        writer->batch.len = 0;
+    }
+}
+
+/**
+ * Adds a change to the scan. If the writer is full, the changes collected so far are reported as
+ * a batch first.
+ */
+static inline void zmk_kscan_batch_writer_add(struct zmk_kscan_batch_writer *writer, uint32_t row,
+                                              uint32_t column, bool pressed) {
+    if (!writer->batch_callback) {
+        if (writer->callback) {
+            writer->callback(writer->dev, row, column, pressed);
+        }
+        return;
+    }
+
+    if (writer->batch.len == ARRAY_SIZE(writer->changes)) {
+        zmk_kscan_batch_writer_flush(writer);
+    }
+
+    writer->changes[writer->batch.len++] =
+        (struct zmk_kscan_change){.row = row, .column = column, .pressed = pressed};
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,131 @@
+/*
+ * Copyright (c) 2023 The ZMK Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#pragma once
+
+#include <errno.h>
+#include <zephyr/types.h>
+#include <stddef.h>
+#include <zephyr/device.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Pointing devices have their own driver API instead of reporting motion as sensor events. The
+// sensor path raises a zmk_sensor_event for every data ready trigger and hands it to the sensor
+// bindings of the active layers, while motion must be summed between reports without an event
+// per sample.
+
+/**
+ * @brief Pointing device motion callback.
+ *
+ * Called by the driver with the relative motion, in sensor counts, measured since the last
+ * callback. May be called from an interrupt context, so implementations must not block.
+ *
+ * @param dev Pointer to the device structure for the driver instance.
+ * @param dx Motion along the sensor's X axis.
+ * @param dy Motion along the sensor's Y axis.
+ */
+typedef void (*pointing_callback_t)(const struct device *dev, int16_t dx, int16_t dy);
+
+/**
+ * @cond INTERNAL_HIDDEN
+ *
+ * Pointing driver API definition.
+ *
+ * (Internal use only.)
+ */
+
+typedef int (*pointing_config_t)(const struct device *dev, pointing_callback_t callback);
+typedef int (*pointing_enable_callback_t)(const struct device *dev);
+typedef int (*pointing_disable_callback_t)(const struct device *dev);
+typedef int (*pointing_set_cpi_t)(const struct device *dev, uint32_t cpi);
+
+__subsystem struct pointing_driver_api {
+    pointing_config_t config;
+    pointing_enable_callback_t enable_callback;
+    pointing_disable_callback_t disable_callback;
+    pointing_set_cpi_t set_cpi;
+};
+/**
+ * @endcond
+ */
+
+/**
+ * @brief Configure the callback to report motion to.
+ * @param dev Pointer to the device structure for the driver instance.
+ * @param callback Called when motion is sampled.
+ *
+ * @retval 0 If successful.
+ * @retval Negative errno code if failure.
+ */
+static inline int pointing_config(const struct device *dev, pointing_callback_t callback) {
+    const struct pointing_driver_api *api = (const struct pointing_driver_api *)dev->api;
+
+    if (api->config == NULL) {
+        return -ENOTSUP;
+    }
+
+    return api->config(dev, callback);
+}
+
+/**
+ * @brief Start reporting motion to the configured callback.
+ * @param dev Pointer to the device structure for the driver instance.
+ *
+ * @retval 0 If successful.
+ * @retval Negative errno code if failure.
+ */
+static inline int pointing_enable_callback(const struct device *dev) {
+    const struct pointing_driver_api *api = (const struct pointing_driver_api *)dev->api;
+
+    if (api->enable_callback == NULL) {
+        return -ENOTSUP;
+    }
+
+    return api->enable_callback(dev);
+}
+
+/**
+ * @brief Stop reporting motion to the configured callback.
+ * @param dev Pointer to the device structure for the driver instance.
+ *
+ * @retval 0 If successful.
+ * @retval Negative errno code if failure.
+ */
+static inline int pointing_disable_callback(const struct device *dev) {
+    const struct pointing_driver_api *api = (const struct pointing_driver_api *)dev->api;
+
+    if (api->disable_callback == NULL) {
+        return -ENOTSUP;
+    }
+
+    return api->disable_callback(dev);
+}
+
+/**
+ * @brief Change the resolution of the sensor, in counts per inch.
+ * @param dev Pointer to the device structure for the driver instance.
+ * @param cpi The requested resolution.
+ *
+ * @retval 0 If successful.
+ * @retval -ENOTSUP If the sensor has a fixed resolution.
+ * @retval Negative errno code if failure.
+ */
+static inline int pointing_set_cpi(const struct device *dev, uint32_t cpi) {
+    const struct pointing_driver_api *api = (const struct pointing_driver_api *)dev->api;
+
+    if (api->set_cpi == NULL) {
+        return -ENOTSUP;
+    }
+
+    return api->set_cpi(dev, cpi);
+}
+
+#ifdef __cplusplus
+}
+#endif
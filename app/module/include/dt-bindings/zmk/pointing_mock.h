@@ -0,0 +1,13 @@
+/*
+ * Copyright (c) 2023 The ZMK Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#pragma once
+
+#define ZMK_POINTING_MOCK_MOVE(dx, dy, msec)                                                       \
+    ((((dx)&0xFF) << 24) + (((dy)&0xFF) << 16) + ((msec)&0xFFFF))
+#define ZMK_POINTING_MOCK_DX(v) ((int8_t)(((v) >> 24) & 0xFF))
+#define ZMK_POINTING_MOCK_DY(v) ((int8_t)(((v) >> 16) & 0xFF))
+#define ZMK_POINTING_MOCK_MSEC(v) ((v)&0xFFFF)
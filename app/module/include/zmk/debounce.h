@@ -16,14 +16,33 @@
 struct zmk_debounce_state {
     bool pressed : 1;
     bool changed : 1;
+    /** The counter is a lockout after an eager change rather than an integrator. */
+    bool locked : 1;
     uint16_t counter : DEBOUNCE_COUNTER_BITS;
 };
 
+enum zmk_debounce_algorithm {
+    /** Latch a change once the switch has been in its new state for the debounce time. */
+    ZMK_DEBOUNCE_ALGORITHM_DEFER,
+    /** Latch a change immediately, then ignore the switch for the debounce time. */
+    ZMK_DEBOUNCE_ALGORITHM_EAGER,
+    /** Latch a press immediately, then ignore the switch for the press debounce time. Releases
+     * are deferred. */
+    ZMK_DEBOUNCE_ALGORITHM_EAGER_PRESS,
+};
+
 struct zmk_debounce_config {
-    /** Duration a switch must be pressed to latch as pressed. */
+    /**
+     * Duration a switch must be pressed to latch as pressed, or the duration to ignore a switch
+     * after an eager press.
+     */
     uint32_t debounce_press_ms;
-    /** Duration a switch must be released to latch as released. */
+    /**
+     * Duration a switch must be released to latch as released, or the duration to ignore a
+     * switch after an eager release.
+     */
     uint32_t debounce_release_ms;
+    enum zmk_debounce_algorithm algorithm;
 };
 
 /**
@@ -54,3 +73,56 @@ bool zmk_debounce_is_pressed(const struct zmk_debounce_state *state);
  * debounce_update.
  */
 bool zmk_debounce_get_changed(const struct zmk_debounce_state *state);
+
+/** Number of switches debounced together by a zmk_debounce_group. */
+#define ZMK_DEBOUNCE_GROUP_SIZE 32
+
+/**
+ * Debounce state for up to ZMK_DEBOUNCE_GROUP_SIZE switches, with bit N of every
+ * field belonging to switch N.
+ *
+ * The integrator counters are stored as vertical bit-planes: counter[i] holds bit i
+ * of every switch's counter, so all of them can be updated with a handful of word
+ * operations instead of one update per switch. Counters count scans rather than
+ * milliseconds, so a group must always be updated with the same elapsed time.
+ */
+struct zmk_debounce_group {
+    uint32_t pressed;
+    uint32_t locked;
+    uint32_t counter[DEBOUNCE_COUNTER_BITS];
+};
+
+/**
+ * Debounces a group of switches. Gives the same results as calling zmk_debounce_update()
+ * for each switch with the same, fixed elapsed time.
+ *
+ * @param group The state for the switches to debounce.
+ * @param active Bitmask of the switches that are currently pressed.
+ * @param elapsed_ms Time elapsed since the previous update in milliseconds. Must be positive.
+ * @param config Debounce settings.
+ * @returns a bitmask of the switches whose pressed state changed.
+ */
+uint32_t zmk_debounce_group_update(struct zmk_debounce_group *group, const uint32_t active,
+                                   const int elapsed_ms, const struct zmk_debounce_config *config);
+
+/**
+ * zmk_debounce_group_update(), but with the elapsed time in microseconds, for scans faster
+ * than once per millisecond. Debounce times longer than DEBOUNCE_COUNTER_MAX updates are
+ * limited to that many updates.
+ *
+ * @param elapsed_us Time elapsed since the previous update in microseconds. Must be positive.
+ */
+uint32_t zmk_debounce_group_update_us(struct zmk_debounce_group *group, const uint32_t active,
+                                      const uint32_t elapsed_us,
+                                      const struct zmk_debounce_config *config);
+
+/**
+ * @returns a bitmask of the switches in the group for which zmk_debounce_is_active()
+ * would return true.
+ */
+uint32_t zmk_debounce_group_get_active(const struct zmk_debounce_group *group);
+
+/**
+ * @returns a bitmask of the switches in the group that are latched as pressed.
+ */
+uint32_t zmk_debounce_group_get_pressed(const struct zmk_debounce_group *group);
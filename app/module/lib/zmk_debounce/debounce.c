@@ -4,6 +4,7 @@
  * SPDX-License-Identifier: MIT
  */
 
+#include <zephyr/sys_clock.h>
 #include <zmk/debounce.h>
 
 static uint32_t get_threshold(const struct zmk_debounce_state *state,
@@ -27,15 +28,48 @@ static void decrement_counter(struct zmk_debounce_state *state, const int elapse
     }
 }
 
+static bool is_eager(const struct zmk_debounce_state *state,
+                     const struct zmk_debounce_config *config) {
+    switch (config->algorithm) {
+    case ZMK_DEBOUNCE_ALGORITHM_EAGER:
+        return true;
+    case ZMK_DEBOUNCE_ALGORITHM_EAGER_PRESS:
+        return !state->pressed;
+    default:
+        return false;
+    }
+}
+
 void zmk_debounce_update(struct zmk_debounce_state *state, const bool active, const int elapsed_ms,
                          const struct zmk_debounce_config *config) {
+    state->changed = false;
+
+    // After an eager change, the switch is ignored until the lockout counts down to zero.
+    if (state->locked) {
+        if (state->counter > 0) {
+            decrement_counter(state, elapsed_ms);
+            return;
+        }
+
+        state->locked = false;
+    }
+
+    if (is_eager(state, config)) {
+        if (active != state->pressed) {
+            // Lock the switch for the debounce time of the change being latched.
+            state->counter = get_threshold(state, config);
+            state->locked = true;
+            state->pressed = active;
+            state->changed = true;
+        }
+        return;
+    }
+
     // This uses a variation of the integrator debouncing described at
     // https://www.kennethkuhn.com/electronics/debounce.c
     // Every update where "active" does not match the current state, we increment
     // a counter, otherwise we decrement it. When the counter reaches a
     // threshold, the state flips and we reset the counter.
-    state->changed = false;
-
     if (active == state->pressed) {
         decrement_counter(state, elapsed_ms);
         return;
@@ -59,4 +93,124 @@ bool zmk_debounce_is_active(const struct zmk_debounce_state *state) {
 
 bool zmk_debounce_is_pressed(const struct zmk_debounce_state *state) { return state->pressed; }
 
-bool zmk_debounce_get_changed(const struct zmk_debounce_state *state) { return state->changed; }
\ No newline at end of file
+bool zmk_debounce_get_changed(const struct zmk_debounce_state *state) { return state->changed; }
+
+static uint32_t group_counter_nonzero(const struct zmk_debounce_group *group) {
+    uint32_t nonzero = 0;
+    for (int i = 0; i < DEBOUNCE_COUNTER_BITS; i++) {
+        nonzero |= group->counter[i];
+    }
+    return nonzero;
+}
+
+/**
+ * Compares every counter in the group against the threshold for its switch, which is the
+ * release threshold for pressed switches and the press threshold for released ones.
+ *
+ * @returns a bitmask of the switches whose counter is at or above its threshold.
+ */
+static uint32_t group_counter_at_threshold(const struct zmk_debounce_group *group,
+                                           const uint32_t press_threshold,
+                                           const uint32_t release_threshold) {
+    uint32_t greater = 0;
+    uint32_t equal = UINT32_MAX;
+
+    // Walk the bit-planes from the most significant bit. The first bit where a counter and
+    // its threshold differ decides which one is larger.
+    for (int i = DEBOUNCE_COUNTER_BITS - 1; i >= 0; i--) {
+        const uint32_t threshold = ((press_threshold & BIT(i)) ? ~group->pressed : 0) |
+                                   ((release_threshold & BIT(i)) ? group->pressed : 0);
+        const uint32_t counter = group->counter[i];
+
+        greater |= equal & counter & ~threshold;
+        equal &= ~(counter ^ threshold);
+    }
+
+    return greater | equal;
+}
+
+static uint32_t group_eager_mask(const struct zmk_debounce_group *group,
+                                 const struct zmk_debounce_config *config) {
+    switch (config->algorithm) {
+    case ZMK_DEBOUNCE_ALGORITHM_EAGER:
+        return UINT32_MAX;
+    case ZMK_DEBOUNCE_ALGORITHM_EAGER_PRESS:
+        return ~group->pressed;
+    default:
+        return 0;
+    }
+}
+
+static uint32_t group_threshold(const uint32_t debounce_ms, const uint32_t elapsed_us) {
+    return MIN(DIV_ROUND_UP(debounce_ms * USEC_PER_MSEC, elapsed_us), DEBOUNCE_COUNTER_MAX);
+}
+
+uint32_t zmk_debounce_group_update(struct zmk_debounce_group *group, const uint32_t active,
+                                   const int elapsed_ms, const struct zmk_debounce_config *config) {
+    return zmk_debounce_group_update_us(group, active, elapsed_ms * USEC_PER_MSEC, config);
+}
+
+uint32_t zmk_debounce_group_update_us(struct zmk_debounce_group *group, const uint32_t active,
+                                      const uint32_t elapsed_us,
+                                      const struct zmk_debounce_config *config) {
+    // This is the same as zmk_debounce_update(), but with the counters in units of updates.
+    // With a fixed elapsed time, a counter of N updates corresponds to N * elapsed_us, so it
+    // reaches a threshold or a lockout expires after the same number of updates once the
+    // debounce times are rounded up to a whole number of updates.
+    const uint32_t press_threshold = group_threshold(config->debounce_press_ms, elapsed_us);
+    const uint32_t release_threshold = group_threshold(config->debounce_release_ms, elapsed_us);
+    const uint32_t nonzero = group_counter_nonzero(group);
+
+    // Switches whose lockout has expired go back to normal.
+    group->locked &= nonzero;
+
+    const uint32_t locked = group->locked;
+    const uint32_t eager = group_eager_mask(group, config) & ~locked;
+    const uint32_t deferred = ~(eager | locked);
+
+    const uint32_t mismatch = active ^ group->pressed;
+    const uint32_t at_threshold =
+        group_counter_at_threshold(group, press_threshold, release_threshold);
+    const uint32_t eager_changed = mismatch & eager;
+    const uint32_t changed = eager_changed | (mismatch & deferred & at_threshold);
+
+    // Count up deferred switches that don't match their state yet and count down ones that do,
+    // stopping at zero. Lockouts always count down. Both are ripple-carry additions across the
+    // bit-planes. A counter is never incremented past its threshold, so it can't overflow.
+    uint32_t carry = mismatch & deferred & ~at_threshold;
+    uint32_t borrow = (locked | (~mismatch & deferred)) & nonzero;
+
+    for (int i = 0; i < DEBOUNCE_COUNTER_BITS && (carry | borrow); i++) {
+        const uint32_t counter = group->counter[i];
+
+        group->counter[i] = counter ^ carry ^ borrow;
+        carry &= counter;
+        borrow &= ~counter;
+    }
+
+    // Latch the switches that changed. Deferred switches start counting from zero again, while
+    // eager ones are locked for the debounce time of the change.
+    if (changed) {
+        const uint32_t press_lockout = eager_changed & ~group->pressed;
+        const uint32_t release_lockout = eager_changed & group->pressed;
+
+        group->pressed ^= changed;
+        group->locked |= eager_changed;
+
+        for (int i = 0; i < DEBOUNCE_COUNTER_BITS; i++) {
+            group->counter[i] = (group->counter[i] & ~changed) |
+                                ((press_threshold & BIT(i)) ? press_lockout : 0) |
+                                ((release_threshold & BIT(i)) ? release_lockout : 0);
+        }
+    }
+
+    return changed;
+}
+
+uint32_t zmk_debounce_group_get_active(const struct zmk_debounce_group *group) {
+    return group->pressed | group_counter_nonzero(group);
+}
+
+uint32_t zmk_debounce_group_get_pressed(const struct zmk_debounce_group *group) {
+    return group->pressed;
+}
@@ -0,0 +1,165 @@
+/*
+ * Copyright (c) 2023 The ZMK Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <zephyr/device.h>
+#include <zephyr/drivers/kscan.h>
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/ztest.h>
+
+#include "matrix_gpio.h"
+
+LOG_MODULE_REGISTER(zmk, CONFIG_ZMK_LOG_LEVEL);
+
+#define ROWS DT_PROP_LEN(DT_NODELABEL(kscan0), row_gpios)
+#define COLS DT_PROP_LEN(DT_NODELABEL(kscan0), col_gpios)
+
+// Long enough for any change to be read and debounced with the default settings.
+#define SETTLE_TIME K_MSEC(50)
+
+static const struct device *const kscan = DEVICE_DT_GET(DT_NODELABEL(kscan0));
+
+static bool pressed[ROWS][COLS];
+// Changes that were out of range or did not change anything. Counted here since the callback
+// runs on the work queue, and checked by the tests.
+static int invalid_changes;
+
+static void kscan_callback(const struct device *dev, uint32_t row, uint32_t column, bool state) {
+    if (row >= ROWS || column >= COLS || pressed[row][column] == state) {
+        LOG_ERR("Unexpected change at %u,%u: %d", row, column, state);
+        invalid_changes++;
+        return;
+    }
+
+    pressed[row][column] = state;
+}
+
+// Close a switch and give the driver time to report it.
+static void press(int row, int col) {
+    test_matrix_set_switch(row, col, true);
+    k_sleep(SETTLE_TIME);
+}
+
+static void release(int row, int col) {
+    test_matrix_set_switch(row, col, false);
+    k_sleep(SETTLE_TIME);
+}
+
+/**
+ * Checks the keys reported as pressed against a list of row, column pairs.
+ */
+static void assert_pressed(const int (*keys)[2], size_t len) {
+    bool expected[ROWS][COLS] = {0};
+
+    zassert_equal(invalid_changes, 0);
+
+    for (size_t i = 0; i < len; i++) {
+        expected[keys[i][0]][keys[i][1]] = true;
+    }
+
+    for (int r = 0; r < ROWS; r++) {
+        for (int c = 0; c < COLS; c++) {
+            zassert_equal(pressed[r][c], expected[r][c], "%d,%d is %s", r, c,
+                          pressed[r][c] ? "pressed" : "released");
+        }
+    }
+}
+
+#define ASSERT_PRESSED(...)                                                                        \
+    do {                                                                                           \
+        static const int keys[][2] = {__VA_ARGS__};                                                \
+        assert_pressed(keys, ARRAY_SIZE(keys));                                                    \
+    } while (0)
+
+#define ASSERT_NONE_PRESSED() assert_pressed(NULL, 0)
+
+ZTEST(kscan_gpio_matrix, test_rectangle_in_one_group) {
+    press(0, 1);
+    press(0, 2);
+    ASSERT_PRESSED({0, 1}, {0, 2});
+
+    // Closing a third corner connects row 1 to both columns through row 0, so 1,1 can't be told
+    // apart from a phantom 1,2. Both stay released.
+    press(1, 1);
+    ASSERT_PRESSED({0, 1}, {0, 2});
+
+    // Once 0,2 is released, only the real press is left.
+    release(0, 2);
+    ASSERT_PRESSED({0, 1}, {1, 1});
+
+    release(0, 1);
+    release(1, 1);
+    ASSERT_NONE_PRESSED();
+}
+
+ZTEST(kscan_gpio_matrix, test_rectangle_across_groups) {
+    // Columns 0 and 33 are in different debounce groups of the same row.
+    press(2, 0);
+    press(2, 33);
+    ASSERT_PRESSED({2, 0}, {2, 33});
+
+    press(3, 33);
+    ASSERT_PRESSED({2, 0}, {2, 33});
+
+    release(2, 0);
+    ASSERT_PRESSED({2, 33}, {3, 33});
+
+    release(2, 33);
+    release(3, 33);
+    ASSERT_NONE_PRESSED();
+}
+
+ZTEST(kscan_gpio_matrix, test_single_shared_input) {
+    // Two rows sharing a single column is not ambiguous, so nothing is blocked.
+    press(0, 5);
+    press(1, 5);
+    press(2, 7);
+    ASSERT_PRESSED({0, 5}, {1, 5}, {2, 7});
+
+    release(0, 5);
+    ASSERT_PRESSED({1, 5}, {2, 7});
+
+    release(1, 5);
+    release(2, 7);
+    ASSERT_NONE_PRESSED();
+}
+
+ZTEST(kscan_gpio_matrix, test_blocked_key_released) {
+    press(1, 3);
+    press(1, 32);
+    press(3, 3);
+    ASSERT_PRESSED({1, 3}, {1, 32});
+
+    // Releasing the blocked key ends the pattern without reporting anything for it.
+    release(3, 3);
+    ASSERT_PRESSED({1, 3}, {1, 32});
+
+    // Row 3 is no longer connected to row 1, so its other keys work again.
+    press(3, 4);
+    ASSERT_PRESSED({1, 3}, {1, 32}, {3, 4});
+
+    release(1, 3);
+    release(1, 32);
+    release(3, 4);
+    ASSERT_NONE_PRESSED();
+}
+
+static void *kscan_gpio_matrix_setup(void) {
+    zassert_true(device_is_ready(kscan));
+    zassert_ok(kscan_config(kscan, kscan_callback));
+    zassert_ok(kscan_enable_callback(kscan));
+
+    return NULL;
+}
+
+static void kscan_gpio_matrix_after(void *fixture) {
+    test_matrix_open_all();
+    k_sleep(SETTLE_TIME);
+
+    ASSERT_NONE_PRESSED();
+}
+
+ZTEST_SUITE(kscan_gpio_matrix, NULL, kscan_gpio_matrix_setup, NULL, kscan_gpio_matrix_after, NULL);
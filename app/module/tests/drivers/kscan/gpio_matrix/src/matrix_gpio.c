@@ -0,0 +1,175 @@
+/*
+ * Copyright (c) 2023 The ZMK Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#define DT_DRV_COMPAT zmk_test_matrix_gpio
+
+#include <string.h>
+#include <zephyr/device.h>
+#include <zephyr/drivers/gpio.h>
+#include <zephyr/kernel.h>
+#include <zephyr/sys/__assert.h>
+#include <zephyr/sys/util.h>
+
+#include "matrix_gpio.h"
+
+#define MAX_ROWS 32
+#define MAX_COLS 64
+
+struct matrix_gpio_config {
+    /* gpio_driver_config needs to be first */
+    struct gpio_driver_config common;
+    bool rows;
+    uint8_t first_line;
+};
+
+struct matrix_gpio_data {
+    /* gpio_driver_data needs to be first */
+    struct gpio_driver_data common;
+};
+
+static struct k_spinlock lock;
+/** Columns connected to each row by a closed switch. */
+static uint64_t closed[MAX_ROWS];
+/** Rows currently driven active. */
+static uint32_t active_rows;
+
+void test_matrix_set_switch(int row, int col, bool closed_state) {
+    __ASSERT(row < MAX_ROWS && col < MAX_COLS, "Invalid switch %d,%d", row, col);
+
+    K_SPINLOCK(&lock) {
+        if (closed_state) {
+            closed[row] |= BIT64(col);
+        } else {
+            closed[row] &= ~BIT64(col);
+        }
+    }
+}
+
+void test_matrix_open_all(void) {
+    K_SPINLOCK(&lock) { memset(closed, 0, sizeof(closed)); }
+}
+
+/**
+ * Without diodes, current flows both ways through a switch, so a column reads active if any path
+ * of closed switches connects it to an active row.
+ */
+static uint64_t connected_cols(void) {
+    uint32_t rows = active_rows;
+    uint64_t cols = 0;
+
+    while (true) {
+        uint64_t next_cols = 0;
+        uint32_t next_rows = rows;
+
+        for (int r = 0; r < MAX_ROWS; r++) {
+            if (rows & BIT(r)) {
+                next_cols |= closed[r];
+            }
+        }
+
+        for (int r = 0; r < MAX_ROWS; r++) {
+            if (closed[r] & next_cols) {
+                next_rows |= BIT(r);
+            }
+        }
+
+        if (next_cols == cols && next_rows == rows) {
+            return cols;
+        }
+
+        cols = next_cols;
+        rows = next_rows;
+    }
+}
+
+static int matrix_gpio_pin_configure(const struct device *dev, gpio_pin_t pin, gpio_flags_t flags) {
+    const struct matrix_gpio_config *config = dev->config;
+
+    if ((flags & GPIO_OUTPUT) && !config->rows) {
+        return -ENOTSUP;
+    }
+
+    if (flags & GPIO_OUTPUT_INIT_HIGH) {
+        K_SPINLOCK(&lock) { active_rows |= BIT(config->first_line + pin); }
+    } else if (flags & GPIO_OUTPUT_INIT_LOW) {
+        K_SPINLOCK(&lock) { active_rows &= ~BIT(config->first_line + pin); }
+    }
+
+    return 0;
+}
+
+static int matrix_gpio_port_get_raw(const struct device *dev, gpio_port_value_t *value) {
+    const struct matrix_gpio_config *config = dev->config;
+
+    K_SPINLOCK(&lock) {
+        if (config->rows) {
+            *value = active_rows >> config->first_line;
+        } else {
+            *value = connected_cols() >> config->first_line;
+        }
+        *value &= config->common.port_pin_mask;
+    }
+
+    return 0;
+}
+
+static int matrix_gpio_port_set_masked_raw(const struct device *dev, gpio_port_pins_t mask,
+                                           gpio_port_value_t value) {
+    const struct matrix_gpio_config *config = dev->config;
+
+    if (!config->rows) {
+        return -ENOTSUP;
+    }
+
+    K_SPINLOCK(&lock) {
+        active_rows = (active_rows & ~(mask << config->first_line)) |
+                      ((value & mask) << config->first_line);
+    }
+
+    return 0;
+}
+
+static int matrix_gpio_port_set_bits_raw(const struct device *dev, gpio_port_pins_t pins) {
+    return matrix_gpio_port_set_masked_raw(dev, pins, pins);
+}
+
+static int matrix_gpio_port_clear_bits_raw(const struct device *dev, gpio_port_pins_t pins) {
+    return matrix_gpio_port_set_masked_raw(dev, pins, 0);
+}
+
+static int matrix_gpio_port_toggle_bits(const struct device *dev, gpio_port_pins_t pins) {
+    gpio_port_value_t value;
+
+    matrix_gpio_port_get_raw(dev, &value);
+    return matrix_gpio_port_set_masked_raw(dev, pins, value ^ pins);
+}
+
+static const struct gpio_driver_api matrix_gpio_api = {
+    .pin_configure = matrix_gpio_pin_configure,
+    .port_get_raw = matrix_gpio_port_get_raw,
+    .port_set_masked_raw = matrix_gpio_port_set_masked_raw,
+    .port_set_bits_raw = matrix_gpio_port_set_bits_raw,
+    .port_clear_bits_raw = matrix_gpio_port_clear_bits_raw,
+    .port_toggle_bits = matrix_gpio_port_toggle_bits,
+};
+
+#define MATRIX_GPIO_INIT(n)                                                                        \
+    BUILD_ASSERT(DT_INST_PROP(n, first_line) + DT_INST_PROP(n, ngpios) <=                          \
+                     (DT_INST_PROP(n, matrix_rows) ? MAX_ROWS : MAX_COLS),                         \
+                 "Too many matrix lines");                                                         \
+                                                                                                   \
+    static const struct matrix_gpio_config matrix_gpio_config_##n = {                              \
+        .common = {.port_pin_mask = GPIO_PORT_PIN_MASK_FROM_DT_INST(n)},                           \
+        .rows = DT_INST_PROP(n, matrix_rows),                                                      \
+        .first_line = DT_INST_PROP(n, first_line),                                                 \
+    };                                                                                             \
+                                                                                                   \
+    static struct matrix_gpio_data matrix_gpio_data_##n;                                           \
+                                                                                                   \
+    DEVICE_DT_INST_DEFINE(n, NULL, NULL, &matrix_gpio_data_##n, &matrix_gpio_config_##n,           \
+                          PRE_KERNEL_1, CONFIG_GPIO_INIT_PRIORITY, &matrix_gpio_api);
+
+DT_INST_FOREACH_STATUS_OKAY(MATRIX_GPIO_INIT)
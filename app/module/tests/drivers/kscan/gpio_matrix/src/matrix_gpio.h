@@ -0,0 +1,19 @@
+/*
+ * Copyright (c) 2023 The ZMK Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#pragma once
+
+#include <stdbool.h>
+
+/**
+ * Open or close the switch between a row and a column of the simulated matrix.
+ */
+void test_matrix_set_switch(int row, int col, bool closed);
+
+/**
+ * Open every switch of the simulated matrix.
+ */
+void test_matrix_open_all(void);
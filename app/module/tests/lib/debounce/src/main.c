@@ -0,0 +1,411 @@
+/*
+ * Copyright (c) 2023 The ZMK Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <zephyr/sys/time_units.h>
+#include <zephyr/ztest.h>
+
+#include <zmk/debounce.h>
+
+#define EQUIVALENCE_RUNS 200
+#define EQUIVALENCE_STEPS 400
+
+static const enum zmk_debounce_algorithm algorithms[] = {
+    ZMK_DEBOUNCE_ALGORITHM_DEFER,
+    ZMK_DEBOUNCE_ALGORITHM_EAGER,
+    ZMK_DEBOUNCE_ALGORITHM_EAGER_PRESS,
+};
+
+// A fixed pseudo-random sequence, so failures can be reproduced.
+static uint32_t rand_state;
+
+static uint32_t next_rand(void) {
+    rand_state ^= rand_state << 13;
+    rand_state ^= rand_state >> 17;
+    rand_state ^= rand_state << 5;
+    return rand_state;
+}
+
+// Switch inputs that mostly stay put, with some switches bouncing and some changing for good.
+static uint32_t next_active(uint32_t active) {
+    switch (next_rand() % 4) {
+    case 0:
+        return next_rand() & next_rand();
+    case 1:
+        return active ^ BIT(next_rand() % ZMK_DEBOUNCE_GROUP_SIZE);
+    default:
+        return active;
+    }
+}
+
+static void assert_group_matches(const struct zmk_debounce_group *group,
+                                 const struct zmk_debounce_state states[], uint32_t changed,
+                                 int run, int step) {
+    for (int i = 0; i < ZMK_DEBOUNCE_GROUP_SIZE; i++) {
+        zassert_equal(zmk_debounce_get_changed(&states[i]), (changed & BIT(i)) != 0,
+                      "changed differs for switch %d in run %d, step %d", i, run, step);
+        zassert_equal(zmk_debounce_is_pressed(&states[i]),
+                      (zmk_debounce_group_get_pressed(group) & BIT(i)) != 0,
+                      "pressed differs for switch %d in run %d, step %d", i, run, step);
+        zassert_equal(zmk_debounce_is_active(&states[i]),
+                      (zmk_debounce_group_get_active(group) & BIT(i)) != 0,
+                      "active differs for switch %d in run %d, step %d", i, run, step);
+    }
+}
+
+/**
+ * Feeds the same inputs to a group and to one scalar state per switch. The group is updated with
+ * elapsed_us, and the scalar states with scalar_elapsed_ms and scalar_config.
+ */
+static void assert_group_equivalent(const struct zmk_debounce_config *config,
+                                    const uint32_t elapsed_us,
+                                    const struct zmk_debounce_config *scalar_config,
+                                    const int scalar_elapsed_ms, const int run) {
+    struct zmk_debounce_group group = {0};
+    struct zmk_debounce_state states[ZMK_DEBOUNCE_GROUP_SIZE] = {0};
+    uint32_t active = 0;
+
+    for (int step = 0; step < EQUIVALENCE_STEPS; step++) {
+        active = next_active(active);
+
+        const uint32_t changed = zmk_debounce_group_update_us(&group, active, elapsed_us, config);
+        for (int i = 0; i < ZMK_DEBOUNCE_GROUP_SIZE; i++) {
+            zmk_debounce_update(&states[i], (active & BIT(i)) != 0, scalar_elapsed_ms,
+                                scalar_config);
+        }
+
+        assert_group_matches(&group, states, changed, run, step);
+    }
+}
+
+static uint32_t updates_for(const uint32_t debounce_ms, const uint32_t elapsed_us) {
+    return MIN(DIV_ROUND_UP(debounce_ms * USEC_PER_MSEC, elapsed_us), DEBOUNCE_COUNTER_MAX);
+}
+
+ZTEST(debounce, test_group_matches_scalar) {
+    rand_state = 0x2a2a2a2a;
+
+    for (int run = 0; run < EQUIVALENCE_RUNS; run++) {
+        const struct zmk_debounce_config config = {
+            .debounce_press_ms = next_rand() % 12,
+            .debounce_release_ms = next_rand() % 12,
+            .algorithm = algorithms[run % ARRAY_SIZE(algorithms)],
+        };
+        const int elapsed_ms = 1 + next_rand() % 4;
+
+        // zmk_debounce_group_update() is the same as zmk_debounce_group_update_us() with whole
+        // milliseconds, so this covers both of them.
+        assert_group_equivalent(&config, elapsed_ms * USEC_PER_MSEC, &config, elapsed_ms, run);
+    }
+}
+
+ZTEST(debounce, test_group_update_ms_matches_us) {
+    struct zmk_debounce_config config = {
+        .debounce_press_ms = 5,
+        .debounce_release_ms = 7,
+    };
+
+    rand_state = 0x5eed5eed;
+
+    ARRAY_FOR_EACH(algorithms, i) {
+        struct zmk_debounce_group group_ms = {0};
+        struct zmk_debounce_group group_us = {0};
+        uint32_t active = 0;
+
+        config.algorithm = algorithms[i];
+
+        for (int step = 0; step < EQUIVALENCE_STEPS; step++) {
+            active = next_active(active);
+
+            zassert_equal(zmk_debounce_group_update(&group_ms, active, 2, &config),
+                          zmk_debounce_group_update_us(&group_us, active, 2 * USEC_PER_MSEC,
+                                                       &config),
+                          "changed differs in step %d", step);
+            zassert_mem_equal(&group_ms, &group_us, sizeof(group_ms),
+                              "state differs in step %d", step);
+        }
+    }
+}
+
+ZTEST(debounce, test_group_update_us_matches_scalar) {
+    static const uint32_t elapsed_us[] = {125, 250, 333, 500, 1500};
+
+    rand_state = 0xdeb0cdeb;
+
+    for (int run = 0; run < EQUIVALENCE_RUNS; run++) {
+        const struct zmk_debounce_config config = {
+            .debounce_press_ms = next_rand() % 8,
+            .debounce_release_ms = next_rand() % 8,
+            .algorithm = algorithms[run % ARRAY_SIZE(algorithms)],
+        };
+        const uint32_t elapsed = elapsed_us[next_rand() % ARRAY_SIZE(elapsed_us)];
+
+        // The group counts updates, so it must behave like the scalar debouncer updated every
+        // millisecond with the debounce times rounded up to a whole number of updates.
+        const struct zmk_debounce_config scalar_config = {
+            .debounce_press_ms = updates_for(config.debounce_press_ms, elapsed),
+            .debounce_release_ms = updates_for(config.debounce_release_ms, elapsed),
+            .algorithm = config.algorithm,
+        };
+
+        assert_group_equivalent(&config, elapsed, &scalar_config, 1, run);
+    }
+}
+
+ZTEST(debounce, test_group_update_us_thresholds) {
+    const struct zmk_debounce_config config = {
+        .debounce_press_ms = 5,
+        .debounce_release_ms = 5,
+        .algorithm = ZMK_DEBOUNCE_ALGORITHM_DEFER,
+    };
+    struct zmk_debounce_group group = {0};
+    int updates = 1;
+
+    // 5 ms at 250 us per scan is 20 scans, and the change latches on the scan after that.
+    while (!zmk_debounce_group_update_us(&group, BIT(0), 250, &config)) {
+        updates++;
+    }
+    zassert_equal(updates, 21);
+
+    // Debounce times longer than the counter can hold are limited to DEBOUNCE_COUNTER_MAX scans.
+    const struct zmk_debounce_config long_config = {
+        .debounce_press_ms = 10000,
+        .debounce_release_ms = 10000,
+        .algorithm = ZMK_DEBOUNCE_ALGORITHM_DEFER,
+    };
+
+    group = (struct zmk_debounce_group){0};
+    updates = 1;
+    while (!zmk_debounce_group_update_us(&group, BIT(0), 250, &long_config)) {
+        updates++;
+    }
+    zassert_equal(updates, DEBOUNCE_COUNTER_MAX + 1);
+}
+
+#define MAX_CHANGES 8
+
+struct switch_changes {
+    int count;
+    int time[MAX_CHANGES];
+    bool pressed[MAX_CHANGES];
+};
+
+typedef bool (*switch_input)(int time);
+
+static void record_change(struct switch_changes *changes, int time, bool pressed) {
+    zassert_true(changes->count < MAX_CHANGES, "too many changes");
+    changes->time[changes->count] = time;
+    changes->pressed[changes->count] = pressed;
+    changes->count++;
+}
+
+// Scans one switch every scan_ms milliseconds for duration_ms, starting at 0.
+static void scan_scalar(const struct zmk_debounce_config *config, switch_input input,
+                        int scan_ms, int duration_ms, struct switch_changes *changes) {
+    struct zmk_debounce_state state = {0};
+
+    *changes = (struct switch_changes){0};
+    for (int time = 0; time < duration_ms; time += scan_ms) {
+        zmk_debounce_update(&state, input(time), scan_ms, config);
+        if (zmk_debounce_get_changed(&state)) {
+            record_change(changes, time, zmk_debounce_is_pressed(&state));
+        }
+    }
+}
+
+static void scan_group(const struct zmk_debounce_config *config, switch_input input,
+                       int scan_ms, int duration_ms, struct switch_changes *changes) {
+    struct zmk_debounce_group group = {0};
+
+    *changes = (struct switch_changes){0};
+    for (int time = 0; time < duration_ms; time += scan_ms) {
+        if (zmk_debounce_group_update(&group, input(time) ? BIT(0) : 0, scan_ms, config)) {
+            record_change(changes, time, zmk_debounce_group_get_pressed(&group) & BIT(0));
+        }
+    }
+}
+
+static void assert_changes(const struct switch_changes *changes, int count, const int time[],
+                           const char *algorithm) {
+    zassert_equal(changes->count, count, "%s reported %d changes", algorithm, changes->count);
+    for (int i = 0; i < count; i++) {
+        zassert_equal(changes->pressed[i], i % 2 == 0, "%s change %d", algorithm, i);
+        zassert_equal(changes->time[i], time[i], "%s change %d", algorithm, i);
+    }
+}
+
+#define PRESS_TIME 10
+#define RELEASE_TIME 100
+#define BOUNCE_MS 3
+
+// A switch whose contacts bounce for BOUNCE_MS when they first touch at PRESS_TIME and when they
+// first separate at RELEASE_TIME.
+static bool bouncing_switch(int time) {
+    if (time < PRESS_TIME) {
+        return false;
+    }
+    if (time < PRESS_TIME + BOUNCE_MS) {
+        return (time - PRESS_TIME) % 2 == 0;
+    }
+    if (time < RELEASE_TIME) {
+        return true;
+    }
+    if (time < RELEASE_TIME + BOUNCE_MS) {
+        return (time - RELEASE_TIME) % 2 == 1;
+    }
+    return false;
+}
+
+ZTEST(debounce, test_documented_bounce_latency) {
+    // The example in docs/docs/features/debouncing.md: default debounce times and scan period,
+    // and a switch that bounces for 3 ms. "defer" reports the press and release 7 ms late,
+    // "eager" reports both on the first scan and "eager-press" only the press.
+    static const struct {
+        const char *name;
+        enum zmk_debounce_algorithm algorithm;
+        int press_latency;
+        int release_latency;
+    } cases[] = {
+        {"defer", ZMK_DEBOUNCE_ALGORITHM_DEFER, 7, 7},
+        {"eager", ZMK_DEBOUNCE_ALGORITHM_EAGER, 0, 0},
+        {"eager-press", ZMK_DEBOUNCE_ALGORITHM_EAGER_PRESS, 0, 7},
+    };
+
+    ARRAY_FOR_EACH(cases, i) {
+        const struct zmk_debounce_config config = {
+            .debounce_press_ms = 5,
+            .debounce_release_ms = 5,
+            .algorithm = cases[i].algorithm,
+        };
+        const int expected[] = {
+            PRESS_TIME + cases[i].press_latency,
+            RELEASE_TIME + cases[i].release_latency,
+        };
+        struct switch_changes changes;
+
+        scan_scalar(&config, bouncing_switch, 1, 200, &changes);
+        assert_changes(&changes, ARRAY_SIZE(expected), expected, cases[i].name);
+
+        scan_group(&config, bouncing_switch, 1, 200, &changes);
+        assert_changes(&changes, ARRAY_SIZE(expected), expected, cases[i].name);
+    }
+}
+
+static bool clean_switch(int time) { return time >= PRESS_TIME && time < RELEASE_TIME; }
+
+ZTEST(debounce, test_documented_scan_period_rounding) {
+    // With a 2 ms scan period and a 5 ms debounce time, presses take 6 ms to register.
+    const struct zmk_debounce_config config = {
+        .debounce_press_ms = 5,
+        .debounce_release_ms = 5,
+        .algorithm = ZMK_DEBOUNCE_ALGORITHM_DEFER,
+    };
+    const int expected[] = {PRESS_TIME + 6, RELEASE_TIME + 6};
+    struct switch_changes changes;
+
+    scan_scalar(&config, clean_switch, 2, 200, &changes);
+    assert_changes(&changes, ARRAY_SIZE(expected), expected, "defer");
+
+    scan_group(&config, clean_switch, 2, 200, &changes);
+    assert_changes(&changes, ARRAY_SIZE(expected), expected, "defer");
+}
+
+static bool noise_spike(int time) { return time == PRESS_TIME; }
+
+ZTEST(debounce, test_noise_spike) {
+    struct zmk_debounce_config config = {
+        .debounce_press_ms = 5,
+        .debounce_release_ms = 5,
+    };
+    struct switch_changes changes;
+
+    // Deferred presses filter out a single bad read.
+    config.algorithm = ZMK_DEBOUNCE_ALGORITHM_DEFER;
+    scan_scalar(&config, noise_spike, 1, 50, &changes);
+    assert_changes(&changes, 0, NULL, "defer");
+
+    // Eager presses report it, and the release follows once the lockout is over.
+    const int expected[] = {PRESS_TIME, PRESS_TIME + 6};
+
+    config.algorithm = ZMK_DEBOUNCE_ALGORITHM_EAGER;
+    scan_scalar(&config, noise_spike, 1, 50, &changes);
+    assert_changes(&changes, ARRAY_SIZE(expected), expected, "eager");
+
+    // The release is deferred, so it takes the lockout plus the release debounce time.
+    const int expected_eager_press[] = {PRESS_TIME, PRESS_TIME + 11};
+
+    config.algorithm = ZMK_DEBOUNCE_ALGORITHM_EAGER_PRESS;
+    scan_scalar(&config, noise_spike, 1, 50, &changes);
+    assert_changes(&changes, ARRAY_SIZE(expected_eager_press), expected_eager_press,
+                   "eager-press");
+}
+
+ZTEST(debounce, test_eager_lockout) {
+    const struct zmk_debounce_config config = {
+        .debounce_press_ms = 3,
+        .debounce_release_ms = 8,
+        .algorithm = ZMK_DEBOUNCE_ALGORITHM_EAGER,
+    };
+    struct zmk_debounce_state state = {0};
+
+    zmk_debounce_update(&state, true, 1, &config);
+    zassert_true(zmk_debounce_get_changed(&state));
+    zassert_true(zmk_debounce_is_pressed(&state));
+
+    // The switch is ignored for debounce-press-ms after a press...
+    for (int time = 1; time <= config.debounce_press_ms; time++) {
+        zmk_debounce_update(&state, false, 1, &config);
+        zassert_false(zmk_debounce_get_changed(&state), "changed at %d ms", time);
+        zassert_true(zmk_debounce_is_active(&state));
+    }
+
+    zmk_debounce_update(&state, false, 1, &config);
+    zassert_true(zmk_debounce_get_changed(&state));
+    zassert_false(zmk_debounce_is_pressed(&state));
+
+    // ...and for debounce-release-ms after a release.
+    for (int time = 1; time <= config.debounce_release_ms; time++) {
+        zmk_debounce_update(&state, true, 1, &config);
+        zassert_false(zmk_debounce_get_changed(&state), "changed at %d ms", time);
+    }
+
+    zmk_debounce_update(&state, true, 1, &config);
+    zassert_true(zmk_debounce_get_changed(&state));
+    zassert_true(zmk_debounce_is_pressed(&state));
+}
+
+// Chatters while held, then stays released.
+static bool chattering_switch(int time) {
+    if (time < PRESS_TIME || time >= RELEASE_TIME) {
+        return false;
+    }
+    return (time - PRESS_TIME) % 3 != 1;
+}
+
+ZTEST(debounce, test_chatter) {
+    struct zmk_debounce_config config = {
+        .debounce_press_ms = 5,
+        .debounce_release_ms = 5,
+    };
+    struct switch_changes changes;
+
+    // Chatter shorter than the debounce time never releases a deferred switch, though it slows
+    // down the press since every bad read counts against it.
+    const int expected_defer[] = {PRESS_TIME + 15, RELEASE_TIME + 5};
+
+    config.algorithm = ZMK_DEBOUNCE_ALGORITHM_DEFER;
+    scan_scalar(&config, chattering_switch, 1, 200, &changes);
+    assert_changes(&changes, ARRAY_SIZE(expected_defer), expected_defer, "defer");
+
+    // Releases are deferred with "eager-press", so chatter can't release the key either.
+    const int expected_eager_press[] = {PRESS_TIME, RELEASE_TIME + 5};
+
+    config.algorithm = ZMK_DEBOUNCE_ALGORITHM_EAGER_PRESS;
+    scan_scalar(&config, chattering_switch, 1, 200, &changes);
+    assert_changes(&changes, ARRAY_SIZE(expected_eager_press), expected_eager_press,
+                   "eager-press");
+}
+
+ZTEST_SUITE(debounce, NULL, NULL, NULL, NULL, NULL);
@@ -0,0 +1,64 @@
+/*
+ * Copyright (c) 2023 The ZMK Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#define DT_DRV_COMPAT zmk_behavior_mouse_scroll
+
+#include <zephyr/device.h>
+#include <drivers/behavior.h>
+#include <zephyr/logging/log.h>
+
+#include <zmk/behavior.h>
+#include <zmk/event_manager.h>
+#include <zmk/events/mouse_scroll_state_changed.h>
+
+LOG_MODULE_DECLARE(zmk, CONFIG_ZMK_LOG_LEVEL);
+
+#if DT_HAS_COMPAT_STATUS_OKAY(DT_DRV_COMPAT)
+
+static int behavior_mouse_scroll_init(const struct device *dev) { return 0; };
+
+static int raise_scroll_state(const struct device *dev, uint32_t param, bool state,
+                              int64_t timestamp) {
+    const struct zmk_mouse_acceleration_config *config = dev->config;
+
+    return raise_zmk_mouse_scroll_state_changed((struct zmk_mouse_scroll_state_changed){
+        .max_speed = {.x = (int16_t)(param >> 16), .y = (int16_t)(param & 0xFFFF)},
+        .config = *config,
+        .state = state,
+        .timestamp = timestamp,
+    });
+}
+
+static int on_keymap_binding_pressed(struct zmk_behavior_binding *binding,
+                                     struct zmk_behavior_binding_event event) {
+    LOG_DBG("position %d speed 0x%08X", event.position, binding->param1);
+    const struct device *dev = zmk_behavior_get_binding(binding->behavior_dev);
+    return raise_scroll_state(dev, binding->param1, true, event.timestamp);
+}
+
+static int on_keymap_binding_released(struct zmk_behavior_binding *binding,
+                                      struct zmk_behavior_binding_event event) {
+    LOG_DBG("position %d speed 0x%08X", event.position, binding->param1);
+    const struct device *dev = zmk_behavior_get_binding(binding->behavior_dev);
+    return raise_scroll_state(dev, binding->param1, false, event.timestamp);
+}
+
+static const struct behavior_driver_api behavior_mouse_scroll_driver_api = {
+    .binding_pressed = on_keymap_binding_pressed, .binding_released = on_keymap_binding_released};
+
+#define MSC_INST(n)                                                                                \
+    static const struct zmk_mouse_acceleration_config behavior_mouse_scroll_config_##n = {         \
+        .delay_ms = DT_INST_PROP(n, delay_ms),                                                     \
+        .time_to_max_speed_ms = DT_INST_PROP(n, time_to_max_speed_ms),                             \
+        .acceleration_exponent = DT_INST_PROP(n, acceleration_exponent),                           \
+    };                                                                                             \
+    BEHAVIOR_DT_INST_DEFINE(n, behavior_mouse_scroll_init, NULL, NULL,                             \
+                            &behavior_mouse_scroll_config_##n, POST_KERNEL,                        \
+                            CONFIG_KERNEL_INIT_PRIORITY_DEFAULT, &behavior_mouse_scroll_driver_api);
+
+DT_INST_FOREACH_STATUS_OKAY(MSC_INST)
+
+#endif /* DT_HAS_COMPAT_STATUS_OKAY(DT_DRV_COMPAT) */
@@ -24,11 +24,16 @@ static int on_keymap_binding_pressed(struct zmk_behavior_binding *binding,
                                      struct zmk_behavior_binding_event event) {
     switch (binding->param1) {
     case OUT_TOG:
+        zmk_endpoints_set_mirror(false);
         return zmk_endpoints_toggle_transport();
     case OUT_USB:
+        zmk_endpoints_set_mirror(false);
         return zmk_endpoints_select_transport(ZMK_TRANSPORT_USB);
     case OUT_BLE:
+        zmk_endpoints_set_mirror(false);
         return zmk_endpoints_select_transport(ZMK_TRANSPORT_BLE);
+    case OUT_MIR:
+        return zmk_endpoints_set_mirror(true);
     default:
         LOG_ERR("Unknown output command: %d", binding->param1);
     }
@@ -29,12 +29,16 @@ LOG_MODULE_DECLARE(zmk, CONFIG_ZMK_LOG_LEVEL);
 static struct zmk_endpoint_instance current_instance = {};
 static enum zmk_transport preferred_transport =
     ZMK_TRANSPORT_USB; /* Used if multiple endpoints are ready */
+static bool mirror_reports = false; /* Send to USB and BLE if both endpoints are ready */
 
 static void update_current_endpoint(void);
+static bool is_usb_ready(void);
+static bool is_ble_ready(void);
 
 #if IS_ENABLED(CONFIG_SETTINGS)
 static void endpoints_save_preferred_work(struct k_work *work) {
     settings_save_one("endpoints/preferred", &preferred_transport, sizeof(preferred_transport));
+    settings_save_one("endpoints/mirror", &mirror_reports, sizeof(mirror_reports));
 }
 
 static struct k_work_delayable endpoints_save_work;
@@ -116,12 +120,34 @@ int zmk_endpoints_toggle_transport(void) {
     return zmk_endpoints_select_transport(new_transport);
 }
 
+int zmk_endpoints_set_mirror(bool mirror) {
+    LOG_DBG("Mirror reports to all endpoints: %d", mirror);
+
+    if (mirror_reports == mirror) {
+        return 0;
+    }
+
+    // Release everything first, so keys held on an endpoint that stops receiving reports don't
+    // stay held there.
+    zmk_endpoints_clear_current();
+
+    mirror_reports = mirror;
+
+    endpoints_save_preferred();
+
+    return 0;
+}
+
+int zmk_endpoints_toggle_mirror(void) { return zmk_endpoints_set_mirror(!mirror_reports); }
+
+bool zmk_endpoints_is_mirroring(void) { return mirror_reports; }
+
 struct zmk_endpoint_instance zmk_endpoints_selected(void) {
     return current_instance;
 }
 
-static int send_keyboard_report(void) {
-    switch (current_instance.transport) {
+static int send_keyboard_report_to(enum zmk_transport transport) {
+    switch (transport) {
     case ZMK_TRANSPORT_USB: {
 #if IS_ENABLED(CONFIG_ZMK_USB)
         int err = zmk_usb_hid_send_keyboard_report();
@@ -150,12 +176,12 @@ static int send_keyboard_report(void) {
     }
     }
 
-    LOG_ERR("Unhandled endpoint transport %d", current_instance.transport);
+    LOG_ERR("Unhandled endpoint transport %d", transport);
     return -ENOTSUP;
 }
 
-static int send_consumer_report(void) {
-    switch (current_instance.transport) {
+static int send_consumer_report_to(enum zmk_transport transport) {
+    switch (transport) {
     case ZMK_TRANSPORT_USB: {
 #if IS_ENABLED(CONFIG_ZMK_USB)
         int err = zmk_usb_hid_send_consumer_report();
@@ -184,19 +210,33 @@ static int send_consumer_report(void) {
     }
     }
 
-    LOG_ERR("Unhandled endpoint transport %d", current_instance.transport);
+    LOG_ERR("Unhandled endpoint transport %d", transport);
     return -ENOTSUP;
 }
 
+static int send_report(int (*send_to)(enum zmk_transport transport)) {
+#if IS_ENABLED(CONFIG_ZMK_USB) && IS_ENABLED(CONFIG_ZMK_BLE)
+    if (mirror_reports && is_usb_ready() && is_ble_ready()) {
+        // USB reports are sent directly while BLE reports are queued for the HOG work queue, so
+        // sending to USB first means a slow BLE link never delays the USB host.
+        int usb_err = send_to(ZMK_TRANSPORT_USB);
+        int ble_err = send_to(ZMK_TRANSPORT_BLE);
+        return usb_err ? usb_err : ble_err;
+    }
+#endif
+
+    return send_to(current_instance.transport);
+}
+
 int zmk_endpoints_send_report(uint16_t usage_page) {
 
     LOG_DBG("usage page 0x%02X", usage_page);
     switch (usage_page) {
     case HID_USAGE_KEY:
-        return send_keyboard_report();
+        return send_report(send_keyboard_report_to);
 
     case HID_USAGE_CONSUMER:
-        return send_consumer_report();
+        return send_report(send_consumer_report_to);
     }
 
     LOG_ERR("Unsupported usage page %d", usage_page);
@@ -204,8 +244,8 @@ int zmk_endpoints_send_report(uint16_t usage_page) {
 }
 
 #if IS_ENABLED(CONFIG_ZMK_MOUSE)
-int zmk_endpoints_send_mouse_report() {
-    switch (current_instance.transport) {
+static int send_mouse_report_to(enum zmk_transport transport) {
+    switch (transport) {
     case ZMK_TRANSPORT_USB: {
 #if IS_ENABLED(CONFIG_ZMK_USB)
         int err = zmk_usb_hid_send_mouse_report();
@@ -234,9 +274,11 @@ int zmk_endpoints_send_mouse_report() {
     }
     }
 
-    LOG_ERR("Unhandled endpoint transport %d", current_instance.transport);
+    LOG_ERR("Unhandled endpoint transport %d", transport);
     return -ENOTSUP;
 }
+
+int zmk_endpoints_send_mouse_report() { return send_report(send_mouse_report_to); }
 #endif // IS_ENABLED(CONFIG_ZMK_MOUSE)
 
 #if IS_ENABLED(CONFIG_SETTINGS)
@@ -258,6 +300,18 @@ static int endpoints_handle_set(const char *name, size_t len, settings_read_cb r
         }
 
         update_current_endpoint();
+    } else if (settings_name_steq(name, "mirror", NULL)) {
+        if (len != sizeof(mirror_reports)) {
+            LOG_ERR("Invalid mirror setting size (got %d expected %d)", len,
+                    sizeof(mirror_reports));
+            return -EINVAL;
+        }
+
+        int err = read_cb(cb_arg, &mirror_reports, sizeof(mirror_reports));
+        if (err <= 0) {
+            LOG_ERR("Failed to read mirror setting from settings (err %d)", err);
+            return err;
+        }
     }
 
     return 0;
@@ -0,0 +1,9 @@
+/*
+ * Copyright (c) 2023 The ZMK Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <zmk/events/mouse_move_state_changed.h>
+
+ZMK_EVENT_IMPL(zmk_mouse_move_state_changed);
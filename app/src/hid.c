@@ -8,6 +8,8 @@
 #include <zephyr/logging/log.h>
 LOG_MODULE_DECLARE(zmk, CONFIG_ZMK_LOG_LEVEL);
 
+#include <string.h>
+
 #include <zmk/hid.h>
 #include <dt-bindings/zmk/modifiers.h>
 
@@ -37,6 +39,19 @@ static struct zmk_hid_mouse_report mouse_report = {.report_id = ZMK_HID_REPORT_I
 static int explicit_modifier_counts[8] = {0, 0, 0, 0, 0, 0, 0, 0};
 static zmk_mod_flags_t explicit_modifiers = 0;
 static zmk_mod_flags_t implicit_modifiers = 0;
+// Implicit modifiers belong to the most recently pressed usage that is still held. Keep the held
+// usages in press order with their implicit modifiers and how often they are held, so releasing
+// one brings back the modifiers of the one pressed before it.
+#define IMPLICIT_MODIFIERS_USAGES_MAX 16
+
+struct implicit_modifiers_usage {
+    uint32_t usage;
+    zmk_mod_flags_t modifiers;
+    uint8_t count;
+};
+
+static struct implicit_modifiers_usage implicit_modifiers_usages[IMPLICIT_MODIFIERS_USAGES_MAX];
+static size_t implicit_modifiers_usages_len = 0;
 static zmk_mod_flags_t masked_modifiers = 0;
 
 #define SET_MODIFIERS(mods)                                                                        \
@@ -79,25 +94,51 @@ bool zmk_hid_mod_is_pressed(zmk_mod_t modifier) {
     return (zmk_hid_get_explicit_mods() & mod_flag) == mod_flag;
 }
 
+// Update the counts of all modifiers first and only recompute the modifier byte once, instead of
+// once per modifier bit.
 int zmk_hid_register_mods(zmk_mod_flags_t modifiers) {
-    int ret = 0;
+    if (modifiers == 0) {
+        return 0;
+    }
     for (zmk_mod_t i = 0; i < 8; i++) {
         if (modifiers & (1 << i)) {
-            ret += zmk_hid_register_mod(i);
+            explicit_modifier_counts[i]++;
+            LOG_DBG("Modifier %d count %d", i, explicit_modifier_counts[i]);
         }
     }
-    return ret;
+    explicit_modifiers |= modifiers;
+    zmk_mod_flags_t current = GET_MODIFIERS;
+    SET_MODIFIERS(explicit_modifiers);
+    return current == GET_MODIFIERS ? 0 : 1;
 }
 
 int zmk_hid_unregister_mods(zmk_mod_flags_t modifiers) {
     int ret = 0;
+    if (modifiers == 0) {
+        return 0;
+    }
     for (zmk_mod_t i = 0; i < 8; i++) {
-        if (modifiers & (1 << i)) {
-            ret += zmk_hid_unregister_mod(i);
+        if (!(modifiers & (1 << i))) {
+            continue;
+        }
+        if (explicit_modifier_counts[i] <= 0) {
+            LOG_ERR("Tried to unregister modifier %d too often", i);
+            ret = -EINVAL;
+            continue;
+        }
+        explicit_modifier_counts[i]--;
+        LOG_DBG("Modifier %d count: %d", i, explicit_modifier_counts[i]);
+        if (explicit_modifier_counts[i] == 0) {
+            LOG_DBG("Modifier %d released", i);
+            WRITE_BIT(explicit_modifiers, i, false);
         }
     }
-
-    return ret;
+    zmk_mod_flags_t current = GET_MODIFIERS;
+    SET_MODIFIERS(explicit_modifiers);
+    if (ret < 0) {
+        return ret;
+    }
+    return current == GET_MODIFIERS ? 0 : 1;
 }
 
 #if IS_ENABLED(CONFIG_ZMK_USB_BOOT)
@@ -110,6 +151,13 @@ static zmk_hid_boot_report_t *boot_report_rollover(uint8_t modifiers) {
     return &boot_report;
 }
 
+// The boot report reports rollover once more keys are held than it has room for, so this count
+// must only change when a usage is actually added to or removed from the report state.
+static inline void boot_report_keys_held_add(int delta) {
+    keys_held += delta;
+    LOG_DBG("Boot report keys held: %d", keys_held);
+}
+
 #endif /* IS_ENABLED(CONFIG_ZMK_USB_BOOT) */
 
 #if IS_ENABLED(CONFIG_ZMK_HID_REPORT_TYPE_NKRO)
@@ -144,13 +192,25 @@ zmk_hid_boot_report_t *zmk_hid_get_boot_report(void) {
 }
 #endif
 
+static inline bool check_keyboard_usage(zmk_key_t usage) {
+    if (usage > ZMK_HID_KEYBOARD_NKRO_MAX_USAGE) {
+        return false;
+    }
+    return keyboard_report.body.keys[usage / 8] & (1 << (usage % 8));
+}
+
 static inline int select_keyboard_usage(zmk_key_t usage) {
     if (usage > ZMK_HID_KEYBOARD_NKRO_MAX_USAGE) {
         return -EINVAL;
     }
+    // The report may have been cleared, e.g. by an endpoint change, while the key was held, so
+    // only count usages whose bit actually changes.
+    if (check_keyboard_usage(usage)) {
+        return 0;
+    }
     TOGGLE_KEYBOARD(usage, 1);
 #if IS_ENABLED(CONFIG_ZMK_USB_BOOT)
-    ++keys_held;
+    boot_report_keys_held_add(1);
 #endif
     return 0;
 }
@@ -159,32 +219,84 @@ static inline int deselect_keyboard_usage(zmk_key_t usage) {
     if (usage > ZMK_HID_KEYBOARD_NKRO_MAX_USAGE) {
         return -EINVAL;
     }
+    if (!check_keyboard_usage(usage)) {
+        return 0;
+    }
     TOGGLE_KEYBOARD(usage, 0);
 #if IS_ENABLED(CONFIG_ZMK_USB_BOOT)
-    --keys_held;
+    boot_report_keys_held_add(-1);
 #endif
     return 0;
 }
 
-static inline bool check_keyboard_usage(zmk_key_t usage) {
-    if (usage > ZMK_HID_KEYBOARD_NKRO_MAX_USAGE) {
-        return false;
-    }
-    return keyboard_report.body.keys[usage / 8] & (1 << (usage % 8));
+static inline void reset_keyboard_usages(void) {
+#if IS_ENABLED(CONFIG_ZMK_USB_BOOT)
+    keys_held = 0;
+#endif
 }
 
 #elif IS_ENABLED(CONFIG_ZMK_HID_REPORT_TYPE_HKRO)
 
-#define TOGGLE_KEYBOARD(match, val)                                                                \
-    for (int idx = 0; idx < CONFIG_ZMK_HID_KEYBOARD_REPORT_SIZE; idx++) {                          \
-        if (keyboard_report.body.keys[idx] != match) {                                             \
-            continue;                                                                              \
-        }                                                                                          \
-        keyboard_report.body.keys[idx] = val;                                                      \
-        if (val) {                                                                                 \
-            break;                                                                                 \
-        }                                                                                          \
+// Index of the held usages, so pressing, releasing and looking up a key does not have to scan the
+// whole report. Usages that are held while every slot is taken are tracked with NO_SLOT and get
+// the next slot that is freed.
+#define MAX_HKRO_USAGE UINT8_MAX
+#define NO_SLOT UINT8_MAX
+
+BUILD_ASSERT(CONFIG_ZMK_HID_KEYBOARD_REPORT_SIZE < NO_SLOT,
+             "The keyboard report size must leave room for the unused slot marker");
+
+static uint32_t held_usages[DIV_ROUND_UP(MAX_HKRO_USAGE + 1, 32)];
+static uint8_t usage_slots[MAX_HKRO_USAGE + 1];
+static uint32_t used_slots[DIV_ROUND_UP(CONFIG_ZMK_HID_KEYBOARD_REPORT_SIZE, 32)];
+static uint8_t overflowed_usages = 0;
+
+static inline bool is_usage_held(zmk_key_t usage) {
+    return held_usages[usage / 32] & BIT(usage % 32);
+}
+
+static inline void reset_keyboard_usages(void) {
+    memset(held_usages, 0, sizeof(held_usages));
+    memset(used_slots, 0, sizeof(used_slots));
+    overflowed_usages = 0;
+#if IS_ENABLED(CONFIG_ZMK_USB_BOOT)
+    keys_held = 0;
+#endif
+}
+
+// Takes the lowest free slot, so the report is filled in the same order as before.
+static inline uint8_t take_free_slot(void) {
+    for (int i = 0; i < ARRAY_SIZE(used_slots); i++) {
+        if (~used_slots[i] == 0) {
+            continue;
+        }
+        const int slot = i * 32 + find_lsb_set(~used_slots[i]) - 1;
+        if (slot >= CONFIG_ZMK_HID_KEYBOARD_REPORT_SIZE) {
+            break;
+        }
+        used_slots[i] |= BIT(slot % 32);
+        return slot;
     }
+    return NO_SLOT;
+}
+
+// Hands a freed slot to a usage that is held without one.
+static inline bool give_slot_to_overflowed_usage(uint8_t slot) {
+    for (int i = 0; i < ARRAY_SIZE(held_usages); i++) {
+        uint32_t held = held_usages[i];
+        while (held) {
+            const zmk_key_t usage = i * 32 + find_lsb_set(held) - 1;
+            held &= held - 1;
+            if (usage_slots[usage] == NO_SLOT) {
+                usage_slots[usage] = slot;
+                keyboard_report.body.keys[slot] = usage;
+                overflowed_usages--;
+                return true;
+            }
+        }
+    }
+    return false;
+}
 
 #if IS_ENABLED(CONFIG_ZMK_USB_BOOT)
 zmk_hid_boot_report_t *zmk_hid_get_boot_report(void) {
@@ -220,28 +332,51 @@ zmk_hid_boot_report_t *zmk_hid_get_boot_report(void) {
 #endif /* IS_ENABLED(CONFIG_ZMK_USB_BOOT) */
 
 static inline int select_keyboard_usage(zmk_key_t usage) {
-    TOGGLE_KEYBOARD(0U, usage);
+    if (usage > MAX_HKRO_USAGE) {
+        return -EINVAL;
+    }
+    if (is_usage_held(usage)) {
+        return 0;
+    }
+    held_usages[usage / 32] |= BIT(usage % 32);
+    usage_slots[usage] = take_free_slot();
+    if (usage_slots[usage] != NO_SLOT) {
+        keyboard_report.body.keys[usage_slots[usage]] = usage;
+    } else {
+        overflowed_usages++;
+    }
 #if IS_ENABLED(CONFIG_ZMK_USB_BOOT)
-    ++keys_held;
+    boot_report_keys_held_add(1);
 #endif
     return 0;
 }
 
 static inline int deselect_keyboard_usage(zmk_key_t usage) {
-    TOGGLE_KEYBOARD(usage, 0U);
+    if (usage > MAX_HKRO_USAGE) {
+        return -EINVAL;
+    }
+    if (!is_usage_held(usage)) {
+        return 0;
+    }
+    held_usages[usage / 32] &= ~BIT(usage % 32);
+    const uint8_t slot = usage_slots[usage];
+    if (slot == NO_SLOT) {
+        overflowed_usages--;
+    } else if (overflowed_usages == 0 || !give_slot_to_overflowed_usage(slot)) {
+        keyboard_report.body.keys[slot] = 0U;
+        used_slots[slot / 32] &= ~BIT(slot % 32);
+    }
 #if IS_ENABLED(CONFIG_ZMK_USB_BOOT)
-    --keys_held;
+    boot_report_keys_held_add(-1);
 #endif
     return 0;
 }
 
-static inline int check_keyboard_usage(zmk_key_t usage) {
-    for (int idx = 0; idx < CONFIG_ZMK_HID_KEYBOARD_REPORT_SIZE; idx++) {
-        if (keyboard_report.body.keys[idx] == usage) {
-            return true;
-        }
+static inline bool check_keyboard_usage(zmk_key_t usage) {
+    if (usage > MAX_HKRO_USAGE) {
+        return false;
     }
-    return false;
+    return is_usage_held(usage) && usage_slots[usage] != NO_SLOT;
 }
 
 #else
@@ -261,15 +396,51 @@ static inline int check_keyboard_usage(zmk_key_t usage) {
         }                                                                                          \
     }
 
-int zmk_hid_implicit_modifiers_press(zmk_mod_flags_t new_implicit_modifiers) {
-    implicit_modifiers = new_implicit_modifiers;
+static void implicit_modifiers_usage_remove(size_t index) {
+    implicit_modifiers_usages_len--;
+    memmove(&implicit_modifiers_usages[index], &implicit_modifiers_usages[index + 1],
+            (implicit_modifiers_usages_len - index) * sizeof(implicit_modifiers_usages[0]));
+}
+
+static void implicit_modifiers_update(void) {
+    implicit_modifiers =
+        implicit_modifiers_usages_len > 0
+            ? implicit_modifiers_usages[implicit_modifiers_usages_len - 1].modifiers
+            : 0;
+}
+
+int zmk_hid_implicit_modifiers_press(uint32_t usage, zmk_mod_flags_t new_implicit_modifiers) {
+    uint8_t count = 0;
+    for (size_t i = 0; i < implicit_modifiers_usages_len; i++) {
+        if (implicit_modifiers_usages[i].usage == usage) {
+            count = implicit_modifiers_usages[i].count;
+            implicit_modifiers_usage_remove(i);
+            break;
+        }
+    }
+    if (implicit_modifiers_usages_len == IMPLICIT_MODIFIERS_USAGES_MAX) {
+        // Forget the oldest usage, its modifiers would be the last ones to be restored.
+        implicit_modifiers_usage_remove(0);
+    }
+    implicit_modifiers_usages[implicit_modifiers_usages_len++] =
+        (struct implicit_modifiers_usage){
+            .usage = usage, .modifiers = new_implicit_modifiers, .count = count + 1};
+    implicit_modifiers_update();
     zmk_mod_flags_t current = GET_MODIFIERS;
     SET_MODIFIERS(explicit_modifiers);
     return current == GET_MODIFIERS ? 0 : 1;
 }
 
-int zmk_hid_implicit_modifiers_release(void) {
-    implicit_modifiers = 0;
+int zmk_hid_implicit_modifiers_release(uint32_t usage) {
+    for (size_t i = implicit_modifiers_usages_len; i > 0; i--) {
+        if (implicit_modifiers_usages[i - 1].usage == usage) {
+            if (--implicit_modifiers_usages[i - 1].count == 0) {
+                implicit_modifiers_usage_remove(i - 1);
+            }
+            break;
+        }
+    }
+    implicit_modifiers_update();
     zmk_mod_flags_t current = GET_MODIFIERS;
     SET_MODIFIERS(explicit_modifiers);
     return current == GET_MODIFIERS ? 0 : 1;
@@ -314,6 +485,7 @@ bool zmk_hid_keyboard_is_pressed(zmk_key_t code) {
 
 void zmk_hid_keyboard_clear(void) {
     memset(&keyboard_report.body, 0, sizeof(keyboard_report.body));
+    reset_keyboard_usages();
 }
 
 int zmk_hid_consumer_press(zmk_key_t code) {
@@ -430,6 +602,20 @@ int zmk_hid_mouse_buttons_release(zmk_mouse_button_flags_t buttons) {
     }
     return 0;
 }
+
+void zmk_hid_mouse_movement_set(int16_t d_x, int16_t d_y) {
+    mouse_report.body.d_x = d_x;
+    mouse_report.body.d_y = d_y;
+    LOG_DBG("Mouse movement set to %d/%d", mouse_report.body.d_x, mouse_report.body.d_y);
+}
+
+void zmk_hid_mouse_scroll_set(int16_t d_scroll_x, int16_t d_scroll_y) {
+    mouse_report.body.d_scroll_x = d_scroll_x;
+    mouse_report.body.d_scroll_y = d_scroll_y;
+    LOG_DBG("Mouse scroll set to %d/%d", mouse_report.body.d_scroll_x,
+            mouse_report.body.d_scroll_y);
+}
+
 void zmk_hid_mouse_clear(void) { memset(&mouse_report.body, 0, sizeof(mouse_report.body)); }
 
 #endif // IS_ENABLED(CONFIG_ZMK_MOUSE)
@@ -21,6 +21,9 @@ LOG_MODULE_DECLARE(zmk, CONFIG_ZMK_LOG_LEVEL);
 #if IS_ENABLED(CONFIG_ZMK_HID_INDICATORS)
 #include <zmk/hid_indicators.h>
 #endif // IS_ENABLED(CONFIG_ZMK_HID_INDICATORS)
+#if IS_ENABLED(CONFIG_ZMK_MOUSE)
+#include <zmk/mouse.h>
+#endif // IS_ENABLED(CONFIG_ZMK_MOUSE)
 
 enum {
     HIDS_REMOTE_WAKE = BIT(0),
@@ -76,6 +79,15 @@ static struct hids_report mouse_input = {
     .type = HIDS_INPUT,
 };
 
+#if IS_ENABLED(CONFIG_ZMK_MOUSE_SMOOTH_SCROLLING)
+
+static struct hids_report mouse_resolution_feature = {
+    .id = ZMK_HID_REPORT_ID_MOUSE,
+    .type = HIDS_FEATURE,
+};
+
+#endif // IS_ENABLED(CONFIG_ZMK_MOUSE_SMOOTH_SCROLLING)
+
 #endif // IS_ENABLED(CONFIG_ZMK_MOUSE)
 
 static bool host_requests_notification = false;
@@ -150,6 +162,62 @@ static ssize_t read_hids_mouse_input_report(struct bt_conn *conn, const struct b
     return bt_gatt_attr_read(conn, attr, buf, len, offset, report_body,
                              sizeof(struct zmk_hid_mouse_report_body));
 }
+
+#if IS_ENABLED(CONFIG_ZMK_MOUSE_SMOOTH_SCROLLING)
+static int conn_endpoint(struct bt_conn *conn, struct zmk_endpoint_instance *endpoint) {
+    int profile = zmk_ble_profile_index(bt_conn_get_dst(conn));
+    if (profile < 0) {
+        return profile;
+    }
+
+    *endpoint = (struct zmk_endpoint_instance){.transport = ZMK_TRANSPORT_BLE,
+                                               .ble = {
+                                                   .profile_index = profile,
+                                               }};
+    return 0;
+}
+
+static ssize_t read_hids_mouse_resolution_feature_report(struct bt_conn *conn,
+                                                         const struct bt_gatt_attr *attr,
+                                                         void *buf, uint16_t len,
+                                                         uint16_t offset) {
+    struct zmk_endpoint_instance endpoint;
+    if (conn_endpoint(conn, &endpoint) < 0) {
+        return BT_GATT_ERR(BT_ATT_ERR_UNLIKELY);
+    }
+
+    struct zmk_mouse_resolution_multipliers multipliers =
+        zmk_mouse_resolution_multipliers_get_profile(endpoint);
+    struct zmk_hid_mouse_resolution_feature_report_body report_body = {
+        .wheel_res = multipliers.wheel,
+        .hwheel_res = multipliers.hor_wheel,
+    };
+    return bt_gatt_attr_read(conn, attr, buf, len, offset, &report_body,
+                             sizeof(struct zmk_hid_mouse_resolution_feature_report_body));
+}
+
+static ssize_t write_hids_mouse_resolution_feature_report(struct bt_conn *conn,
+                                                          const struct bt_gatt_attr *attr,
+                                                          const void *buf, uint16_t len,
+                                                          uint16_t offset, uint8_t flags) {
+    if (offset != 0) {
+        return BT_GATT_ERR(BT_ATT_ERR_INVALID_OFFSET);
+    }
+    if (len != sizeof(struct zmk_hid_mouse_resolution_feature_report_body)) {
+        return BT_GATT_ERR(BT_ATT_ERR_INVALID_ATTRIBUTE_LEN);
+    }
+
+    struct zmk_endpoint_instance endpoint;
+    if (conn_endpoint(conn, &endpoint) < 0) {
+        return BT_GATT_ERR(BT_ATT_ERR_UNLIKELY);
+    }
+
+    zmk_mouse_resolution_multipliers_process_report(
+        (const struct zmk_hid_mouse_resolution_feature_report_body *)buf, endpoint);
+
+    return len;
+}
+#endif // IS_ENABLED(CONFIG_ZMK_MOUSE_SMOOTH_SCROLLING)
 #endif // IS_ENABLED(CONFIG_ZMK_MOUSE)
 
 // static ssize_t write_proto_mode(struct bt_conn *conn,
@@ -206,6 +274,15 @@ BT_GATT_SERVICE_DEFINE(
     BT_GATT_CCC(input_ccc_changed, BT_GATT_PERM_READ_ENCRYPT | BT_GATT_PERM_WRITE_ENCRYPT),
     BT_GATT_DESCRIPTOR(BT_UUID_HIDS_REPORT_REF, BT_GATT_PERM_READ_ENCRYPT, read_hids_report_ref,
                        NULL, &mouse_input),
+
+#if IS_ENABLED(CONFIG_ZMK_MOUSE_SMOOTH_SCROLLING)
+    BT_GATT_CHARACTERISTIC(BT_UUID_HIDS_REPORT, BT_GATT_CHRC_READ | BT_GATT_CHRC_WRITE,
+                           BT_GATT_PERM_READ_ENCRYPT | BT_GATT_PERM_WRITE_ENCRYPT,
+                           read_hids_mouse_resolution_feature_report,
+                           write_hids_mouse_resolution_feature_report, NULL),
+    BT_GATT_DESCRIPTOR(BT_UUID_HIDS_REPORT_REF, BT_GATT_PERM_READ_ENCRYPT, read_hids_report_ref,
+                       NULL, &mouse_resolution_feature),
+#endif // IS_ENABLED(CONFIG_ZMK_MOUSE_SMOOTH_SCROLLING)
 #endif // IS_ENABLED(CONFIG_ZMK_MOUSE)
 
 #if IS_ENABLED(CONFIG_ZMK_HID_INDICATORS)
@@ -0,0 +1,172 @@
+/*
+ * Copyright (c) 2023 The ZMK Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <stdlib.h>
+#include <zephyr/kernel.h>
+#include <zephyr/sys/atomic.h>
+#include <zephyr/logging/log.h>
+
+LOG_MODULE_DECLARE(zmk, CONFIG_ZMK_LOG_LEVEL);
+
+#include <zmk/input_stats.h>
+#include <zmk/workqueue.h>
+
+#if IS_ENABLED(CONFIG_SHELL)
+#include <zephyr/shell/shell.h>
+#endif // IS_ENABLED(CONFIG_SHELL)
+
+static atomic_t events;
+static atomic_t max_latency_us;
+
+void zmk_input_stats_record(int64_t read_ticks) {
+    const uint32_t latency_us = k_ticks_to_us_ceil32(k_uptime_ticks() - read_ticks);
+
+    atomic_inc(&events);
+
+    atomic_val_t max = atomic_get(&max_latency_us);
+    while ((atomic_val_t)latency_us > max && !atomic_cas(&max_latency_us, max, latency_us)) {
+        max = atomic_get(&max_latency_us);
+    }
+}
+
+int zmk_input_stats_get(struct zmk_input_stats *stats) {
+    struct k_thread *thread = &zmk_workqueue_input_work_q()->thread;
+    size_t unused;
+
+    int err = k_thread_stack_space_get(thread, &unused);
+    if (err) {
+        return err;
+    }
+
+    stats->events = atomic_get(&events);
+    stats->max_latency_us = atomic_get(&max_latency_us);
+    stats->stack_size = thread->stack_info.size;
+    stats->stack_used = stats->stack_size - unused;
+
+    return 0;
+}
+
+void zmk_input_stats_reset(void) {
+    atomic_clear(&events);
+    atomic_clear(&max_latency_us);
+}
+
+#if IS_ENABLED(CONFIG_SHELL)
+
+static int cmd_input_stats(const struct shell *sh, size_t argc, char **argv) {
+    struct zmk_input_stats stats;
+
+    int err = zmk_input_stats_get(&stats);
+    if (err) {
+        shell_error(sh, "Failed to get input stats (%d)", err);
+        return err;
+    }
+
+    shell_print(sh, "Input work queue: %s",
+                IS_ENABLED(CONFIG_ZMK_INPUT_WORK_QUEUE) ? "dedicated" : "system");
+    shell_print(sh, "  key changes: %u, worst latency: %u us", stats.events, stats.max_latency_us);
+    shell_print(sh, "  stack used: %zu of %zu bytes", stats.stack_used, stats.stack_size);
+
+    return 0;
+}
+
+static int cmd_input_stats_reset(const struct shell *sh, size_t argc, char **argv) {
+    zmk_input_stats_reset();
+    return 0;
+}
+
+// The benchmark keeps the system work queue busy the way a display refresh or flash write does,
+// running in short bursts and yielding while it waits on the hardware, and measures how long a
+// work item submitted to the input work queue part way through waits to run.
+
+#define BENCH_SLICE_US 1000
+
+static uint32_t bench_busy_ms;
+static int64_t bench_submit_ticks;
+static uint32_t bench_latency_us;
+static K_SEM_DEFINE(bench_done, 0, 1);
+
+static void bench_load_work_handler(struct k_work *work) {
+    for (uint32_t i = 0; i < bench_busy_ms * USEC_PER_MSEC / BENCH_SLICE_US; i++) {
+        k_busy_wait(BENCH_SLICE_US);
+        k_yield();
+    }
+}
+
+static K_WORK_DEFINE(bench_load_work, bench_load_work_handler);
+
+static void bench_probe_work_handler(struct k_work *work) {
+    bench_latency_us = k_ticks_to_us_ceil32(k_uptime_ticks() - bench_submit_ticks);
+    k_sem_give(&bench_done);
+}
+
+static K_WORK_DEFINE(bench_probe_work, bench_probe_work_handler);
+
+static void bench_timer_handler(struct k_timer *timer) {
+    bench_submit_ticks = k_uptime_ticks();
+    k_work_submit_to_queue(zmk_workqueue_input_work_q(), &bench_probe_work);
+}
+
+static K_TIMER_DEFINE(bench_timer, bench_timer_handler, NULL);
+
+static int cmd_input_bench(const struct shell *sh, size_t argc, char **argv) {
+    const uint32_t busy_ms = argc > 1 ? strtoul(argv[1], NULL, 10) : 20;
+    const uint32_t samples = argc > 2 ? strtoul(argv[2], NULL, 10) : 20;
+
+    if (busy_ms < 2 || samples == 0) {
+        shell_error(sh, "Usage: kscan bench [busy ms >= 2] [samples > 0]");
+        return -EINVAL;
+    }
+
+    uint32_t worst_us = 0;
+    uint64_t total_us = 0;
+
+    bench_busy_ms = busy_ms;
+
+    for (uint32_t i = 0; i < samples; i++) {
+        k_sem_reset(&bench_done);
+
+        // Submit the probe half way through the busy period.
+        k_timer_start(&bench_timer, K_MSEC(busy_ms / 2), K_NO_WAIT);
+        k_work_submit(&bench_load_work);
+
+        if (k_sem_take(&bench_done, K_MSEC(busy_ms * 2 + 100)) != 0) {
+            shell_error(sh, "Timed out waiting for the input work queue");
+            return -ETIMEDOUT;
+        }
+
+        worst_us = MAX(worst_us, bench_latency_us);
+        total_us += bench_latency_us;
+
+        // Let the load finish before the next sample.
+        k_msleep(busy_ms);
+    }
+
+    shell_print(sh, "Input work queue: %s",
+                IS_ENABLED(CONFIG_ZMK_INPUT_WORK_QUEUE) ? "dedicated" : "system");
+    shell_print(sh, "  %u ms of system work queue load, %u samples", busy_ms, samples);
+    shell_print(sh, "  input work waited: worst %u us, average %u us", worst_us,
+                (uint32_t)(total_us / samples));
+
+    return 0;
+}
+
+SHELL_STATIC_SUBCMD_SET_CREATE(sub_kscan_stats,
+                               SHELL_CMD(reset, NULL, "Reset the counters", cmd_input_stats_reset),
+                               SHELL_SUBCMD_SET_END);
+
+SHELL_STATIC_SUBCMD_SET_CREATE(
+    sub_kscan,
+    SHELL_CMD(stats, &sub_kscan_stats, "Show key input latency and stack usage", cmd_input_stats),
+    SHELL_CMD_ARG(bench, NULL,
+                  "Measure input work latency while the system work queue is busy\n"
+                  "Usage: kscan bench [busy ms] [samples]",
+                  cmd_input_bench, 1, 2),
+    SHELL_SUBCMD_SET_END);
+
+SHELL_CMD_REGISTER(kscan, &sub_kscan, "Key input commands", NULL);
+
+#endif // IS_ENABLED(CONFIG_SHELL)
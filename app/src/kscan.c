@@ -9,60 +9,113 @@
 #include <zephyr/pm/device.h>
 #include <zephyr/bluetooth/addr.h>
 #include <zephyr/drivers/kscan.h>
+#include <zephyr/spinlock.h>
 #include <zephyr/logging/log.h>
 
 LOG_MODULE_DECLARE(zmk, CONFIG_ZMK_LOG_LEVEL);
 
+#include <drivers/kscan_batch.h>
+
 #include <zmk/matrix_transform.h>
 #include <zmk/event_manager.h>
 #include <zmk/events/position_state_changed.h>
-
-#define ZMK_KSCAN_EVENT_STATE_PRESSED 0
-#define ZMK_KSCAN_EVENT_STATE_RELEASED 1
+#include <zmk/input_stats.h>
+#include <zmk/workqueue.h>
 
 struct zmk_kscan_event {
-    uint32_t row;
-    uint32_t column;
-    uint32_t state;
+    int64_t timestamp_ticks;
+    struct zmk_kscan_change change;
 };
 
 struct zmk_kscan_msg_processor {
     struct k_work work;
 } msg_processor;
 
-K_MSGQ_DEFINE(zmk_kscan_msgq, sizeof(struct zmk_kscan_event), CONFIG_ZMK_KSCAN_EVENT_QUEUE_SIZE, 4);
+// Changes waiting to be raised as position events, as a ring buffer. This is used instead of a
+// message queue so a whole batch from a driver is queued with one lock and one work submission.
+static struct zmk_kscan_event kscan_queue[CONFIG_ZMK_KSCAN_EVENT_QUEUE_SIZE];
+static size_t kscan_queue_head;
+static size_t kscan_queue_len;
+static struct k_spinlock kscan_queue_lock;
+
+static void zmk_kscan_batch_callback(const struct device *dev,
+                                     const struct zmk_kscan_batch *batch) {
+    size_t queued = 0;
+
+    k_spinlock_key_t key = k_spin_lock(&kscan_queue_lock);
+
+    for (; queued < batch->len && kscan_queue_len < ARRAY_SIZE(kscan_queue); queued++) {
+        const size_t index = (kscan_queue_head + kscan_queue_len) % ARRAY_SIZE(kscan_queue);
+
+        kscan_queue[index] = (struct zmk_kscan_event){.timestamp_ticks = batch->timestamp_ticks,
+                                                      .change = batch->changes[queued]};
+        kscan_queue_len++;
+    }
+
+    k_spin_unlock(&kscan_queue_lock, key);
+
+    if (queued < batch->len) {
+        LOG_WRN("KScan event queue full, dropped %zu events", batch->len - queued);
+    }
+
+    k_work_submit_to_queue(zmk_workqueue_input_work_q(), &msg_processor.work);
+}
 
 static void zmk_kscan_callback(const struct device *dev, uint32_t row, uint32_t column,
                                bool pressed) {
-    struct zmk_kscan_event ev = {
-        .row = row,
-        .column = column,
-        .state = (pressed ? ZMK_KSCAN_EVENT_STATE_PRESSED : ZMK_KSCAN_EVENT_STATE_RELEASED)};
+    const struct zmk_kscan_change change = {.row = row, .column = column, .pressed = pressed};
+
+    // The driver calls this as soon as it reads the key, so this is the time the key was read.
+    const struct zmk_kscan_batch batch = {
+        .timestamp_ticks = k_uptime_ticks(), .len = 1, .changes = &change};
+
+    zmk_kscan_batch_callback(dev, &batch);
+}
+
+static bool zmk_kscan_queue_get(struct zmk_kscan_event *ev) {
+    bool found = false;
 
-    k_msgq_put(&zmk_kscan_msgq, &ev, K_NO_WAIT);
-    k_work_submit(&msg_processor.work);
+    k_spinlock_key_t key = k_spin_lock(&kscan_queue_lock);
+
+    if (kscan_queue_len > 0) {
+        *ev = kscan_queue[kscan_queue_head];
+        kscan_queue_head = (kscan_queue_head + 1) % ARRAY_SIZE(kscan_queue);
+        kscan_queue_len--;
+        found = true;
+    }
+
+    k_spin_unlock(&kscan_queue_lock, key);
+
+    return found;
 }
 
 void zmk_kscan_process_msgq(struct k_work *item) {
     struct zmk_kscan_event ev;
 
-    while (k_msgq_get(&zmk_kscan_msgq, &ev, K_NO_WAIT) == 0) {
-        bool pressed = (ev.state == ZMK_KSCAN_EVENT_STATE_PRESSED);
-        int32_t position = zmk_matrix_transform_row_column_to_position(ev.row, ev.column);
+    while (zmk_kscan_queue_get(&ev)) {
+        const bool pressed = ev.change.pressed;
+        int32_t position =
+            zmk_matrix_transform_row_column_to_position(ev.change.row, ev.change.column);
 
         if (position < 0) {
-            LOG_WRN("Not found in transform: row: %d, col: %d, pressed: %s", ev.row, ev.column,
-                    (pressed ? "true" : "false"));
+            LOG_WRN("Not found in transform: row: %d, col: %d, pressed: %s", ev.change.row,
+                    ev.change.column, (pressed ? "true" : "false"));
             continue;
         }
 
-        LOG_DBG("Row: %d, col: %d, position: %d, pressed: %s", ev.row, ev.column, position,
-                (pressed ? "true" : "false"));
-        raise_zmk_position_state_changed(
-            (struct zmk_position_state_changed){.source = ZMK_POSITION_STATE_CHANGE_SOURCE_LOCAL,
-                                                .state = pressed,
-                                                .position = position,
-                                                .timestamp = k_uptime_get()});
+        LOG_DBG("Row: %d, col: %d, position: %d, pressed: %s", ev.change.row, ev.change.column,
+                position, (pressed ? "true" : "false"));
+        raise_zmk_position_state_changed((struct zmk_position_state_changed){
+            .source = ZMK_POSITION_STATE_CHANGE_SOURCE_LOCAL,
+            .state = pressed,
+            .position = position,
+            .timestamp = k_ticks_to_ms_floor64(ev.timestamp_ticks),
+#if IS_ENABLED(CONFIG_ZMK_POSITION_TIMESTAMP_TICKS)
+            .timestamp_ticks = ev.timestamp_ticks,
+#endif
+        });
+
+        zmk_input_stats_record(ev.timestamp_ticks);
     }
 }
 
@@ -80,7 +133,12 @@ int zmk_kscan_init(const struct device *dev) {
     }
 #endif // IS_ENABLED(CONFIG_PM_DEVICE)
 
-    kscan_config(dev, zmk_kscan_callback);
+    // Drivers that support it report each scan as a single batch.
+    if (zmk_kscan_batch_is_supported(dev)) {
+        zmk_kscan_batch_config(dev, zmk_kscan_batch_callback);
+    } else {
+        kscan_config(dev, zmk_kscan_callback);
+    }
     kscan_enable_callback(dev);
 
     return 0;
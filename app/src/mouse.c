@@ -5,14 +5,240 @@
  */
 
 #include <drivers/behavior.h>
+#include <zephyr/kernel.h>
+#include <zephyr/sys/atomic.h>
 #include <zephyr/logging/log.h>
 
 LOG_MODULE_DECLARE(zmk, CONFIG_ZMK_LOG_LEVEL);
 
 #include <zmk/events/mouse_button_state_changed.h>
+#include <zmk/events/mouse_move_state_changed.h>
+#include <zmk/events/mouse_scroll_state_changed.h>
 #include <zmk/hid.h>
 #include <zmk/endpoints.h>
 #include <zmk/mouse.h>
+#include <zmk/workqueue.h>
+
+// Motion is accumulated in thousandths of a report unit, so slow key speeds and fractional
+// sensor input still add up to whole pixels and detents over several report intervals.
+#define MOTION_SCALE 1000
+
+#define ACCELERATION_SCALE_ONE BIT(16)
+
+struct mouse_key_motion {
+    // Report units per unit of key speed: pixels for movement, high resolution steps for scroll.
+    const int32_t units;
+    int32_t speed_x;
+    int32_t speed_y;
+    struct zmk_mouse_acceleration_config config;
+    int64_t start_time;
+    int64_t last_update;
+    uint8_t active_keys;
+};
+
+struct mouse_accumulator {
+    atomic_t x;
+    atomic_t y;
+};
+
+static struct mouse_key_motion move_keys = {.units = 1};
+static struct mouse_key_motion scroll_keys = {.units = ZMK_MOUSE_SCROLL_UNITS_PER_DETENT};
+
+static struct mouse_accumulator movement;
+static struct mouse_accumulator scroll;
+
+static int64_t last_tick_time;
+
+#if IS_ENABLED(CONFIG_ZMK_MOUSE_SMOOTH_SCROLLING)
+
+static struct zmk_mouse_resolution_multipliers resolution_multipliers[ZMK_ENDPOINT_COUNT];
+
+struct zmk_mouse_resolution_multipliers zmk_mouse_resolution_multipliers_get_current_profile(void) {
+    return zmk_mouse_resolution_multipliers_get_profile(zmk_endpoints_selected());
+}
+
+struct zmk_mouse_resolution_multipliers
+zmk_mouse_resolution_multipliers_get_profile(struct zmk_endpoint_instance endpoint) {
+    const int profile = zmk_endpoint_instance_to_index(endpoint);
+    return resolution_multipliers[profile];
+}
+
+void zmk_mouse_resolution_multipliers_process_report(
+    const struct zmk_hid_mouse_resolution_feature_report_body *report,
+    struct zmk_endpoint_instance endpoint) {
+    const int profile = zmk_endpoint_instance_to_index(endpoint);
+
+    // Like the HID indicators, this is written from the transport's context. Each field is a
+    // single byte, so readers on the system work queue always see a consistent value.
+    resolution_multipliers[profile].wheel = report->wheel_res;
+    resolution_multipliers[profile].hor_wheel = report->hwheel_res;
+
+    LOG_DBG("Update resolution multipliers: endpoint=%d, wheel=%d, hor_wheel=%d",
+            endpoint.transport, report->wheel_res, report->hwheel_res);
+}
+
+#endif // IS_ENABLED(CONFIG_ZMK_MOUSE_SMOOTH_SCROLLING)
+
+static int32_t report_interval_ms(void) {
+    switch (zmk_endpoints_selected().transport) {
+    case ZMK_TRANSPORT_BLE:
+        return CONFIG_ZMK_MOUSE_BLE_REPORT_INTERVAL_MS;
+    case ZMK_TRANSPORT_USB:
+    default:
+        return CONFIG_ZMK_MOUSE_USB_REPORT_INTERVAL_MS;
+    }
+}
+
+// Returns the fraction of the maximum speed reached after holding the keys for a while, scaled
+// so ACCELERATION_SCALE_ONE is full speed.
+static uint32_t key_motion_acceleration(const struct mouse_key_motion *motion, int64_t now) {
+    const struct zmk_mouse_acceleration_config *config = &motion->config;
+    const int64_t held = now - motion->start_time - config->delay_ms;
+
+    if (held < 0) {
+        return 0;
+    }
+
+    if (config->time_to_max_speed_ms == 0 || held >= config->time_to_max_speed_ms) {
+        return ACCELERATION_SCALE_ONE;
+    }
+
+    const uint64_t ratio = (held * ACCELERATION_SCALE_ONE) / config->time_to_max_speed_ms;
+    uint64_t scale = ACCELERATION_SCALE_ONE;
+    for (int i = 0; i < config->acceleration_exponent; i++) {
+        scale = (scale * ratio) / ACCELERATION_SCALE_ONE;
+    }
+
+    return (uint32_t)scale;
+}
+
+static void key_motion_integrate(struct mouse_key_motion *motion, struct mouse_accumulator *acc,
+                                 int64_t now) {
+    const int64_t elapsed = now - motion->last_update;
+    motion->last_update = now;
+
+    if (motion->active_keys == 0 || elapsed <= 0) {
+        return;
+    }
+
+    // Key speeds are in units per second, so speed * elapsed ms lands directly in MOTION_SCALE.
+    const int64_t scale = key_motion_acceleration(motion, now);
+    const int64_t distance = motion->units * elapsed * scale / ACCELERATION_SCALE_ONE;
+
+    atomic_add(&acc->x, (atomic_val_t)(motion->speed_x * distance));
+    atomic_add(&acc->y, (atomic_val_t)(motion->speed_y * distance));
+}
+
+static int16_t take_whole_units(atomic_t *acc, int32_t divisor) {
+    const int32_t units = CLAMP(atomic_get(acc) / divisor, -INT16_MAX, INT16_MAX);
+    atomic_sub(acc, units * divisor);
+    return units;
+}
+
+static int32_t scroll_divisor(bool high_resolution) {
+    return high_resolution ? MOTION_SCALE : MOTION_SCALE * ZMK_MOUSE_SCROLL_UNITS_PER_DETENT;
+}
+
+static bool has_whole_units(atomic_t *acc, int32_t divisor) {
+    return atomic_get(acc) / divisor != 0;
+}
+
+static void mouse_tick_work_cb(struct k_work *work);
+
+static K_WORK_DELAYABLE_DEFINE(mouse_tick_work, mouse_tick_work_cb);
+
+static void schedule_tick(void) {
+    const int64_t delay = last_tick_time + report_interval_ms() - k_uptime_get();
+
+    // Does nothing if a tick is already pending, so bursts of sensor input are coalesced into a
+    // single report per interval.
+    k_work_schedule_for_queue(zmk_workqueue_input_work_q(), &mouse_tick_work,
+                              K_MSEC(MAX(delay, 0)));
+}
+
+static void mouse_tick_work_cb(struct k_work *work) {
+    const int64_t now = k_uptime_get();
+    last_tick_time = now;
+
+    key_motion_integrate(&move_keys, &movement, now);
+    key_motion_integrate(&scroll_keys, &scroll, now);
+
+    bool hi_res_y = false, hi_res_x = false;
+#if IS_ENABLED(CONFIG_ZMK_MOUSE_SMOOTH_SCROLLING)
+    const struct zmk_mouse_resolution_multipliers multipliers =
+        zmk_mouse_resolution_multipliers_get_current_profile();
+    hi_res_y = multipliers.wheel != 0;
+    hi_res_x = multipliers.hor_wheel != 0;
+#endif // IS_ENABLED(CONFIG_ZMK_MOUSE_SMOOTH_SCROLLING)
+
+    const int16_t d_x = take_whole_units(&movement.x, MOTION_SCALE);
+    const int16_t d_y = take_whole_units(&movement.y, MOTION_SCALE);
+    const int16_t d_scroll_x = take_whole_units(&scroll.x, scroll_divisor(hi_res_x));
+    const int16_t d_scroll_y = take_whole_units(&scroll.y, scroll_divisor(hi_res_y));
+
+    if (d_x != 0 || d_y != 0 || d_scroll_x != 0 || d_scroll_y != 0) {
+        zmk_hid_mouse_movement_set(d_x, d_y);
+        zmk_hid_mouse_scroll_set(d_scroll_x, d_scroll_y);
+        zmk_endpoints_send_mouse_report();
+        zmk_hid_mouse_movement_set(0, 0);
+        zmk_hid_mouse_scroll_set(0, 0);
+    }
+
+    // Keep ticking while keys are held, or while a clamped report left whole units behind.
+    if (move_keys.active_keys > 0 || scroll_keys.active_keys > 0 ||
+        has_whole_units(&movement.x, MOTION_SCALE) || has_whole_units(&movement.y, MOTION_SCALE) ||
+        has_whole_units(&scroll.x, scroll_divisor(hi_res_x)) ||
+        has_whole_units(&scroll.y, scroll_divisor(hi_res_y))) {
+        schedule_tick();
+    }
+}
+
+int zmk_mouse_add_movement(int32_t dx, int32_t dy) {
+    atomic_add(&movement.x, dx * MOTION_SCALE);
+    atomic_add(&movement.y, dy * MOTION_SCALE);
+    schedule_tick();
+    return 0;
+}
+
+int zmk_mouse_add_scroll(int32_t dx, int32_t dy) {
+    atomic_add(&scroll.x, dx * MOTION_SCALE);
+    atomic_add(&scroll.y, dy * MOTION_SCALE);
+    schedule_tick();
+    return 0;
+}
+
+static void key_motion_update(struct mouse_key_motion *motion, struct mouse_accumulator *acc,
+                              const struct zmk_mouse_vector *max_speed,
+                              const struct zmk_mouse_acceleration_config *config, bool state) {
+    const int64_t now = k_uptime_get();
+
+    // Settle the distance travelled at the old speed before changing it.
+    key_motion_integrate(motion, acc, now);
+
+    if (state) {
+        if (motion->active_keys++ == 0) {
+            motion->start_time = now;
+        }
+        motion->speed_x += max_speed->x;
+        motion->speed_y += max_speed->y;
+        motion->config = *config;
+    } else {
+        if (motion->active_keys == 0) {
+            LOG_ERR("Tried to release mouse motion key too often");
+            return;
+        }
+        motion->speed_x -= max_speed->x;
+        motion->speed_y -= max_speed->y;
+        if (--motion->active_keys == 0) {
+            motion->speed_x = 0;
+            motion->speed_y = 0;
+        }
+    }
+
+    LOG_DBG("speed: %d/%d, keys: %d", motion->speed_x, motion->speed_y, motion->active_keys);
+
+    schedule_tick();
+}
 
 static void listener_mouse_button_pressed(const struct zmk_mouse_button_state_changed *ev) {
     LOG_DBG("buttons: 0x%02X", ev->buttons);
@@ -36,8 +262,25 @@ int mouse_listener(const zmk_event_t *eh) {
         }
         return 0;
     }
+
+    const struct zmk_mouse_move_state_changed *mmv_ev = as_zmk_mouse_move_state_changed(eh);
+    if (mmv_ev) {
+        key_motion_update(&move_keys, &movement, &mmv_ev->max_speed, &mmv_ev->config,
+                          mmv_ev->state);
+        return 0;
+    }
+
+    const struct zmk_mouse_scroll_state_changed *msc_ev = as_zmk_mouse_scroll_state_changed(eh);
+    if (msc_ev) {
+        key_motion_update(&scroll_keys, &scroll, &msc_ev->max_speed, &msc_ev->config,
+                          msc_ev->state);
+        return 0;
+    }
+
     return 0;
 }
 
 ZMK_LISTENER(mouse_listener, mouse_listener);
 ZMK_SUBSCRIPTION(mouse_listener, zmk_mouse_button_state_changed);
+ZMK_SUBSCRIPTION(mouse_listener, zmk_mouse_move_state_changed);
+ZMK_SUBSCRIPTION(mouse_listener, zmk_mouse_scroll_state_changed);
@@ -0,0 +1,227 @@
+/*
+ * Copyright (c) 2023 The ZMK Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#define DT_DRV_COMPAT zmk_pointing_listener
+
+#include <stdlib.h>
+#include <zephyr/device.h>
+#include <zephyr/init.h>
+#include <zephyr/kernel.h>
+#include <zephyr/sys/atomic.h>
+#include <zephyr/logging/log.h>
+
+LOG_MODULE_DECLARE(zmk, CONFIG_ZMK_LOG_LEVEL);
+
+#include <drivers/pointing.h>
+#include <zmk/keymap.h>
+#include <zmk/mouse.h>
+#include <zmk/workqueue.h>
+
+// Gains are Q16.16 fixed point values.
+#define GAIN_ONE BIT(16)
+
+struct pointing_listener_config {
+    const struct device *dev;
+    uint32_t cpi;
+    int32_t scale_multiplier;
+    int32_t scale_divisor;
+    bool swap_xy;
+    bool invert_x;
+    bool invert_y;
+    int32_t acceleration_threshold;
+    int32_t acceleration_max_speed;
+    int32_t acceleration_max_factor;
+    zmk_keymap_layers_state_t scroll_layers;
+    int32_t scroll_counts_per_detent;
+};
+
+struct pointing_listener_data {
+    // Raw sensor counts reported since the last time the listener was processed.
+    atomic_t raw_x;
+    atomic_t raw_y;
+    int64_t last_process_time;
+    // Scaled motion that has not yet added up to a whole output unit.
+    int64_t remainder_x;
+    int64_t remainder_y;
+    bool scrolling;
+};
+
+#define SCROLL_LAYER_BIT(node_id, prop, idx) | BIT(DT_PROP_BY_IDX(node_id, prop, idx))
+
+#define LISTENER_CONFIG(n)                                                                         \
+    {                                                                                              \
+        .dev = DEVICE_DT_GET(DT_INST_PHANDLE(n, device)), .cpi = DT_INST_PROP_OR(n, cpi, 0),       \
+        .scale_multiplier = DT_INST_PROP(n, scale_multiplier),                                     \
+        .scale_divisor = DT_INST_PROP(n, scale_divisor), .swap_xy = DT_INST_PROP(n, swap_xy),      \
+        .invert_x = DT_INST_PROP(n, invert_x), .invert_y = DT_INST_PROP(n, invert_y),              \
+        .acceleration_threshold = DT_INST_PROP(n, acceleration_threshold),                         \
+        .acceleration_max_speed = DT_INST_PROP(n, acceleration_max_speed),                         \
+        .acceleration_max_factor = DT_INST_PROP(n, acceleration_max_factor),                       \
+        .scroll_layers = (0 COND_CODE_1(DT_INST_NODE_HAS_PROP(n, scroll_layers),                   \
+                                        (DT_INST_FOREACH_PROP_ELEM(n, scroll_layers,               \
+                                                                   SCROLL_LAYER_BIT)),             \
+                                        ())),                                                      \
+        .scroll_counts_per_detent = DT_INST_PROP(n, scroll_counts_per_detent),                     \
+    },
+
+#define LISTENER_CHECKS(n)                                                                         \
+    BUILD_ASSERT(DT_INST_PROP(n, scale_divisor) > 0, "scale-divisor must be positive");            \
+    BUILD_ASSERT(DT_INST_PROP(n, scroll_counts_per_detent) > 0,                                    \
+                 "scroll-counts-per-detent must be positive");
+
+DT_INST_FOREACH_STATUS_OKAY(LISTENER_CHECKS)
+
+static const struct pointing_listener_config configs[] = {
+    DT_INST_FOREACH_STATUS_OKAY(LISTENER_CONFIG)};
+
+static struct pointing_listener_data listener_data[ARRAY_SIZE(configs)];
+
+// Returns the gain to apply for motion of the given length over elapsed milliseconds.
+static int64_t acceleration_gain(const struct pointing_listener_config *cfg, int32_t x, int32_t y,
+                                 int64_t elapsed) {
+    if (cfg->acceleration_max_factor <= 100 ||
+        cfg->acceleration_max_speed <= cfg->acceleration_threshold) {
+        return GAIN_ONE;
+    }
+
+    // Cheap approximation of the motion's length, within 12% of the euclidean distance.
+    const int32_t ax = abs(x), ay = abs(y);
+    const int64_t length = MAX(ax, ay) + MIN(ax, ay) / 2;
+    const int64_t speed = length * MSEC_PER_SEC / elapsed;
+
+    if (speed <= cfg->acceleration_threshold) {
+        return GAIN_ONE;
+    }
+
+    const int64_t max_gain = (int64_t)GAIN_ONE * cfg->acceleration_max_factor / 100;
+    if (speed >= cfg->acceleration_max_speed) {
+        return max_gain;
+    }
+
+    return GAIN_ONE + (max_gain - GAIN_ONE) * (speed - cfg->acceleration_threshold) /
+                          (cfg->acceleration_max_speed - cfg->acceleration_threshold);
+}
+
+static int32_t take_whole_units(int64_t *remainder, int64_t divisor) {
+    const int32_t units = *remainder / divisor;
+    *remainder -= units * divisor;
+    return units;
+}
+
+static void process_listener(size_t index, int64_t now) {
+    const struct pointing_listener_config *cfg = &configs[index];
+    struct pointing_listener_data *data = &listener_data[index];
+
+    int32_t x = atomic_clear(&data->raw_x);
+    int32_t y = atomic_clear(&data->raw_y);
+
+    if (x == 0 && y == 0) {
+        return;
+    }
+
+    const int64_t elapsed = MAX(now - data->last_process_time, 1);
+    data->last_process_time = now;
+
+    if (cfg->swap_xy) {
+        const int32_t tmp = x;
+        x = y;
+        y = tmp;
+    }
+
+    if (cfg->invert_x) {
+        x = -x;
+    }
+
+    if (cfg->invert_y) {
+        y = -y;
+    }
+
+    const bool scrolling = (zmk_keymap_layer_state() & cfg->scroll_layers) != 0;
+    if (scrolling != data->scrolling) {
+        data->scrolling = scrolling;
+        data->remainder_x = 0;
+        data->remainder_y = 0;
+    }
+
+    int64_t gain = (int64_t)GAIN_ONE * cfg->scale_multiplier / cfg->scale_divisor;
+    gain = gain * acceleration_gain(cfg, x, y, elapsed) / GAIN_ONE;
+
+    if (scrolling) {
+        // Scroll in high resolution steps, so slow motion still scrolls smoothly on hosts that
+        // support it. Moving the pointer up scrolls up.
+        const int64_t divisor = (int64_t)GAIN_ONE * cfg->scroll_counts_per_detent;
+        data->remainder_x += x * gain * ZMK_MOUSE_SCROLL_UNITS_PER_DETENT;
+        data->remainder_y += y * gain * ZMK_MOUSE_SCROLL_UNITS_PER_DETENT;
+
+        const int32_t scroll_x = take_whole_units(&data->remainder_x, divisor);
+        const int32_t scroll_y = take_whole_units(&data->remainder_y, divisor);
+        if (scroll_x != 0 || scroll_y != 0) {
+            zmk_mouse_add_scroll(scroll_x, -scroll_y);
+        }
+    } else {
+        data->remainder_x += x * gain;
+        data->remainder_y += y * gain;
+
+        const int32_t move_x = take_whole_units(&data->remainder_x, GAIN_ONE);
+        const int32_t move_y = take_whole_units(&data->remainder_y, GAIN_ONE);
+        if (move_x != 0 || move_y != 0) {
+            zmk_mouse_add_movement(move_x, move_y);
+        }
+    }
+}
+
+static void process_listeners(struct k_work *work) {
+    const int64_t now = k_uptime_get();
+
+    for (size_t i = 0; i < ARRAY_SIZE(configs); i++) {
+        process_listener(i, now);
+    }
+}
+
+static K_WORK_DEFINE(pointing_work, process_listeners);
+
+// May run in an interrupt context, so only accumulate the raw motion here. Every sample that
+// arrives before the work item runs is merged into a single pass through the pipeline.
+static void pointing_callback(const struct device *dev, int16_t dx, int16_t dy) {
+    for (size_t i = 0; i < ARRAY_SIZE(configs); i++) {
+        if (configs[i].dev == dev) {
+            atomic_add(&listener_data[i].raw_x, dx);
+            atomic_add(&listener_data[i].raw_y, dy);
+        }
+    }
+
+    k_work_submit_to_queue(zmk_workqueue_input_work_q(), &pointing_work);
+}
+
+static int zmk_pointing_init(void) {
+    for (size_t i = 0; i < ARRAY_SIZE(configs); i++) {
+        const struct pointing_listener_config *cfg = &configs[i];
+
+        if (!device_is_ready(cfg->dev)) {
+            LOG_ERR("Pointing device %s is not ready", cfg->dev->name);
+            continue;
+        }
+
+        if (cfg->cpi > 0) {
+            int err = pointing_set_cpi(cfg->dev, cfg->cpi);
+            if (err < 0 && err != -ENOTSUP) {
+                LOG_WRN("Failed to set CPI of %s (%d)", cfg->dev->name, err);
+            }
+        }
+
+        int err = pointing_config(cfg->dev, pointing_callback);
+        if (err < 0) {
+            LOG_ERR("Failed to configure pointing device %s (%d)", cfg->dev->name, err);
+            continue;
+        }
+
+        pointing_enable_callback(cfg->dev);
+    }
+
+    return 0;
+}
+
+SYS_INIT(zmk_pointing_init, APPLICATION, CONFIG_APPLICATION_INIT_PRIORITY);
@@ -15,6 +15,7 @@ LOG_MODULE_DECLARE(zmk, CONFIG_ZMK_LOG_LEVEL);
 #include <zmk/sensors.h>
 #include <zmk/event_manager.h>
 #include <zmk/events/sensor_event.h>
+#include <zmk/workqueue.h>
 
 #if ZMK_KEYMAP_HAS_SENSORS
 
@@ -69,6 +70,37 @@ const struct zmk_sensor_config *zmk_sensors_get_config_at_index(uint8_t sensor_i
     return &configs[sensor_index];
 }
 
+static struct sensor_value add_sensor_values(struct sensor_value total, struct sensor_value delta) {
+    total.val1 += delta.val1;
+    total.val2 += delta.val2;
+
+    if (total.val2 >= 1000000 || total.val2 <= -1000000) {
+        total.val1 += total.val2 / 1000000;
+        total.val2 %= 1000000;
+    }
+
+    return total;
+}
+
+bool zmk_sensor_channel_data_add(struct zmk_sensor_channel_data *total, size_t total_size,
+                                 const struct zmk_sensor_channel_data *data, size_t data_size) {
+    if (total_size != data_size) {
+        return false;
+    }
+
+    for (size_t i = 0; i < data_size; i++) {
+        if (total[i].channel != data[i].channel) {
+            return false;
+        }
+    }
+
+    for (size_t i = 0; i < data_size; i++) {
+        total[i].value = add_sensor_values(total[i].value, data[i].value);
+    }
+
+    return true;
+}
+
 static void trigger_sensor_data_for_position(uint32_t sensor_index) {
     int err;
     const struct sensors_item_cfg *item = &sensors[sensor_index];
@@ -118,7 +150,7 @@ static void zmk_sensors_trigger_handler(const struct device *dev,
 
     if (k_is_in_isr()) {
         atomic_set_bit(pending_sensors, sensor_index);
-        k_work_submit(&sensor_data_work);
+        k_work_submit_to_queue(zmk_workqueue_input_work_q(), &sensor_data_work);
     } else {
         trigger_sensor_data_for_position(sensor_index);
     }
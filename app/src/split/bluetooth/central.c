@@ -4,14 +4,18 @@
  * SPDX-License-Identifier: MIT
  */
 
+#include <stdio.h>
+#include <stdlib.h>
 #include <zephyr/types.h>
 #include <zephyr/init.h>
+#include <zephyr/settings/settings.h>
 
 #include <zephyr/bluetooth/bluetooth.h>
 #include <zephyr/bluetooth/conn.h>
 #include <zephyr/bluetooth/uuid.h>
 #include <zephyr/bluetooth/gatt.h>
 #include <zephyr/bluetooth/hci.h>
+#include <zephyr/sys/atomic.h>
 #include <zephyr/sys/byteorder.h>
 
 #include <zephyr/logging/log.h>
@@ -21,7 +25,11 @@ LOG_MODULE_DECLARE(zmk, CONFIG_ZMK_LOG_LEVEL);
 #include <zmk/stdlib.h>
 #include <zmk/ble.h>
 #include <zmk/behavior.h>
+#include <zmk/matrix.h>
 #include <zmk/sensors.h>
+#include <zmk/split/central.h>
+#include <zmk/split/stats.h>
+#include <zmk/split/transport.h>
 #include <zmk/split/bluetooth/uuid.h>
 #include <zmk/split/bluetooth/service.h>
 #include <zmk/event_manager.h>
@@ -32,7 +40,62 @@ LOG_MODULE_DECLARE(zmk, CONFIG_ZMK_LOG_LEVEL);
 
 static int start_scanning(void);
 
-#define POSITION_STATE_DATA_LEN 16
+// Peripherals never send less than 16 bytes of position state, even for fewer positions.
+#define POSITION_STATE_DATA_LEN MAX(16, DIV_ROUND_UP(ZMK_KEYMAP_LEN, 8))
+
+// Peripheral behavior names longer than this are not resolved, so they are invoked by name.
+#define BEHAVIOR_NAME_MAX_LEN 32
+
+// Number of clock probes of which only the one with the shortest round trip is used.
+#define CLOCK_SYNC_WINDOW 8
+// Interval between probes until the first window of probes has completed.
+#define CLOCK_SYNC_FAST_INTERVAL_MS 100
+// Larger drift estimates are assumed to be measurement errors.
+#define CLOCK_SYNC_MAX_DRIFT_PPM 1000
+
+struct peripheral_clock {
+    bool synced;
+    // Peripheral uptime minus central uptime at ref_time, in milliseconds.
+    int64_t offset;
+    int64_t ref_time;
+    // How much faster the peripheral clock runs than ours, in parts per million.
+    int32_t drift_ppm;
+    uint8_t windows;
+
+    // The probe with the shortest round trip in the current window. The round trip is in ticks.
+    uint8_t samples;
+    int64_t best_rtt;
+    int64_t best_offset;
+    int64_t best_time;
+
+    bool probe_pending;
+    // Uptime in ticks when the pending probe was sent.
+    int64_t probe_start;
+};
+
+#if IS_ENABLED(CONFIG_ZMK_SPLIT_BLE_CENTRAL_CACHE_HANDLES)
+
+// The characteristic handles of a peripheral, as found by the service discovery. Remembered for
+// bonded peripherals, so reconnecting to them can skip the discovery. Zero if not found. The CCC
+// descriptors are those found when subscribing, since the attribute layout doesn't promise where
+// they are.
+struct peripheral_handles {
+    uint16_t num_positions;
+    uint16_t position_events;
+    uint16_t position_state;
+    // Of the position events if the peripheral has them, otherwise of the position state.
+    uint16_t position_ccc;
+    uint16_t sensor_state;
+    uint16_t sensor_state_ccc;
+    uint16_t run_behavior;
+    uint16_t behaviors;
+    uint16_t clock;
+    uint16_t update_hid_indicators;
+    uint16_t battery_level;
+    uint16_t battery_level_ccc;
+};
+
+#endif // IS_ENABLED(CONFIG_ZMK_SPLIT_BLE_CENTRAL_CACHE_HANDLES)
 
 enum peripheral_slot_state {
     PERIPHERAL_SLOT_STATE_OPEN,
@@ -44,6 +107,8 @@ struct peripheral_slot {
     enum peripheral_slot_state state;
     struct bt_conn *conn;
     struct bt_gatt_discover_params discover_params;
+    // Subscribes to the position events if the peripheral has them, or the position state bitmap
+    // if it runs older firmware.
     struct bt_gatt_subscribe_params subscribe_params;
     struct bt_gatt_subscribe_params sensor_subscribe_params;
     struct bt_gatt_discover_params sub_discover_params;
@@ -57,6 +122,36 @@ struct peripheral_slot {
 #endif // IS_ENABLED(CONFIG_ZMK_SPLIT_PERIPHERAL_HID_INDICATORS)
     uint8_t position_state[POSITION_STATE_DATA_LEN];
     uint8_t changed_positions[POSITION_STATE_DATA_LEN];
+    // Number of positions the peripheral reports, as read from its number of digitals descriptor.
+    uint16_t num_positions;
+    struct bt_gatt_read_params num_positions_read_params;
+    bool has_position_events;
+    uint16_t position_state_handle;
+    struct bt_gatt_read_params position_state_read_params;
+    atomic_t position_state_read_pending;
+    // Set when a position event was dropped because the queue was full. The position state is read
+    // again once the queue has drained.
+    atomic_t resync_pending;
+    uint8_t next_event_sequence;
+    int64_t last_event_timestamp;
+    uint16_t clock_handle;
+    struct bt_gatt_read_params clock_read_params;
+    struct peripheral_clock clock;
+    // The peripheral's behavior table, as the local behavior for each index. Behaviors are invoked
+    // by name until the table has been read, or if the peripheral has none.
+    uint16_t behaviors_handle;
+    struct bt_gatt_read_params behaviors_read_params;
+    const struct device *behaviors[CONFIG_ZMK_SPLIT_BLE_CENTRAL_BEHAVIOR_TABLE_SIZE];
+    uint16_t behavior_count;
+    // Set from the BT RX context once the table is complete, and read on the split run work queue.
+    atomic_t behaviors_ready;
+    char behavior_name[BEHAVIOR_NAME_MAX_LEN];
+    uint8_t behavior_name_len;
+#if IS_ENABLED(CONFIG_ZMK_SPLIT_BLE_CENTRAL_CACHE_HANDLES)
+    struct peripheral_handles handles;
+    // Set if the handles came from the cache instead of the discovery of this connection.
+    bool using_cached_handles;
+#endif // IS_ENABLED(CONFIG_ZMK_SPLIT_BLE_CENTRAL_CACHE_HANDLES)
 };
 
 static struct peripheral_slot peripherals[ZMK_SPLIT_BLE_PERIPHERAL_COUNT];
@@ -65,18 +160,101 @@ static bool is_scanning = false;
 
 static const struct bt_uuid_128 split_service_uuid = BT_UUID_INIT_128(ZMK_SPLIT_BT_SERVICE_UUID);
 
-K_MSGQ_DEFINE(peripheral_event_msgq, sizeof(struct zmk_position_state_changed),
-              CONFIG_ZMK_SPLIT_BLE_CENTRAL_POSITION_QUEUE_SIZE, 4);
+#if IS_ENABLED(CONFIG_ZMK_SPLIT_BLE_CENTRAL_CACHE_HANDLES)
+
+// Peripheral slots are tied to the address of a bonded peripheral, so handles are kept per slot.
+static struct peripheral_handles cached_handles[ZMK_SPLIT_BLE_PERIPHERAL_COUNT];
+
+#if IS_ENABLED(CONFIG_SETTINGS)
+
+static bool cached_handles_changed[ZMK_SPLIT_BLE_PERIPHERAL_COUNT];
+
+static void save_cached_handles_work_callback(struct k_work *work) {
+    for (int i = 0; i < ZMK_SPLIT_BLE_PERIPHERAL_COUNT; i++) {
+        if (!cached_handles_changed[i]) {
+            continue;
+        }
+        cached_handles_changed[i] = false;
+
+        char setting_name[32];
+        snprintf(setting_name, sizeof(setting_name), "split/central/handles/%d", i);
+        int err = settings_save_one(setting_name, &cached_handles[i], sizeof(cached_handles[i]));
+        if (err) {
+            LOG_ERR("Failed to save the handles of peripheral %d (err %d)", i, err);
+        }
+    }
+}
+
+static K_WORK_DELAYABLE_DEFINE(save_cached_handles_work, save_cached_handles_work_callback);
 
-void peripheral_event_work_callback(struct k_work *work) {
-    struct zmk_position_state_changed ev;
-    while (k_msgq_get(&peripheral_event_msgq, &ev, K_NO_WAIT) == 0) {
-        LOG_DBG("Trigger key position state change for %d", ev.position);
-        raise_zmk_position_state_changed(ev);
+#endif // IS_ENABLED(CONFIG_SETTINGS)
+
+static void set_cached_handles(int index, const struct peripheral_handles *handles) {
+    if (memcmp(&cached_handles[index], handles, sizeof(*handles)) == 0) {
+        return;
     }
+
+    cached_handles[index] = *handles;
+
+#if IS_ENABLED(CONFIG_SETTINGS)
+    cached_handles_changed[index] = true;
+    k_work_reschedule(&save_cached_handles_work, K_MSEC(CONFIG_ZMK_SETTINGS_SAVE_DEBOUNCE));
+#endif // IS_ENABLED(CONFIG_SETTINGS)
 }
 
-K_WORK_DEFINE(peripheral_event_work, peripheral_event_work_callback);
+// Whether the handles include everything the discovery waits for before it stops.
+static bool peripheral_handles_complete(const struct peripheral_handles *handles) {
+    bool complete = handles->num_positions && handles->position_state && handles->position_ccc &&
+                    handles->run_behavior && handles->clock;
+
+#if ZMK_KEYMAP_HAS_SENSORS
+    complete = complete && handles->sensor_state && handles->sensor_state_ccc;
+#endif /* ZMK_KEYMAP_HAS_SENSORS */
+#if IS_ENABLED(CONFIG_ZMK_SPLIT_PERIPHERAL_HID_INDICATORS)
+    complete = complete && handles->update_hid_indicators;
+#endif // IS_ENABLED(CONFIG_ZMK_SPLIT_PERIPHERAL_HID_INDICATORS)
+#if IS_ENABLED(CONFIG_ZMK_SPLIT_BLE_CENTRAL_BATTERY_LEVEL_FETCHING)
+    complete = complete && handles->battery_level && handles->battery_level_ccc;
+#endif /* IS_ENABLED(CONFIG_ZMK_SPLIT_BLE_CENTRAL_BATTERY_LEVEL_FETCHING) */
+
+    return complete;
+}
+
+// Called as the discovery finds handles, and caches them once it has found all of them.
+static void remember_discovered_handles(struct peripheral_slot *slot) {
+    if (!slot->using_cached_handles && peripheral_handles_complete(&slot->handles)) {
+        set_cached_handles(slot - peripherals, &slot->handles);
+    }
+}
+
+// The peripheral no longer has the cached handles, e.g. because its firmware was updated. Forget
+// them and reconnect, so the next connection discovers them again.
+static void forget_cached_handles(struct bt_conn *conn, struct peripheral_slot *slot) {
+    if (!slot->using_cached_handles) {
+        return;
+    }
+
+    LOG_WRN("Cached handles of peripheral %d are out of date", slot - peripherals);
+    set_cached_handles(slot - peripherals, &(struct peripheral_handles){0});
+    slot->using_cached_handles = false;
+    bt_conn_disconnect(conn, BT_HCI_ERR_REMOTE_USER_TERM_CONN);
+}
+
+#endif // IS_ENABLED(CONFIG_ZMK_SPLIT_BLE_CENTRAL_CACHE_HANDLES)
+
+// Updates the known state of the position and queues the change. If the queue is full, the known
+// state is left as it was, so the change is raised again by the next position state read.
+static int raise_peripheral_position_event(struct peripheral_slot *slot, uint32_t position,
+                                           bool pressed, int64_t timestamp) {
+    int err =
+        zmk_split_central_position_state_changed(slot - peripherals, position, pressed, timestamp);
+    if (err) {
+        return err;
+    }
+
+    WRITE_BIT(slot->position_state[position / 8], position % 8, pressed);
+    return 0;
+}
 
 int peripheral_slot_index_for_conn(struct bt_conn *conn) {
     for (int i = 0; i < ZMK_SPLIT_BLE_PERIPHERAL_COUNT; i++) {
@@ -109,6 +287,7 @@ int release_peripheral_slot(int index) {
     }
 
     LOG_DBG("Releasing peripheral slot at %d", index);
+    zmk_split_stats_link_down(index);
 
     if (slot->conn != NULL) {
         bt_conn_unref(slot->conn);
@@ -116,29 +295,42 @@ int release_peripheral_slot(int index) {
     }
     slot->state = PERIPHERAL_SLOT_STATE_OPEN;
 
-    // Raise events releasing any active positions from this peripheral
+    // Raise events releasing any active positions from this peripheral. Positions whose release
+    // could not be queued stay pressed in the known state, so they are released by the position
+    // state read once the peripheral reconnects.
     for (int i = 0; i < POSITION_STATE_DATA_LEN; i++) {
         for (int j = 0; j < 8; j++) {
             if (slot->position_state[i] & BIT(j)) {
-                uint32_t position = (i * 8) + j;
-                struct zmk_position_state_changed ev = {.source = index,
-                                                        .position = position,
-                                                        .state = false,
-                                                        .timestamp = k_uptime_get()};
-
-                k_msgq_put(&peripheral_event_msgq, &ev, K_NO_WAIT);
-                k_work_submit(&peripheral_event_work);
+                raise_peripheral_position_event(slot, (i * 8) + j, false, k_uptime_get());
             }
         }
     }
 
+    zmk_split_central_position_events_ready();
+
     for (int i = 0; i < POSITION_STATE_DATA_LEN; i++) {
-        slot->position_state[i] = 0U;
         slot->changed_positions[i] = 0U;
     }
 
+    slot->num_positions = POSITION_STATE_DATA_LEN * 8;
+    slot->has_position_events = false;
+    atomic_set(&slot->position_state_read_pending, false);
+    atomic_set(&slot->resync_pending, false);
+    slot->last_event_timestamp = 0;
+    slot->clock = (struct peripheral_clock){0};
+    atomic_set(&slot->behaviors_ready, false);
+    slot->behavior_count = 0;
+    slot->behavior_name_len = 0;
+#if IS_ENABLED(CONFIG_ZMK_SPLIT_BLE_CENTRAL_CACHE_HANDLES)
+    slot->handles = (struct peripheral_handles){0};
+    slot->using_cached_handles = false;
+#endif // IS_ENABLED(CONFIG_ZMK_SPLIT_BLE_CENTRAL_CACHE_HANDLES)
+
     // Clean up previously discovered handles;
     slot->subscribe_params.value_handle = 0;
+    slot->position_state_handle = 0;
+    slot->clock_handle = 0;
+    slot->behaviors_handle = 0;
     slot->run_behavior_handle = 0;
 #if IS_ENABLED(CONFIG_ZMK_SPLIT_PERIPHERAL_HID_INDICATORS)
     slot->update_hid_indicators = 0;
@@ -153,6 +345,7 @@ int reserve_peripheral_slot(const bt_addr_le_t *addr) {
         if (peripherals[i].state == PERIPHERAL_SLOT_STATE_OPEN) {
             // Be sure the slot is fully reinitialized.
             release_peripheral_slot(i);
+            peripherals[i].num_positions = POSITION_STATE_DATA_LEN * 8;
             peripherals[i].state = PERIPHERAL_SLOT_STATE_CONNECTING;
             return i;
         }
@@ -181,19 +374,6 @@ int confirm_peripheral_slot_conn(struct bt_conn *conn) {
 }
 
 #if ZMK_KEYMAP_HAS_SENSORS
-K_MSGQ_DEFINE(peripheral_sensor_event_msgq, sizeof(struct zmk_sensor_event),
-              CONFIG_ZMK_SPLIT_BLE_CENTRAL_POSITION_QUEUE_SIZE, 4);
-
-void peripheral_sensor_event_work_callback(struct k_work *work) {
-    struct zmk_sensor_event ev;
-    while (k_msgq_get(&peripheral_sensor_event_msgq, &ev, K_NO_WAIT) == 0) {
-        LOG_DBG("Trigger sensor change for %d", ev.sensor_index);
-        raise_zmk_sensor_event(ev);
-    }
-}
-
-K_WORK_DEFINE(peripheral_sensor_event_work, peripheral_sensor_event_work_callback);
-
 static uint8_t split_central_sensor_notify_func(struct bt_conn *conn,
                                                 struct bt_gatt_subscribe_params *params,
                                                 const void *data, uint16_t length) {
@@ -203,29 +383,271 @@ static uint8_t split_central_sensor_notify_func(struct bt_conn *conn,
         return BT_GATT_ITER_STOP;
     }
 
+    const int source = peripheral_slot_index_for_conn(conn);
+    if (source < 0) {
+        LOG_ERR("No peripheral state found for connection");
+        return BT_GATT_ITER_CONTINUE;
+    }
+
     LOG_DBG("[SENSOR NOTIFICATION] data %p length %u", data, length);
+    zmk_split_stats_inc(source, ZMK_SPLIT_STAT_RX);
 
     if (length < offsetof(struct sensor_event, channel_data)) {
         LOG_WRN("Ignoring sensor notify with insufficient data length (%d)", length);
         return BT_GATT_ITER_STOP;
     }
 
-    struct sensor_event sensor_event;
-    memcpy(&sensor_event, data, MIN(length, sizeof(sensor_event)));
-    struct zmk_sensor_event ev = {
-        .sensor_index = sensor_event.sensor_index,
-        .channel_data_size = MIN(sensor_event.channel_data_size, ZMK_SENSOR_EVENT_MAX_CHANNELS),
-        .timestamp = k_uptime_get()};
+    const int64_t timestamp = k_uptime_get();
+
+    // Each notification carries the deltas accumulated by one or more sensors since the previous
+    // one, so each record results in a single sensor event.
+    const uint8_t *record = data;
+    while (length >= offsetof(struct sensor_event, channel_data)) {
+        const uint16_t record_len = MIN(length, sizeof(struct sensor_event));
+        struct sensor_event sensor_event = {0};
+        memcpy(&sensor_event, record, record_len);
+
+        struct zmk_sensor_event ev = {
+            .sensor_index = sensor_event.sensor_index,
+            .channel_data_size = MIN(sensor_event.channel_data_size, ZMK_SENSOR_EVENT_MAX_CHANNELS),
+            .timestamp = timestamp};
 
-    memcpy(ev.channel_data, sensor_event.channel_data,
-           sizeof(struct zmk_sensor_channel_data) * sensor_event.channel_data_size);
-    k_msgq_put(&peripheral_sensor_event_msgq, &ev, K_NO_WAIT);
-    k_work_submit(&peripheral_sensor_event_work);
+        memcpy(ev.channel_data, sensor_event.channel_data,
+               sizeof(struct zmk_sensor_channel_data) * ev.channel_data_size);
+        zmk_split_central_sensor_event(source, &ev);
+
+        record += record_len;
+        length -= record_len;
+    }
 
     return BT_GATT_ITER_CONTINUE;
 }
 #endif /* ZMK_KEYMAP_HAS_SENSORS */
 
+static int64_t peripheral_clock_offset(const struct peripheral_clock *clock, int64_t now) {
+    return clock->offset + (int64_t)clock->drift_ppm * (now - clock->ref_time) / 1000000;
+}
+
+// Translates a truncated peripheral timestamp to the central's clock. The peripheral timestamp
+// is assumed to be within 24 days of the current time.
+static int64_t peripheral_clock_to_local(const struct peripheral_clock *clock, uint32_t timestamp,
+                                         int64_t now) {
+    const int64_t peripheral_now = now + peripheral_clock_offset(clock, now);
+    return now + (int32_t)(timestamp - (uint32_t)peripheral_now);
+}
+
+// sent and received are our uptime in ticks, peripheral_time the peripheral's uptime in
+// milliseconds.
+static void peripheral_clock_add_sample(struct peripheral_clock *clock, int64_t sent,
+                                        int64_t received, int64_t peripheral_time) {
+    // Assume the request and the response took equally long. The shorter the round trip, the
+    // smaller the error of that assumption can be.
+    const int64_t rtt = received - sent;
+    const int64_t time = k_ticks_to_ms_floor64(sent + rtt / 2);
+    const int64_t offset = peripheral_time - time;
+
+    LOG_DBG("Clock sample: offset %lld ms, rtt %lld us", offset, k_ticks_to_us_floor64(rtt));
+
+    if (!clock->synced) {
+        // Use the first sample right away, and refine it once the window is complete.
+        clock->offset = offset;
+        clock->ref_time = time;
+        clock->synced = true;
+    }
+
+    if (clock->samples == 0 || rtt < clock->best_rtt) {
+        clock->best_rtt = rtt;
+        clock->best_offset = offset;
+        clock->best_time = time;
+    }
+
+    if (++clock->samples < CLOCK_SYNC_WINDOW) {
+        return;
+    }
+
+    if (clock->windows > 0 && clock->best_time > clock->ref_time) {
+        const int64_t drift = (clock->best_offset - clock->offset) * 1000000 /
+                              (clock->best_time - clock->ref_time);
+        if (drift < -CLOCK_SYNC_MAX_DRIFT_PPM || drift > CLOCK_SYNC_MAX_DRIFT_PPM) {
+            LOG_WRN("Ignoring peripheral clock drift of %lld ppm", drift);
+        } else {
+            clock->drift_ppm = clock->windows == 1 ? drift : (clock->drift_ppm * 3 + drift) / 4;
+        }
+    }
+
+    clock->offset = clock->best_offset;
+    clock->ref_time = clock->best_time;
+    clock->windows = MIN(clock->windows + 1, UINT8_MAX);
+    clock->samples = 0;
+
+    LOG_DBG("Peripheral clock offset %lld ms, drift %d ppm (rtt %lld us)", clock->offset,
+            clock->drift_ppm, k_ticks_to_us_floor64(clock->best_rtt));
+}
+
+static uint8_t split_central_clock_read_func(struct bt_conn *conn, uint8_t err,
+                                             struct bt_gatt_read_params *params, const void *data,
+                                             uint16_t length) {
+    const int64_t received = k_uptime_ticks();
+
+    struct peripheral_slot *slot = peripheral_slot_for_conn(conn);
+    if (!slot) {
+        LOG_ERR("No peripheral state found for connection");
+        return BT_GATT_ITER_STOP;
+    }
+
+    slot->clock.probe_pending = false;
+
+    if (err > 0) {
+        LOG_ERR("Error during reading peripheral clock: %u", err);
+        return BT_GATT_ITER_STOP;
+    }
+
+    if (!data) {
+        return BT_GATT_ITER_STOP;
+    }
+
+    if (length != sizeof(int64_t)) {
+        LOG_WRN("Ignoring peripheral clock with unexpected length (%d)", length);
+        return BT_GATT_ITER_STOP;
+    }
+
+    int64_t peripheral_time;
+    memcpy(&peripheral_time, data, sizeof(peripheral_time));
+    peripheral_clock_add_sample(&slot->clock, slot->clock.probe_start, received, peripheral_time);
+
+    if (slot->clock.samples == 0) {
+        // A window just completed, and its shortest round trip is the best latency estimate.
+        zmk_split_stats_set_latency(slot - peripherals,
+                                    k_ticks_to_us_floor32(slot->clock.best_rtt / 2));
+    }
+
+    return BT_GATT_ITER_STOP;
+}
+
+static void split_central_probe_clock(struct peripheral_slot *slot) {
+    if (slot->state != PERIPHERAL_SLOT_STATE_CONNECTED || !slot->clock_handle ||
+        slot->clock.probe_pending) {
+        return;
+    }
+
+    slot->clock_read_params.func = split_central_clock_read_func;
+    slot->clock_read_params.handle_count = 1;
+    slot->clock_read_params.single.handle = slot->clock_handle;
+    slot->clock_read_params.single.offset = 0;
+
+    slot->clock.probe_start = k_uptime_ticks();
+    int err = bt_gatt_read(slot->conn, &slot->clock_read_params);
+    if (err) {
+        LOG_DBG("Failed to read peripheral clock (err %d)", err);
+        return;
+    }
+
+    slot->clock.probe_pending = true;
+}
+
+#if IS_ENABLED(CONFIG_ZMK_SPLIT_STATS)
+
+// The host stack has no API for the RSSI of a connection, so ask the controller directly.
+static void split_central_read_rssi(uint8_t index) {
+    struct peripheral_slot *slot = &peripherals[index];
+    if (slot->state != PERIPHERAL_SLOT_STATE_CONNECTED) {
+        return;
+    }
+
+    uint16_t handle;
+    int err = bt_hci_get_conn_handle(slot->conn, &handle);
+    if (err) {
+        return;
+    }
+
+    struct net_buf *buf =
+        bt_hci_cmd_create(BT_HCI_OP_READ_RSSI, sizeof(struct bt_hci_cp_read_rssi));
+    if (!buf) {
+        return;
+    }
+
+    struct bt_hci_cp_read_rssi *cp = net_buf_add(buf, sizeof(*cp));
+    cp->handle = sys_cpu_to_le16(handle);
+
+    struct net_buf *rsp;
+    err = bt_hci_cmd_send_sync(BT_HCI_OP_READ_RSSI, buf, &rsp);
+    if (err) {
+        LOG_DBG("Failed to read the RSSI of peripheral %d (err %d)", index, err);
+        return;
+    }
+
+    const struct bt_hci_rp_read_rssi *rp = (const void *)rsp->data;
+    zmk_split_stats_set_rssi(index, rp->rssi);
+    net_buf_unref(rsp);
+}
+
+#endif // IS_ENABLED(CONFIG_ZMK_SPLIT_STATS)
+
+static void split_central_clock_sync_work_callback(struct k_work *work);
+
+static K_WORK_DELAYABLE_DEFINE(split_central_clock_sync_work,
+                               split_central_clock_sync_work_callback);
+
+// Runs while any peripheral is connected, and is started again by the next connection.
+static void split_central_clock_sync_work_callback(struct k_work *work) {
+    int interval = CONFIG_ZMK_SPLIT_BLE_CENTRAL_CLOCK_SYNC_INTERVAL;
+    bool connected = false;
+
+    for (int i = 0; i < ZMK_SPLIT_BLE_PERIPHERAL_COUNT; i++) {
+        struct peripheral_slot *slot = &peripherals[i];
+        if (slot->state != PERIPHERAL_SLOT_STATE_CONNECTED) {
+            continue;
+        }
+        connected = true;
+
+        split_central_probe_clock(slot);
+
+        if (slot->clock_handle && slot->clock.windows == 0) {
+            interval = MIN(interval, CLOCK_SYNC_FAST_INTERVAL_MS);
+        }
+    }
+
+    if (connected) {
+        k_work_schedule(&split_central_clock_sync_work, K_MSEC(interval));
+    }
+}
+
+// Raises events for every position that differs between the known and the given bitmap.
+static int split_central_process_position_state(struct peripheral_slot *slot, const uint8_t *data,
+                                                uint16_t length) {
+    const int len = MIN(length, DIV_ROUND_UP(slot->num_positions, 8));
+    const int64_t timestamp = k_uptime_get();
+    int ret = 0;
+
+    for (int i = 0; i < len; i++) {
+        slot->changed_positions[i] = data[i] ^ slot->position_state[i];
+        LOG_DBG("data: %d", data[i]);
+    }
+
+    for (int i = 0; i < len; i++) {
+        for (int j = 0; j < 8; j++) {
+            if (slot->changed_positions[i] & BIT(j)) {
+                uint32_t position = (i * 8) + j;
+                bool pressed = data[i] & BIT(j);
+                int err = raise_peripheral_position_event(slot, position, pressed, timestamp);
+                if (err) {
+                    ret = err;
+                }
+            }
+        }
+    }
+
+    zmk_split_central_position_events_ready();
+    return ret;
+}
+
+// Catches up on a dropped position event by reading the position state once the queued events were
+// raised, see split_central_position_events_drained().
+static void split_central_request_resync(struct peripheral_slot *slot) {
+    atomic_set(&slot->resync_pending, true);
+    zmk_split_central_position_events_ready();
+}
+
 static uint8_t split_central_notify_func(struct bt_conn *conn,
                                          struct bt_gatt_subscribe_params *params, const void *data,
                                          uint16_t length) {
@@ -243,28 +665,235 @@ static uint8_t split_central_notify_func(struct bt_conn *conn,
     }
 
     LOG_DBG("[NOTIFICATION] data %p length %u", data, length);
+    zmk_split_stats_inc(slot - peripherals, ZMK_SPLIT_STAT_RX);
 
-    for (int i = 0; i < POSITION_STATE_DATA_LEN; i++) {
-        slot->changed_positions[i] = ((uint8_t *)data)[i] ^ slot->position_state[i];
-        slot->position_state[i] = ((uint8_t *)data)[i];
-        LOG_DBG("data: %d", slot->position_state[i]);
+    if (split_central_process_position_state(slot, data, length)) {
+        split_central_request_resync(slot);
     }
 
-    for (int i = 0; i < POSITION_STATE_DATA_LEN; i++) {
-        for (int j = 0; j < 8; j++) {
-            if (slot->changed_positions[i] & BIT(j)) {
-                uint32_t position = (i * 8) + j;
-                bool pressed = slot->position_state[i] & BIT(j);
-                struct zmk_position_state_changed ev = {.source =
-                                                            peripheral_slot_index_for_conn(conn),
-                                                        .position = position,
-                                                        .state = pressed,
-                                                        .timestamp = k_uptime_get()};
-
-                k_msgq_put(&peripheral_event_msgq, &ev, K_NO_WAIT);
-                k_work_submit(&peripheral_event_work);
-            }
+    return BT_GATT_ITER_CONTINUE;
+}
+
+static uint8_t split_central_position_state_read_func(struct bt_conn *conn, uint8_t err,
+                                                      struct bt_gatt_read_params *params,
+                                                      const void *data, uint16_t length) {
+    struct peripheral_slot *slot = peripheral_slot_for_conn(conn);
+    if (!slot) {
+        LOG_ERR("No peripheral state found for connection");
+        return BT_GATT_ITER_STOP;
+    }
+
+    atomic_set(&slot->position_state_read_pending, false);
+
+    if (err > 0) {
+        LOG_ERR("Error during reading peripheral position state: %u", err);
+#if IS_ENABLED(CONFIG_ZMK_SPLIT_BLE_CENTRAL_CACHE_HANDLES)
+        forget_cached_handles(conn, slot);
+#endif // IS_ENABLED(CONFIG_ZMK_SPLIT_BLE_CENTRAL_CACHE_HANDLES)
+        return BT_GATT_ITER_STOP;
+    }
+
+    if (!data) {
+        LOG_DBG("[READ COMPLETED]");
+        return BT_GATT_ITER_STOP;
+    }
+
+    LOG_DBG("[POSITION STATE READ] data %p length %u", data, length);
+
+    if (split_central_process_position_state(slot, data, length)) {
+        // Read again until the whole state fits the queue.
+        split_central_request_resync(slot);
+    }
+
+    return BT_GATT_ITER_STOP;
+}
+
+// Reads the complete position state of the peripheral, to catch up on any position events that
+// were missed.
+static int split_central_resync_position_state(struct bt_conn *conn,
+                                               struct peripheral_slot *slot) {
+    if (!slot->position_state_handle) {
+        return -ENOENT;
+    }
+
+    if (!atomic_cas(&slot->position_state_read_pending, false, true)) {
+        return -EBUSY;
+    }
+
+    slot->position_state_read_params.func = split_central_position_state_read_func;
+    slot->position_state_read_params.handle_count = 1;
+    slot->position_state_read_params.single.handle = slot->position_state_handle;
+    slot->position_state_read_params.single.offset = 0;
+
+    int err = bt_gatt_read(conn, &slot->position_state_read_params);
+    if (err) {
+        LOG_ERR("Failed to read peripheral position state (err %d)", err);
+        atomic_set(&slot->position_state_read_pending, false);
+        return err;
+    }
+
+    return 0;
+}
+
+// Called by the position event queue once its events were raised, so there is room for the
+// position state again.
+static void split_central_position_events_drained(uint8_t source) {
+    if (source >= ZMK_SPLIT_BLE_PERIPHERAL_COUNT) {
+        return;
+    }
+
+    struct peripheral_slot *slot = &peripherals[source];
+    if (!atomic_cas(&slot->resync_pending, true, false) ||
+        slot->state != PERIPHERAL_SLOT_STATE_CONNECTED) {
+        return;
+    }
+
+    if (split_central_resync_position_state(slot->conn, slot)) {
+        // A read in progress may have started before the drop. It ends with another drain, which
+        // tries again.
+        atomic_set(&slot->resync_pending, true);
+    }
+}
+
+static uint8_t split_central_num_positions_read_func(struct bt_conn *conn, uint8_t err,
+                                                     struct bt_gatt_read_params *params,
+                                                     const void *data, uint16_t length) {
+    struct peripheral_slot *slot = peripheral_slot_for_conn(conn);
+    if (!slot) {
+        LOG_ERR("No peripheral state found for connection");
+        return BT_GATT_ITER_STOP;
+    }
+
+    if (err > 0) {
+        LOG_ERR("Error during reading peripheral number of positions: %u", err);
+        return BT_GATT_ITER_STOP;
+    }
+
+    if (!data || length == 0) {
+        return BT_GATT_ITER_STOP;
+    }
+
+    // Older peripherals report a single byte.
+    uint16_t num_positions =
+        length >= sizeof(uint16_t) ? sys_get_le16(data) : ((const uint8_t *)data)[0];
+
+    if (num_positions > POSITION_STATE_DATA_LEN * 8) {
+        LOG_WRN("Peripheral has %d positions, but only %d are supported", num_positions,
+                POSITION_STATE_DATA_LEN * 8);
+        num_positions = POSITION_STATE_DATA_LEN * 8;
+    }
+
+    LOG_DBG("Peripheral has %d positions", num_positions);
+    slot->num_positions = num_positions;
+
+#if IS_ENABLED(CONFIG_ZMK_SPLIT_BLE_CENTRAL_CACHE_HANDLES)
+    slot->handles.num_positions = num_positions;
+    remember_discovered_handles(slot);
+#endif // IS_ENABLED(CONFIG_ZMK_SPLIT_BLE_CENTRAL_CACHE_HANDLES)
+
+    return BT_GATT_ITER_STOP;
+}
+
+// The number of digitals descriptor of the position state characteristic is not found by the
+// characteristic discovery, so read it by its UUID instead.
+static void split_central_read_num_positions(struct bt_conn *conn, struct peripheral_slot *slot,
+                                             uint16_t start_handle) {
+    slot->num_positions_read_params.func = split_central_num_positions_read_func;
+    slot->num_positions_read_params.handle_count = 0;
+    slot->num_positions_read_params.by_uuid.uuid = BT_UUID_NUM_OF_DIGITALS;
+    slot->num_positions_read_params.by_uuid.start_handle = start_handle;
+    slot->num_positions_read_params.by_uuid.end_handle = slot->discover_params.end_handle;
+
+    int err = bt_gatt_read(conn, &slot->num_positions_read_params);
+    if (err) {
+        LOG_ERR("Failed to read peripheral number of positions (err %d)", err);
+    }
+}
+
+static uint8_t split_central_position_events_notify_func(struct bt_conn *conn,
+                                                         struct bt_gatt_subscribe_params *params,
+                                                         const void *data, uint16_t length) {
+    struct peripheral_slot *slot = peripheral_slot_for_conn(conn);
+
+    if (slot == NULL) {
+        LOG_ERR("No peripheral state found for connection");
+        return BT_GATT_ITER_CONTINUE;
+    }
+
+    if (!data) {
+        LOG_DBG("[UNSUBSCRIBED]");
+        params->value_handle = 0U;
+        return BT_GATT_ITER_STOP;
+    }
+
+    LOG_DBG("[POSITION EVENTS NOTIFICATION] data %p length %u", data, length);
+    zmk_split_stats_inc(slot - peripherals, ZMK_SPLIT_STAT_RX);
+
+    const struct zmk_split_position_events_header *header = data;
+    const struct zmk_split_position_event *events =
+        (const struct zmk_split_position_event *)(header + 1);
+    const size_t count = length > sizeof(*header)
+                             ? (length - sizeof(*header)) / sizeof(struct zmk_split_position_event)
+                             : 0;
+    if (count == 0) {
+        LOG_WRN("Ignoring position events notify with insufficient data length (%d)", length);
+        return BT_GATT_ITER_CONTINUE;
+    }
+
+    // Once the clocks are synchronized, the header says when the last event happened. Until then,
+    // go by how long ago the peripheral says it happened. Walk back through the time between the
+    // events to find when the first one happened, so the events keep the timing they had on the
+    // peripheral.
+    const int64_t now = k_uptime_get();
+    int64_t timestamp = now - header->age;
+    if (slot->clock.synced) {
+        timestamp = MIN(peripheral_clock_to_local(&slot->clock, header->timestamp, now), now);
+    }
+    for (size_t i = 1; i < count; i++) {
+        timestamp -= events[i].dt;
+    }
+    timestamp = MAX(timestamp, slot->last_event_timestamp);
+
+    bool missed_events = false;
+    bool dropped_events = false;
+    for (size_t i = 0; i < count; i++) {
+        const struct zmk_split_position_event *ev = &events[i];
+
+        if (i > 0) {
+            timestamp += ev->dt;
         }
+
+        if (ev->sequence != slot->next_event_sequence && slot->last_event_timestamp != 0) {
+            LOG_WRN("Missed position events from peripheral (expected %d, got %d)",
+                    slot->next_event_sequence, ev->sequence);
+            missed_events = true;
+        }
+        slot->next_event_sequence = ev->sequence + 1;
+        slot->last_event_timestamp = timestamp;
+
+        const uint16_t position = ev->position & ~ZMK_SPLIT_POSITION_EVENT_PRESSED;
+        const bool pressed = (ev->position & ZMK_SPLIT_POSITION_EVENT_PRESSED) != 0;
+        if (position >= slot->num_positions) {
+            LOG_WRN("Ignoring event for out of range position %d", position);
+            continue;
+        }
+
+        if (((slot->position_state[position / 8] & BIT(position % 8)) != 0) == pressed) {
+            continue;
+        }
+
+        if (raise_peripheral_position_event(slot, position, pressed, timestamp)) {
+            dropped_events = true;
+        }
+    }
+
+    zmk_split_central_position_events_ready();
+
+    if (dropped_events) {
+        // Catch up on the dropped events once the queue has drained.
+        split_central_request_resync(slot);
+    } else if (missed_events) {
+        split_central_resync_position_state(conn, slot);
     }
 
     return BT_GATT_ITER_CONTINUE;
@@ -391,6 +1020,151 @@ static int split_central_subscribe(struct bt_conn *conn, struct bt_gatt_subscrib
     return err;
 }
 
+#if IS_ENABLED(CONFIG_ZMK_SPLIT_BLE_CENTRAL_CACHE_HANDLES)
+// The handle of the CCC descriptor a subscription uses, as kept in the slot's handles.
+static uint16_t *peripheral_ccc_handle(struct peripheral_slot *slot,
+                                       const struct bt_gatt_subscribe_params *params) {
+    if (params == &slot->subscribe_params) {
+        return &slot->handles.position_ccc;
+    }
+#if ZMK_KEYMAP_HAS_SENSORS
+    if (params == &slot->sensor_subscribe_params) {
+        return &slot->handles.sensor_state_ccc;
+    }
+#endif /* ZMK_KEYMAP_HAS_SENSORS */
+#if IS_ENABLED(CONFIG_ZMK_SPLIT_BLE_CENTRAL_BATTERY_LEVEL_FETCHING)
+    if (params == &slot->batt_lvl_subscribe_params) {
+        return &slot->handles.battery_level_ccc;
+    }
+#endif /* IS_ENABLED(CONFIG_ZMK_SPLIT_BLE_CENTRAL_BATTERY_LEVEL_FETCHING) */
+    return NULL;
+}
+
+static void split_central_cached_subscribe_func(struct bt_conn *conn, uint8_t err,
+                                                struct bt_gatt_subscribe_params *params) {
+    if (err) {
+        LOG_ERR("Failed to subscribe with cached handle %d (err %d)", params->value_handle, err);
+
+        struct peripheral_slot *slot = peripheral_slot_for_conn(conn);
+        if (slot) {
+            forget_cached_handles(conn, slot);
+        }
+    }
+}
+
+// Remembers the CCC descriptor the stack discovered for a subscription.
+static void split_central_discovered_subscribe_func(struct bt_conn *conn, uint8_t err,
+                                                    struct bt_gatt_subscribe_params *params) {
+    struct peripheral_slot *slot = peripheral_slot_for_conn(conn);
+    if (err || !slot) {
+        return;
+    }
+
+    uint16_t *ccc_handle = peripheral_ccc_handle(slot, params);
+    if (ccc_handle) {
+        *ccc_handle = params->ccc_handle;
+        remember_discovered_handles(slot);
+    }
+}
+#endif // IS_ENABLED(CONFIG_ZMK_SPLIT_BLE_CENTRAL_CACHE_HANDLES)
+
+static int split_central_subscribe_to(struct bt_conn *conn, struct peripheral_slot *slot,
+                                      struct bt_gatt_subscribe_params *params,
+                                      uint16_t value_handle, bt_gatt_notify_func_t notify) {
+    params->disc_params = &slot->sub_discover_params;
+    params->end_handle = slot->discover_params.end_handle;
+    params->value_handle = value_handle;
+    params->ccc_handle = 0;
+    params->subscribe = NULL;
+    params->notify = notify;
+    params->value = BT_GATT_CCC_NOTIFY;
+
+#if IS_ENABLED(CONFIG_ZMK_SPLIT_BLE_CENTRAL_CACHE_HANDLES)
+    const uint16_t *ccc_handle = peripheral_ccc_handle(slot, params);
+    if (slot->using_cached_handles && ccc_handle && *ccc_handle) {
+        params->ccc_handle = *ccc_handle;
+        params->subscribe = split_central_cached_subscribe_func;
+    } else {
+        params->subscribe = split_central_discovered_subscribe_func;
+    }
+#endif // IS_ENABLED(CONFIG_ZMK_SPLIT_BLE_CENTRAL_CACHE_HANDLES)
+
+    return split_central_subscribe(conn, params);
+}
+
+#if IS_ENABLED(CONFIG_ZMK_SPLIT_BLE_CENTRAL_BATTERY_LEVEL_FETCHING)
+static void split_central_subscribe_battery_level(struct bt_conn *conn,
+                                                  struct peripheral_slot *slot,
+                                                  uint16_t value_handle) {
+    split_central_subscribe_to(conn, slot, &slot->batt_lvl_subscribe_params, value_handle,
+                               split_central_battery_level_notify_func);
+
+    slot->batt_lvl_read_params.func = split_central_battery_level_read_func;
+    slot->batt_lvl_read_params.handle_count = 1;
+    slot->batt_lvl_read_params.single.handle = value_handle;
+    slot->batt_lvl_read_params.single.offset = 0;
+    bt_gatt_read(conn, &slot->batt_lvl_read_params);
+}
+#endif /* IS_ENABLED(CONFIG_ZMK_SPLIT_BLE_CENTRAL_BATTERY_LEVEL_FETCHING) */
+
+static uint8_t split_central_behaviors_read_func(struct bt_conn *conn, uint8_t err,
+                                                 struct bt_gatt_read_params *params,
+                                                 const void *data, uint16_t length) {
+    struct peripheral_slot *slot = peripheral_slot_for_conn(conn);
+    if (!slot) {
+        LOG_ERR("No peripheral state found for connection");
+        return BT_GATT_ITER_STOP;
+    }
+
+    if (err > 0) {
+        LOG_ERR("Error during reading peripheral behaviors: %u", err);
+        return BT_GATT_ITER_STOP;
+    }
+
+    if (!data) {
+        LOG_DBG("Peripheral has %d behaviors", slot->behavior_count);
+        atomic_set(&slot->behaviors_ready, true);
+        return BT_GATT_ITER_STOP;
+    }
+
+    // Long reads arrive in several chunks, so names may be split across calls.
+    const char *chunk = data;
+    for (uint16_t i = 0; i < length; i++) {
+        if (chunk[i] != '\0') {
+            if (slot->behavior_name_len < sizeof(slot->behavior_name)) {
+                slot->behavior_name[slot->behavior_name_len] = chunk[i];
+            }
+            slot->behavior_name_len = MIN(slot->behavior_name_len + 1, UINT8_MAX);
+            continue;
+        }
+
+        const struct device *behavior = NULL;
+        if (slot->behavior_name_len < sizeof(slot->behavior_name)) {
+            slot->behavior_name[slot->behavior_name_len] = '\0';
+            behavior = zmk_behavior_get_binding(slot->behavior_name);
+        }
+        slot->behavior_name_len = 0;
+
+        if (slot->behavior_count < ARRAY_SIZE(slot->behaviors)) {
+            slot->behaviors[slot->behavior_count++] = behavior;
+        }
+    }
+
+    return BT_GATT_ITER_CONTINUE;
+}
+
+static void split_central_read_behaviors(struct bt_conn *conn, struct peripheral_slot *slot) {
+    slot->behaviors_read_params.func = split_central_behaviors_read_func;
+    slot->behaviors_read_params.handle_count = 1;
+    slot->behaviors_read_params.single.handle = slot->behaviors_handle;
+    slot->behaviors_read_params.single.offset = 0;
+
+    int err = bt_gatt_read(conn, &slot->behaviors_read_params);
+    if (err) {
+        LOG_ERR("Failed to read peripheral behaviors (err %d)", err);
+    }
+}
+
 static uint8_t split_central_chrc_discovery_func(struct bt_conn *conn,
                                                  const struct bt_gatt_attr *attr,
                                                  struct bt_gatt_discover_params *params) {
@@ -413,14 +1187,26 @@ static uint8_t split_central_chrc_discovery_func(struct bt_conn *conn,
     LOG_DBG("[ATTRIBUTE] handle %u", attr->handle);
     const struct bt_uuid *chrc_uuid = ((struct bt_gatt_chrc *)attr->user_data)->uuid;
 
-    if (bt_uuid_cmp(chrc_uuid, BT_UUID_DECLARE_128(ZMK_SPLIT_BT_CHAR_POSITION_STATE_UUID)) == 0) {
+    if (bt_uuid_cmp(chrc_uuid, BT_UUID_DECLARE_128(ZMK_SPLIT_BT_CHAR_POSITION_EVENTS_UUID)) == 0) {
+        LOG_DBG("Found position events characteristic");
+        slot->has_position_events = true;
+        split_central_subscribe_to(conn, slot, &slot->subscribe_params,
+                                   bt_gatt_attr_value_handle(attr),
+                                   split_central_position_events_notify_func);
+    } else if (bt_uuid_cmp(chrc_uuid,
+                           BT_UUID_DECLARE_128(ZMK_SPLIT_BT_CHAR_POSITION_STATE_UUID)) == 0) {
         LOG_DBG("Found position state characteristic");
-        slot->subscribe_params.disc_params = &slot->sub_discover_params;
-        slot->subscribe_params.end_handle = slot->discover_params.end_handle;
-        slot->subscribe_params.value_handle = bt_gatt_attr_value_handle(attr);
-        slot->subscribe_params.notify = split_central_notify_func;
-        slot->subscribe_params.value = BT_GATT_CCC_NOTIFY;
-        split_central_subscribe(conn, &slot->subscribe_params);
+        slot->position_state_handle = bt_gatt_attr_value_handle(attr);
+        split_central_read_num_positions(conn, slot, slot->position_state_handle);
+
+        // The position events characteristic comes first, so if the peripheral has it we are
+        // already subscribed. Only read the current state, in case keys were held on connecting.
+        if (slot->has_position_events) {
+            split_central_resync_position_state(conn, slot);
+        } else {
+            split_central_subscribe_to(conn, slot, &slot->subscribe_params,
+                                       slot->position_state_handle, split_central_notify_func);
+        }
 #if ZMK_KEYMAP_HAS_SENSORS
     } else if (bt_uuid_cmp(chrc_uuid, BT_UUID_DECLARE_128(ZMK_SPLIT_BT_CHAR_SENSOR_STATE_UUID)) ==
                0) {
@@ -428,12 +1214,9 @@ static uint8_t split_central_chrc_discovery_func(struct bt_conn *conn,
         slot->discover_params.start_handle = attr->handle + 2;
         slot->discover_params.type = BT_GATT_DISCOVER_CHARACTERISTIC;
 
-        slot->sensor_subscribe_params.disc_params = &slot->sub_discover_params;
-        slot->sensor_subscribe_params.end_handle = slot->discover_params.end_handle;
-        slot->sensor_subscribe_params.value_handle = bt_gatt_attr_value_handle(attr);
-        slot->sensor_subscribe_params.notify = split_central_sensor_notify_func;
-        slot->sensor_subscribe_params.value = BT_GATT_CCC_NOTIFY;
-        split_central_subscribe(conn, &slot->sensor_subscribe_params);
+        split_central_subscribe_to(conn, slot, &slot->sensor_subscribe_params,
+                                   bt_gatt_attr_value_handle(attr),
+                                   split_central_sensor_notify_func);
 #endif /* ZMK_KEYMAP_HAS_SENSORS */
     } else if (bt_uuid_cmp(chrc_uuid, BT_UUID_DECLARE_128(ZMK_SPLIT_BT_CHAR_RUN_BEHAVIOR_UUID)) ==
                0) {
@@ -441,6 +1224,13 @@ static uint8_t split_central_chrc_discovery_func(struct bt_conn *conn,
         slot->discover_params.uuid = NULL;
         slot->discover_params.start_handle = attr->handle + 2;
         slot->run_behavior_handle = bt_gatt_attr_value_handle(attr);
+    } else if (bt_uuid_cmp(chrc_uuid, BT_UUID_DECLARE_128(ZMK_SPLIT_BT_CHAR_BEHAVIORS_UUID)) == 0) {
+        LOG_DBG("Found behaviors handle");
+        slot->behaviors_handle = bt_gatt_attr_value_handle(attr);
+        split_central_read_behaviors(conn, slot);
+    } else if (bt_uuid_cmp(chrc_uuid, BT_UUID_DECLARE_128(ZMK_SPLIT_BT_CHAR_CLOCK_UUID)) == 0) {
+        LOG_DBG("Found clock handle");
+        slot->clock_handle = bt_gatt_attr_value_handle(attr);
 #if IS_ENABLED(CONFIG_ZMK_SPLIT_PERIPHERAL_HID_INDICATORS)
     } else if (!bt_uuid_cmp(((struct bt_gatt_chrc *)attr->user_data)->uuid,
                             BT_UUID_DECLARE_128(ZMK_SPLIT_BT_UPDATE_HID_INDICATORS_UUID))) {
@@ -451,22 +1241,14 @@ static uint8_t split_central_chrc_discovery_func(struct bt_conn *conn,
     } else if (!bt_uuid_cmp(((struct bt_gatt_chrc *)attr->user_data)->uuid,
                             BT_UUID_BAS_BATTERY_LEVEL)) {
         LOG_DBG("Found battery level characteristics");
-        slot->batt_lvl_subscribe_params.disc_params = &slot->sub_discover_params;
-        slot->batt_lvl_subscribe_params.end_handle = slot->discover_params.end_handle;
-        slot->batt_lvl_subscribe_params.value_handle = bt_gatt_attr_value_handle(attr);
-        slot->batt_lvl_subscribe_params.notify = split_central_battery_level_notify_func;
-        slot->batt_lvl_subscribe_params.value = BT_GATT_CCC_NOTIFY;
-        split_central_subscribe(conn, &slot->batt_lvl_subscribe_params);
-
-        slot->batt_lvl_read_params.func = split_central_battery_level_read_func;
-        slot->batt_lvl_read_params.handle_count = 1;
-        slot->batt_lvl_read_params.single.handle = bt_gatt_attr_value_handle(attr);
-        slot->batt_lvl_read_params.single.offset = 0;
-        bt_gatt_read(conn, &slot->batt_lvl_read_params);
+        split_central_subscribe_battery_level(conn, slot, bt_gatt_attr_value_handle(attr));
 #endif /* IS_ENABLED(CONFIG_ZMK_SPLIT_BLE_CENTRAL_BATTERY_LEVEL_FETCHING) */
     }
 
-    bool subscribed = slot->run_behavior_handle && slot->subscribe_params.value_handle;
+    // Peripherals running older firmware have no clock characteristic, in which case discovery
+    // simply runs until all characteristics have been seen.
+    bool subscribed =
+        slot->run_behavior_handle && slot->subscribe_params.value_handle && slot->clock_handle;
 
 #if ZMK_KEYMAP_HAS_SENSORS
     subscribed = subscribed && slot->sensor_subscribe_params.value_handle;
@@ -479,6 +1261,25 @@ static uint8_t split_central_chrc_discovery_func(struct bt_conn *conn,
     subscribed = subscribed && slot->batt_lvl_subscribe_params.value_handle;
 #endif /* IS_ENABLED(CONFIG_ZMK_SPLIT_BLE_CENTRAL_BATTERY_LEVEL_FETCHING) */
 
+#if IS_ENABLED(CONFIG_ZMK_SPLIT_BLE_CENTRAL_CACHE_HANDLES)
+    slot->handles.position_events =
+        slot->has_position_events ? slot->subscribe_params.value_handle : 0;
+    slot->handles.position_state = slot->position_state_handle;
+    slot->handles.run_behavior = slot->run_behavior_handle;
+    slot->handles.behaviors = slot->behaviors_handle;
+    slot->handles.clock = slot->clock_handle;
+#if ZMK_KEYMAP_HAS_SENSORS
+    slot->handles.sensor_state = slot->sensor_subscribe_params.value_handle;
+#endif /* ZMK_KEYMAP_HAS_SENSORS */
+#if IS_ENABLED(CONFIG_ZMK_SPLIT_PERIPHERAL_HID_INDICATORS)
+    slot->handles.update_hid_indicators = slot->update_hid_indicators;
+#endif // IS_ENABLED(CONFIG_ZMK_SPLIT_PERIPHERAL_HID_INDICATORS)
+#if IS_ENABLED(CONFIG_ZMK_SPLIT_BLE_CENTRAL_BATTERY_LEVEL_FETCHING)
+    slot->handles.battery_level = slot->batt_lvl_subscribe_params.value_handle;
+#endif /* IS_ENABLED(CONFIG_ZMK_SPLIT_BLE_CENTRAL_BATTERY_LEVEL_FETCHING) */
+    remember_discovered_handles(slot);
+#endif // IS_ENABLED(CONFIG_ZMK_SPLIT_BLE_CENTRAL_CACHE_HANDLES)
+
     return subscribed ? BT_GATT_ITER_STOP : BT_GATT_ITER_CONTINUE;
 }
 
@@ -517,6 +1318,58 @@ static uint8_t split_central_service_discovery_func(struct bt_conn *conn,
     return BT_GATT_ITER_STOP;
 }
 
+#if IS_ENABLED(CONFIG_ZMK_SPLIT_BLE_CENTRAL_CACHE_HANDLES)
+
+// Sets up the connection with the handles found when previously connected to the peripheral,
+// instead of discovering them again.
+static int split_central_use_cached_handles(struct bt_conn *conn, struct peripheral_slot *slot) {
+    const struct peripheral_handles *handles = &cached_handles[slot - peripherals];
+    if (!peripheral_handles_complete(handles)) {
+        return -ENOENT;
+    }
+
+    LOG_DBG("Using cached handles of peripheral %d", slot - peripherals);
+    slot->handles = *handles;
+    slot->using_cached_handles = true;
+    slot->discover_params.end_handle = 0xffff;
+
+    slot->num_positions = MIN(handles->num_positions, POSITION_STATE_DATA_LEN * 8);
+    slot->position_state_handle = handles->position_state;
+    slot->run_behavior_handle = handles->run_behavior;
+    slot->clock_handle = handles->clock;
+#if IS_ENABLED(CONFIG_ZMK_SPLIT_PERIPHERAL_HID_INDICATORS)
+    slot->update_hid_indicators = handles->update_hid_indicators;
+#endif // IS_ENABLED(CONFIG_ZMK_SPLIT_PERIPHERAL_HID_INDICATORS)
+
+    if (handles->position_events) {
+        slot->has_position_events = true;
+        split_central_subscribe_to(conn, slot, &slot->subscribe_params, handles->position_events,
+                                   split_central_position_events_notify_func);
+        split_central_resync_position_state(conn, slot);
+    } else {
+        split_central_subscribe_to(conn, slot, &slot->subscribe_params, handles->position_state,
+                                   split_central_notify_func);
+    }
+
+#if ZMK_KEYMAP_HAS_SENSORS
+    split_central_subscribe_to(conn, slot, &slot->sensor_subscribe_params, handles->sensor_state,
+                               split_central_sensor_notify_func);
+#endif /* ZMK_KEYMAP_HAS_SENSORS */
+
+#if IS_ENABLED(CONFIG_ZMK_SPLIT_BLE_CENTRAL_BATTERY_LEVEL_FETCHING)
+    split_central_subscribe_battery_level(conn, slot, handles->battery_level);
+#endif /* IS_ENABLED(CONFIG_ZMK_SPLIT_BLE_CENTRAL_BATTERY_LEVEL_FETCHING) */
+
+    if (handles->behaviors) {
+        slot->behaviors_handle = handles->behaviors;
+        split_central_read_behaviors(conn, slot);
+    }
+
+    return 0;
+}
+
+#endif // IS_ENABLED(CONFIG_ZMK_SPLIT_BLE_CENTRAL_CACHE_HANDLES)
+
 static void split_central_process_connection(struct bt_conn *conn) {
     int err;
 
@@ -528,6 +1381,13 @@ static void split_central_process_connection(struct bt_conn *conn) {
         return;
     }
 
+#if IS_ENABLED(CONFIG_ZMK_SPLIT_BLE_CENTRAL_CACHE_HANDLES)
+    if (!slot->subscribe_params.value_handle && split_central_use_cached_handles(conn, slot) == 0) {
+        start_scanning();
+        return;
+    }
+#endif // IS_ENABLED(CONFIG_ZMK_SPLIT_BLE_CENTRAL_CACHE_HANDLES)
+
     if (!slot->subscribe_params.value_handle) {
         slot->discover_params.uuid = &split_service_uuid.uuid;
         slot->discover_params.func = split_central_service_discovery_func;
@@ -711,6 +1571,10 @@ static void split_central_connected(struct bt_conn *conn, uint8_t conn_err) {
     LOG_DBG("Connected: %s", addr);
 
     confirm_peripheral_slot_conn(conn);
+    k_work_schedule(&split_central_clock_sync_work, K_NO_WAIT);
+#if IS_ENABLED(CONFIG_ZMK_SPLIT_STATS)
+    zmk_split_stats_link_up(peripheral_slot_index_for_conn(conn), split_central_read_rssi);
+#endif // IS_ENABLED(CONFIG_ZMK_SPLIT_STATS)
     split_central_process_connection(conn);
 }
 
@@ -738,9 +1602,22 @@ static void split_central_disconnected(struct bt_conn *conn, uint8_t reason) {
     start_scanning();
 }
 
+static void split_central_le_param_updated(struct bt_conn *conn, uint16_t interval,
+                                           uint16_t latency, uint16_t timeout) {
+    int idx = peripheral_slot_index_for_conn(conn);
+    if (idx < 0) {
+        return;
+    }
+
+    LOG_DBG("Peripheral %d connection parameters: interval %d, latency %d, timeout %d", idx,
+            interval, latency, timeout);
+    zmk_split_stats_inc(idx, ZMK_SPLIT_STAT_CONN_PARAM_UPDATE);
+}
+
 static struct bt_conn_cb conn_callbacks = {
     .connected = split_central_connected,
     .disconnected = split_central_disconnected,
+    .le_param_updated = split_central_le_param_updated,
 };
 
 K_THREAD_STACK_DEFINE(split_central_split_run_q_stack,
@@ -750,6 +1627,10 @@ struct k_work_q split_central_split_run_q;
 
 struct zmk_split_run_behavior_payload_wrapper {
     uint8_t source;
+    // Local behavior being invoked, used to find its index on the peripheral.
+    const struct device *behavior;
+    // Full key position, since the legacy payload only has room for eight bits of it.
+    uint32_t position;
     struct zmk_split_run_behavior_payload payload;
 };
 
@@ -757,30 +1638,112 @@ K_MSGQ_DEFINE(zmk_split_central_split_run_msgq,
               sizeof(struct zmk_split_run_behavior_payload_wrapper),
               CONFIG_ZMK_SPLIT_BLE_CENTRAL_SPLIT_RUN_QUEUE_SIZE, 4);
 
+#define RUN_BEHAVIOR_BATCH_SIZE 8
+
+// Indexed behavior invocations for a single peripheral, sent together in one write.
+struct run_behavior_batch {
+    uint8_t source;
+    uint8_t count;
+    uint8_t max_count;
+    struct zmk_split_run_behavior_indexed runs[RUN_BEHAVIOR_BATCH_SIZE];
+};
+
+static int peripheral_behavior_index(const struct peripheral_slot *slot,
+                                     const struct device *behavior) {
+    if (!atomic_get(&slot->behaviors_ready) || !behavior) {
+        return -ENOENT;
+    }
+
+    for (int i = 0; i < slot->behavior_count; i++) {
+        if (slot->behaviors[i] == behavior) {
+            return i;
+        }
+    }
+
+    return -ENOENT;
+}
+
+static void split_central_flush_run_behaviors(struct run_behavior_batch *batch) {
+    if (batch->count == 0) {
+        return;
+    }
+
+    struct peripheral_slot *slot = &peripherals[batch->source];
+    int err = bt_gatt_write_without_response(slot->conn, slot->behaviors_handle, batch->runs,
+                                             batch->count * sizeof(batch->runs[0]), true);
+    if (err) {
+        LOG_ERR("Failed to write the behaviors characteristic (err %d)", err);
+    }
+    zmk_split_stats_inc(batch->source, err ? ZMK_SPLIT_STAT_TX_ERROR : ZMK_SPLIT_STAT_TX);
+
+    batch->count = 0;
+}
+
 void split_central_split_run_callback(struct k_work *work) {
     struct zmk_split_run_behavior_payload_wrapper payload_wrapper;
+    static struct run_behavior_batch batch;
 
     LOG_DBG("");
 
     while (k_msgq_get(&zmk_split_central_split_run_msgq, &payload_wrapper, K_NO_WAIT) == 0) {
-        if (peripherals[payload_wrapper.source].state != PERIPHERAL_SLOT_STATE_CONNECTED) {
+        struct peripheral_slot *slot = &peripherals[payload_wrapper.source];
+
+        if (slot->state != PERIPHERAL_SLOT_STATE_CONNECTED) {
             LOG_ERR("Source not connected");
             continue;
         }
-        if (!peripherals[payload_wrapper.source].run_behavior_handle) {
+
+        if (batch.count > 0 &&
+            (batch.source != payload_wrapper.source || batch.count >= batch.max_count)) {
+            split_central_flush_run_behaviors(&batch);
+        }
+
+        const int index = peripheral_behavior_index(slot, payload_wrapper.behavior);
+        if (index >= 0) {
+            const struct zmk_split_run_behavior_data *data = &payload_wrapper.payload.data;
+
+            if (batch.count == 0) {
+                batch.source = payload_wrapper.source;
+                batch.max_count = CLAMP((bt_gatt_get_mtu(slot->conn) - 3) / sizeof(batch.runs[0]),
+                                        1, ARRAY_SIZE(batch.runs));
+            }
+
+            batch.runs[batch.count++] = (struct zmk_split_run_behavior_indexed){
+                .behavior = index | (data->state ? ZMK_SPLIT_RUN_BEHAVIOR_PRESSED : 0),
+                .position = payload_wrapper.position,
+                .param1 = data->param1,
+                .param2 = data->param2,
+            };
+            continue;
+        }
+
+        // Keep invocations in order when falling back to invoking by name.
+        split_central_flush_run_behaviors(&batch);
+
+        if (!slot->run_behavior_handle) {
             LOG_ERR("Run behavior handle not found");
             continue;
         }
 
+        if (payload_wrapper.position > UINT8_MAX) {
+            LOG_ERR("Position %d of %s does not fit the run behavior characteristic",
+                    payload_wrapper.position, payload_wrapper.payload.behavior_dev);
+            zmk_split_stats_inc(payload_wrapper.source, ZMK_SPLIT_STAT_TX_ERROR);
+            continue;
+        }
+
         int err = bt_gatt_write_without_response(
-            peripherals[payload_wrapper.source].conn,
-            peripherals[payload_wrapper.source].run_behavior_handle, &payload_wrapper.payload,
+            slot->conn, slot->run_behavior_handle, &payload_wrapper.payload,
             sizeof(struct zmk_split_run_behavior_payload), true);
 
         if (err) {
             LOG_ERR("Failed to write the behavior characteristic (err %d)", err);
         }
+        zmk_split_stats_inc(payload_wrapper.source,
+                            err ? ZMK_SPLIT_STAT_TX_ERROR : ZMK_SPLIT_STAT_TX);
     }
+
+    split_central_flush_run_behaviors(&batch);
 }
 
 K_WORK_DEFINE(split_central_split_run_work, split_central_split_run_callback);
@@ -796,6 +1759,7 @@ split_bt_invoke_behavior_payload(struct zmk_split_run_behavior_payload_wrapper p
             LOG_WRN("Consumer message queue full, popping first message and queueing again");
             struct zmk_split_run_behavior_payload_wrapper discarded_report;
             k_msgq_get(&zmk_split_central_split_run_msgq, &discarded_report, K_NO_WAIT);
+            zmk_split_stats_inc(discarded_report.source, ZMK_SPLIT_STAT_QUEUE_DROP);
             return split_bt_invoke_behavior_payload(payload_wrapper);
         }
         default:
@@ -820,11 +1784,16 @@ int zmk_split_bt_invoke_behavior(uint8_t source, struct zmk_behavior_binding *bi
     const size_t payload_dev_size = sizeof(payload.behavior_dev);
     if (strlcpy(payload.behavior_dev, binding->behavior_dev, payload_dev_size) >=
         payload_dev_size) {
-        LOG_ERR("Truncated behavior label %s to %s before invoking peripheral behavior",
+        LOG_WRN("Truncated behavior label %s to %s in case the peripheral is invoked by name",
                 binding->behavior_dev, payload.behavior_dev);
     }
 
-    struct zmk_split_run_behavior_payload_wrapper wrapper = {.source = source, .payload = payload};
+    struct zmk_split_run_behavior_payload_wrapper wrapper = {
+        .source = source,
+        .behavior = zmk_behavior_get_binding(binding->behavior_dev),
+        .position = event.position,
+        .payload = payload,
+    };
     return split_bt_invoke_behavior_payload(wrapper);
 }
 
@@ -853,6 +1822,7 @@ static void split_central_update_indicators_callback(struct k_work *work) {
         if (err) {
             LOG_ERR("Failed to write HID indicator characteristic (err %d)", err);
         }
+        zmk_split_stats_inc(i, err ? ZMK_SPLIT_STAT_TX_ERROR : ZMK_SPLIT_STAT_TX);
     }
 }
 
@@ -865,12 +1835,67 @@ int zmk_split_bt_update_hid_indicator(zmk_hid_indicators_t indicators) {
 
 #endif // IS_ENABLED(CONFIG_ZMK_SPLIT_PERIPHERAL_HID_INDICATORS)
 
+static const struct zmk_split_transport_central_api split_bt_central_api = {
+    .invoke_behavior = zmk_split_bt_invoke_behavior,
+#if IS_ENABLED(CONFIG_ZMK_SPLIT_PERIPHERAL_HID_INDICATORS)
+    .update_hid_indicator = zmk_split_bt_update_hid_indicator,
+#endif // IS_ENABLED(CONFIG_ZMK_SPLIT_PERIPHERAL_HID_INDICATORS)
+    .position_events_drained = split_central_position_events_drained,
+};
+
+ZMK_SPLIT_TRANSPORT_CENTRAL_REGISTER(ble, &split_bt_central_api);
+
+#if IS_ENABLED(CONFIG_ZMK_SPLIT_BLE_CENTRAL_CACHE_HANDLES) && IS_ENABLED(CONFIG_SETTINGS)
+
+static int cached_handles_settings_load_cb(const char *name, size_t len, settings_read_cb read_cb,
+                                           void *cb_arg, void *param) {
+    char *endptr;
+    const unsigned long index = strtoul(name, &endptr, 10);
+    if (*endptr != '\0' || index >= ZMK_SPLIT_BLE_PERIPHERAL_COUNT) {
+        return -ENOENT;
+    }
+
+    // Handles saved by firmware with a different layout are discovered again.
+    if (len != sizeof(cached_handles[index])) {
+        return 0;
+    }
+
+    int rc = read_cb(cb_arg, &cached_handles[index], sizeof(cached_handles[index]));
+    return MIN(rc, 0);
+}
+
+static int split_central_load_cached_handles(void) {
+    settings_subsys_init();
+
+#if IS_ENABLED(CONFIG_ZMK_BLE_CLEAR_BONDS_ON_START)
+    // The handles belong to the bonds that are being cleared.
+    for (int i = 0; i < ZMK_SPLIT_BLE_PERIPHERAL_COUNT; i++) {
+        char setting_name[32];
+        snprintf(setting_name, sizeof(setting_name), "split/central/handles/%d", i);
+        settings_delete(setting_name);
+    }
+    return 0;
+#else
+    return settings_load_subtree_direct("split/central/handles", cached_handles_settings_load_cb,
+                                        NULL);
+#endif // IS_ENABLED(CONFIG_ZMK_BLE_CLEAR_BONDS_ON_START)
+}
+
+#endif // IS_ENABLED(CONFIG_ZMK_SPLIT_BLE_CENTRAL_CACHE_HANDLES) && IS_ENABLED(CONFIG_SETTINGS)
+
 static int zmk_split_bt_central_init(void) {
     k_work_queue_start(&split_central_split_run_q, split_central_split_run_q_stack,
                        K_THREAD_STACK_SIZEOF(split_central_split_run_q_stack),
                        CONFIG_ZMK_BLE_THREAD_PRIORITY, NULL);
     bt_conn_cb_register(&conn_callbacks);
 
+#if IS_ENABLED(CONFIG_ZMK_SPLIT_BLE_CENTRAL_CACHE_HANDLES) && IS_ENABLED(CONFIG_SETTINGS)
+    int err = split_central_load_cached_handles();
+    if (err) {
+        LOG_ERR("Failed to load the cached peripheral handles (err %d)", err);
+    }
+#endif // IS_ENABLED(CONFIG_ZMK_SPLIT_BLE_CENTRAL_CACHE_HANDLES) && IS_ENABLED(CONFIG_SETTINGS)
+
     return IS_ENABLED(CONFIG_ZMK_BLE_CLEAR_BONDS_ON_START) ? 0 : start_scanning();
 }
 
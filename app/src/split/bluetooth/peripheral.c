@@ -19,6 +19,7 @@
 #include <zephyr/bluetooth/uuid.h>
 #include <zephyr/bluetooth/gatt.h>
 #include <zephyr/bluetooth/hci_types.h>
+#include <zephyr/sys/byteorder.h>
 
 #if IS_ENABLED(CONFIG_SETTINGS)
 
@@ -34,6 +35,7 @@ LOG_MODULE_DECLARE(zmk, CONFIG_ZMK_LOG_LEVEL);
 #include <zmk/events/split_peripheral_status_changed.h>
 #include <zmk/ble.h>
 #include <zmk/split/bluetooth/uuid.h>
+#include <zmk/split/stats.h>
 
 static const struct bt_data zmk_ble_ad[] = {
     BT_DATA_BYTES(BT_DATA_FLAGS, (BT_LE_AD_GENERAL | BT_LE_AD_NO_BREDR)),
@@ -80,12 +82,50 @@ static void advertising_cb(struct k_work *work) {
 
 K_WORK_DEFINE(advertising_work, advertising_cb);
 
+#if IS_ENABLED(CONFIG_ZMK_SPLIT_STATS)
+
+static struct bt_conn *central_conn;
+
+// The host stack has no API for the RSSI of a connection, so ask the controller directly.
+static void read_rssi(uint8_t link) {
+    uint16_t handle;
+    if (!central_conn || bt_hci_get_conn_handle(central_conn, &handle) < 0) {
+        return;
+    }
+
+    struct net_buf *buf =
+        bt_hci_cmd_create(BT_HCI_OP_READ_RSSI, sizeof(struct bt_hci_cp_read_rssi));
+    if (buf) {
+        struct bt_hci_cp_read_rssi *cp = net_buf_add(buf, sizeof(*cp));
+        cp->handle = sys_cpu_to_le16(handle);
+
+        struct net_buf *rsp;
+        int err = bt_hci_cmd_send_sync(BT_HCI_OP_READ_RSSI, buf, &rsp);
+        if (err) {
+            LOG_DBG("Failed to read the RSSI (err %d)", err);
+        } else {
+            const struct bt_hci_rp_read_rssi *rp = (const void *)rsp->data;
+            zmk_split_stats_set_rssi(link, rp->rssi);
+            net_buf_unref(rsp);
+        }
+    }
+}
+
+#endif // IS_ENABLED(CONFIG_ZMK_SPLIT_STATS)
+
 static void connected(struct bt_conn *conn, uint8_t err) {
     is_connected = (err == 0);
 
     raise_zmk_split_peripheral_status_changed(
         (struct zmk_split_peripheral_status_changed){.connected = is_connected});
 
+#if IS_ENABLED(CONFIG_ZMK_SPLIT_STATS)
+    if (is_connected) {
+        central_conn = bt_conn_ref(conn);
+        zmk_split_stats_link_up(ZMK_SPLIT_STATS_CENTRAL_LINK, read_rssi);
+    }
+#endif // IS_ENABLED(CONFIG_ZMK_SPLIT_STATS)
+
     if (err == BT_HCI_ERR_ADV_TIMEOUT) {
         low_duty_advertising = true;
         k_work_submit(&advertising_work);
@@ -101,6 +141,14 @@ static void disconnected(struct bt_conn *conn, uint8_t reason) {
 
     is_connected = false;
 
+    zmk_split_stats_link_down(ZMK_SPLIT_STATS_CENTRAL_LINK);
+#if IS_ENABLED(CONFIG_ZMK_SPLIT_STATS)
+    if (central_conn) {
+        bt_conn_unref(central_conn);
+        central_conn = NULL;
+    }
+#endif // IS_ENABLED(CONFIG_ZMK_SPLIT_STATS)
+
     raise_zmk_split_peripheral_status_changed(
         (struct zmk_split_peripheral_status_changed){.connected = is_connected});
 
@@ -127,6 +175,7 @@ static void le_param_updated(struct bt_conn *conn, uint16_t interval, uint16_t l
     bt_addr_le_to_str(bt_conn_get_dst(conn), addr, sizeof(addr));
 
     LOG_DBG("%s: interval %d latency %d timeout %d", addr, interval, latency, timeout);
+    zmk_split_stats_inc(ZMK_SPLIT_STATS_CENTRAL_LINK, ZMK_SPLIT_STAT_CONN_PARAM_UPDATE);
 }
 
 static struct bt_conn_cb conn_callbacks = {
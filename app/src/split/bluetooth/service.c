@@ -6,6 +6,7 @@
 
 #include <zephyr/drivers/sensor.h>
 #include <zephyr/types.h>
+#include <zephyr/sys/atomic.h>
 #include <zephyr/sys/util.h>
 #include <zephyr/init.h>
 
@@ -13,6 +14,7 @@
 
 LOG_MODULE_DECLARE(zmk, CONFIG_ZMK_LOG_LEVEL);
 
+#include <zephyr/bluetooth/conn.h>
 #include <zephyr/bluetooth/gatt.h>
 #include <zephyr/bluetooth/uuid.h>
 
@@ -21,6 +23,8 @@ LOG_MODULE_DECLARE(zmk, CONFIG_ZMK_LOG_LEVEL);
 #include <zmk/matrix.h>
 #include <zmk/split/bluetooth/uuid.h>
 #include <zmk/split/bluetooth/service.h>
+#include <zmk/split/stats.h>
+#include <zmk/split/transport.h>
 
 #if IS_ENABLED(CONFIG_ZMK_SPLIT_PERIPHERAL_HID_INDICATORS)
 #include <zmk/events/hid_indicators_changed.h>
@@ -43,11 +47,31 @@ static void split_svc_sensor_state_ccc(const struct bt_gatt_attr *attr, uint16_t
 }
 #endif /* ZMK_KEYMAP_HAS_SENSORS */
 
-#define POS_STATE_LEN 16
+// Older centrals always read 16 bytes of position state, so never send less than that.
+#define POS_STATE_LEN MAX(16, DIV_ROUND_UP(ZMK_KEYMAP_LEN, 8))
 
-static uint8_t num_of_positions = ZMK_KEYMAP_LEN;
+BUILD_ASSERT(ZMK_KEYMAP_LEN <= ZMK_SPLIT_POSITION_EVENT_MAX_POSITIONS,
+             "The split protocol supports at most 32768 key positions");
+
+// Indexes of the characteristic declarations in split_svc, used to send notifications.
+// bt_gatt_notify() sends the value attribute that follows a declaration.
+#define POSITION_EVENTS_ATTR_INDEX 1
+#define POSITION_STATE_ATTR_INDEX 4
+#define SENSOR_STATE_ATTR_INDEX 10
+
+// Stay within the default ATT MTU, so notifications never have to be split up.
+#define POSITION_EVENTS_PER_NOTIFICATION                                                           \
+    ((BT_ATT_DEFAULT_LE_MTU - 3 - sizeof(struct zmk_split_position_events_header)) /              \
+     sizeof(struct zmk_split_position_event))
+
+static uint16_t num_of_positions = ZMK_KEYMAP_LEN;
 static uint8_t position_state[POS_STATE_LEN];
 
+// Centrals running older firmware only subscribe to the position state bitmap, newer ones only
+// to the position events. Only the subscribed characteristic needs to be sent.
+static bool position_state_subscribed;
+static bool position_events_subscribed;
+
 static struct zmk_split_run_behavior_payload behavior_run_payload;
 
 static ssize_t split_svc_pos_state(struct bt_conn *conn, const struct bt_gatt_attr *attrs,
@@ -56,6 +80,36 @@ static ssize_t split_svc_pos_state(struct bt_conn *conn, const struct bt_gatt_at
                              sizeof(position_state));
 }
 
+static void run_behavior(char *behavior_dev, uint16_t position, bool pressed, uint32_t param1,
+                         uint32_t param2) {
+    struct zmk_behavior_binding binding = {
+        .param1 = param1,
+        .param2 = param2,
+        .behavior_dev = behavior_dev,
+    };
+    LOG_DBG("%s with params %d %d: pressed? %d", binding.behavior_dev, binding.param1,
+            binding.param2, pressed);
+    struct zmk_behavior_binding_event event = {.position = position, .timestamp = k_uptime_get()};
+    int err;
+    if (pressed) {
+        err = behavior_keymap_binding_pressed(&binding, event);
+    } else {
+        err = behavior_keymap_binding_released(&binding, event);
+    }
+
+    if (err) {
+        LOG_ERR("Failed to invoke behavior %s: %d", binding.behavior_dev, err);
+    }
+}
+
+static void count_notify_result(int err) {
+    if (err) {
+        LOG_DBG("Error notifying %d", err);
+    }
+    zmk_split_stats_inc(ZMK_SPLIT_STATS_CENTRAL_LINK,
+                        err ? ZMK_SPLIT_STAT_TX_ERROR : ZMK_SPLIT_STAT_TX);
+}
+
 static ssize_t split_svc_run_behavior(struct bt_conn *conn, const struct bt_gatt_attr *attrs,
                                       const void *buf, uint16_t len, uint16_t offset,
                                       uint8_t flags) {
@@ -69,6 +123,7 @@ static ssize_t split_svc_run_behavior(struct bt_conn *conn, const struct bt_gatt
     }
 
     memcpy(payload + offset, buf, len);
+    zmk_split_stats_inc(ZMK_SPLIT_STATS_CENTRAL_LINK, ZMK_SPLIT_STAT_RX);
 
     // We run if:
     // 1: We've gotten all the position/state/param data.
@@ -77,25 +132,73 @@ static ssize_t split_svc_run_behavior(struct bt_conn *conn, const struct bt_gatt
         offsetof(struct zmk_split_run_behavior_payload, behavior_dev);
     if ((end_addr > sizeof(struct zmk_split_run_behavior_data)) &&
         payload->behavior_dev[end_addr - behavior_dev_offset - 1] == '\0') {
-        struct zmk_behavior_binding binding = {
-            .param1 = payload->data.param1,
-            .param2 = payload->data.param2,
-            .behavior_dev = payload->behavior_dev,
-        };
-        LOG_DBG("%s with params %d %d: pressed? %d", binding.behavior_dev, binding.param1,
-                binding.param2, payload->data.state);
-        struct zmk_behavior_binding_event event = {.position = payload->data.position,
-                                                   .timestamp = k_uptime_get()};
-        int err;
-        if (payload->data.state > 0) {
-            err = behavior_keymap_binding_pressed(&binding, event);
-        } else {
-            err = behavior_keymap_binding_released(&binding, event);
+        run_behavior(payload->behavior_dev, payload->data.position, payload->data.state > 0,
+                     payload->data.param1, payload->data.param2);
+    }
+
+    return len;
+}
+
+// The behavior table is the names of all behaviors, each followed by a null terminator. The
+// central reads it once after connecting, and from then on invokes behaviors by their index in the
+// table instead of by name.
+static ssize_t split_svc_behaviors_read(struct bt_conn *conn, const struct bt_gatt_attr *attrs,
+                                        void *buf, uint16_t len, uint16_t offset) {
+    uint16_t table_offset = 0;
+    uint16_t copied = 0;
+
+    STRUCT_SECTION_FOREACH(zmk_behavior_ref, item) {
+        const char *name = item->device->name;
+        const uint16_t size = strlen(name) + 1;
+
+        if (table_offset + size > offset && copied < len) {
+            const uint16_t start = offset > table_offset ? offset - table_offset : 0;
+            const uint16_t count = MIN(size - start, len - copied);
+            memcpy((uint8_t *)buf + copied, name + start, count);
+            copied += count;
         }
 
-        if (err) {
-            LOG_ERR("Failed to invoke behavior %s: %d", binding.behavior_dev, err);
+        table_offset += size;
+    }
+
+    if (offset > table_offset) {
+        return BT_GATT_ERR(BT_ATT_ERR_INVALID_OFFSET);
+    }
+
+    return copied;
+}
+
+static ssize_t split_svc_behaviors_write(struct bt_conn *conn, const struct bt_gatt_attr *attrs,
+                                         const void *buf, uint16_t len, uint16_t offset,
+                                         uint8_t flags) {
+    if (offset != 0) {
+        return BT_GATT_ERR(BT_ATT_ERR_INVALID_OFFSET);
+    }
+
+    if (len % sizeof(struct zmk_split_run_behavior_indexed) != 0) {
+        return BT_GATT_ERR(BT_ATT_ERR_INVALID_ATTRIBUTE_LEN);
+    }
+
+    zmk_split_stats_inc(ZMK_SPLIT_STATS_CENTRAL_LINK, ZMK_SPLIT_STAT_RX);
+
+    ptrdiff_t behavior_count;
+    STRUCT_SECTION_COUNT(zmk_behavior_ref, &behavior_count);
+
+    for (uint16_t i = 0; i < len; i += sizeof(struct zmk_split_run_behavior_indexed)) {
+        struct zmk_split_run_behavior_indexed run;
+        memcpy(&run, (const uint8_t *)buf + i, sizeof(run));
+
+        const uint16_t index = run.behavior & ~ZMK_SPLIT_RUN_BEHAVIOR_PRESSED;
+        if (index >= behavior_count) {
+            LOG_ERR("Invalid behavior index %d", index);
+            continue;
         }
+
+        const struct zmk_behavior_ref *ref;
+        STRUCT_SECTION_GET(zmk_behavior_ref, index, &ref);
+
+        run_behavior((char *)ref->device->name, run.position,
+                     (run.behavior & ZMK_SPLIT_RUN_BEHAVIOR_PRESSED) != 0, run.param1, run.param2);
     }
 
     return len;
@@ -103,11 +206,31 @@ static ssize_t split_svc_run_behavior(struct bt_conn *conn, const struct bt_gatt
 
 static ssize_t split_svc_num_of_positions(struct bt_conn *conn, const struct bt_gatt_attr *attrs,
                                           void *buf, uint16_t len, uint16_t offset) {
-    return bt_gatt_attr_read(conn, attrs, buf, len, offset, attrs->user_data, sizeof(uint8_t));
+    return bt_gatt_attr_read(conn, attrs, buf, len, offset, attrs->user_data, sizeof(uint16_t));
+}
+
+// Lets the central estimate the offset between its clock and ours, by timing how long the read
+// takes to complete.
+static ssize_t split_svc_clock(struct bt_conn *conn, const struct bt_gatt_attr *attrs, void *buf,
+                               uint16_t len, uint16_t offset) {
+    const int64_t now = k_uptime_get();
+    return bt_gatt_attr_read(conn, attrs, buf, len, offset, &now, sizeof(now));
 }
 
 static void split_svc_pos_state_ccc(const struct bt_gatt_attr *attr, uint16_t value) {
     LOG_DBG("value %d", value);
+    position_state_subscribed = value == BT_GATT_CCC_NOTIFY;
+}
+
+static void flush_buffered_position_events(void);
+
+static void split_svc_pos_events_ccc(const struct bt_gatt_attr *attr, uint16_t value) {
+    LOG_DBG("value %d", value);
+    position_events_subscribed = value == BT_GATT_CCC_NOTIFY;
+
+    if (position_events_subscribed) {
+        flush_buffered_position_events();
+    }
 }
 
 #if IS_ENABLED(CONFIG_ZMK_SPLIT_PERIPHERAL_HID_INDICATORS)
@@ -130,6 +253,7 @@ static ssize_t split_svc_update_indicators(struct bt_conn *conn, const struct bt
     }
 
     memcpy((uint8_t *)&hid_indicators + offset, buf, len);
+    zmk_split_stats_inc(ZMK_SPLIT_STATS_CENTRAL_LINK, ZMK_SPLIT_STAT_RX);
 
     k_work_submit(&split_svc_update_indicators_work);
 
@@ -140,6 +264,9 @@ static ssize_t split_svc_update_indicators(struct bt_conn *conn, const struct bt
 
 BT_GATT_SERVICE_DEFINE(
     split_svc, BT_GATT_PRIMARY_SERVICE(BT_UUID_DECLARE_128(ZMK_SPLIT_BT_SERVICE_UUID)),
+    BT_GATT_CHARACTERISTIC(BT_UUID_DECLARE_128(ZMK_SPLIT_BT_CHAR_POSITION_EVENTS_UUID),
+                           BT_GATT_CHRC_NOTIFY, BT_GATT_PERM_READ_ENCRYPT, NULL, NULL, NULL),
+    BT_GATT_CCC(split_svc_pos_events_ccc, BT_GATT_PERM_READ_ENCRYPT | BT_GATT_PERM_WRITE_ENCRYPT),
     BT_GATT_CHARACTERISTIC(BT_UUID_DECLARE_128(ZMK_SPLIT_BT_CHAR_POSITION_STATE_UUID),
                            BT_GATT_CHRC_READ | BT_GATT_CHRC_NOTIFY, BT_GATT_PERM_READ_ENCRYPT,
                            split_svc_pos_state, NULL, &position_state),
@@ -160,6 +287,12 @@ BT_GATT_SERVICE_DEFINE(
                            BT_GATT_CHRC_WRITE_WITHOUT_RESP, BT_GATT_PERM_WRITE_ENCRYPT, NULL,
                            split_svc_update_indicators, NULL),
 #endif // IS_ENABLED(CONFIG_ZMK_SPLIT_PERIPHERAL_HID_INDICATORS)
+    BT_GATT_CHARACTERISTIC(BT_UUID_DECLARE_128(ZMK_SPLIT_BT_CHAR_BEHAVIORS_UUID),
+                           BT_GATT_CHRC_READ | BT_GATT_CHRC_WRITE_WITHOUT_RESP,
+                           BT_GATT_PERM_READ_ENCRYPT | BT_GATT_PERM_WRITE_ENCRYPT,
+                           split_svc_behaviors_read, split_svc_behaviors_write, NULL),
+    BT_GATT_CHARACTERISTIC(BT_UUID_DECLARE_128(ZMK_SPLIT_BT_CHAR_CLOCK_UUID), BT_GATT_CHRC_READ,
+                           BT_GATT_PERM_READ_ENCRYPT, split_svc_clock, NULL, NULL),
 );
 
 K_THREAD_STACK_DEFINE(service_q_stack, CONFIG_ZMK_SPLIT_BLE_PERIPHERAL_STACK_SIZE);
@@ -173,16 +306,19 @@ void send_position_state_callback(struct k_work *work) {
     uint8_t state[POS_STATE_LEN];
 
     while (k_msgq_get(&position_state_msgq, &state, K_NO_WAIT) == 0) {
-        int err = bt_gatt_notify(NULL, &split_svc.attrs[1], &state, sizeof(state));
-        if (err) {
-            LOG_DBG("Error notifying %d", err);
-        }
+        int err = bt_gatt_notify(NULL, &split_svc.attrs[POSITION_STATE_ATTR_INDEX], &state,
+                                 sizeof(state));
+        count_notify_result(err);
     }
 };
 
 K_WORK_DEFINE(service_position_notify_work, send_position_state_callback);
 
 int send_position_state() {
+    if (!position_state_subscribed) {
+        return 0;
+    }
+
     int err = k_msgq_put(&position_state_msgq, position_state, K_MSEC(100));
     if (err) {
         switch (err) {
@@ -190,6 +326,7 @@ int send_position_state() {
             LOG_WRN("Position state message queue full, popping first message and queueing again");
             uint8_t discarded_state[POS_STATE_LEN];
             k_msgq_get(&position_state_msgq, &discarded_state, K_NO_WAIT);
+            zmk_split_stats_inc(ZMK_SPLIT_STATS_CENTRAL_LINK, ZMK_SPLIT_STAT_QUEUE_DROP);
             return send_position_state();
         }
         default:
@@ -203,68 +340,238 @@ int send_position_state() {
     return 0;
 }
 
-int zmk_split_bt_position_pressed(uint8_t position) {
+struct position_event_entry {
+    struct zmk_split_position_event ev;
+    int64_t timestamp;
+};
+
+K_MSGQ_DEFINE(position_event_msgq, sizeof(struct position_event_entry),
+              CONFIG_ZMK_SPLIT_BLE_PERIPHERAL_POSITION_QUEUE_SIZE, 4);
+
+// Set when the central subscribes, so events buffered while it was away that are too old to still
+// matter are dropped before sending the rest.
+static atomic_t drop_stale_position_events;
+
+void send_position_events_callback(struct k_work *work) {
+    struct {
+        struct zmk_split_position_events_header header;
+        struct zmk_split_position_event events[POSITION_EVENTS_PER_NOTIFICATION];
+    } __packed notification;
+    struct position_event_entry entry;
+    size_t count = 0;
+
+    if (!position_events_subscribed) {
+        // Kept until the central is back.
+        return;
+    }
+
+    if (atomic_cas(&drop_stale_position_events, 1, 0)) {
+        const int64_t oldest =
+            k_uptime_get() - CONFIG_ZMK_SPLIT_BLE_PERIPHERAL_RECONNECT_BUFFER_MS;
+        while (k_msgq_peek(&position_event_msgq, &entry) == 0 && entry.timestamp < oldest) {
+            k_msgq_get(&position_event_msgq, &entry, K_NO_WAIT);
+            zmk_split_stats_inc(ZMK_SPLIT_STATS_CENTRAL_LINK, ZMK_SPLIT_STAT_QUEUE_DROP);
+        }
+    }
+
+    do {
+        count = 0;
+        while (count < ARRAY_SIZE(notification.events) &&
+               k_msgq_get(&position_event_msgq, &entry, K_NO_WAIT) == 0) {
+            notification.events[count++] = entry.ev;
+            notification.header.timestamp = (uint32_t)entry.timestamp;
+        }
+
+        if (count == 0) {
+            break;
+        }
+
+        // Events buffered while the central was away can be a while old by now.
+        notification.header.age = MIN(k_uptime_get() - entry.timestamp, UINT16_MAX);
+
+        int err = bt_gatt_notify(NULL, &split_svc.attrs[POSITION_EVENTS_ATTR_INDEX], &notification,
+                                 sizeof(notification.header) +
+                                     count * sizeof(notification.events[0]));
+        count_notify_result(err);
+    } while (count == ARRAY_SIZE(notification.events));
+};
+
+K_WORK_DEFINE(service_position_events_notify_work, send_position_events_callback);
+
+static void flush_buffered_position_events(void) {
+    atomic_set(&drop_stale_position_events, 1);
+    k_work_submit_to_queue(&service_work_q, &service_position_events_notify_work);
+}
+
+static uint8_t position_event_sequence;
+static int64_t last_position_event_timestamp;
+
+int send_position_event(uint32_t position, bool state, int64_t timestamp) {
+    // While the central is away, events are buffered so it still gets them with their original
+    // timing once it reconnects.
+    if (!position_events_subscribed && CONFIG_ZMK_SPLIT_BLE_PERIPHERAL_RECONNECT_BUFFER_MS == 0) {
+        return 0;
+    }
+
+    const int64_t dt = CLAMP(timestamp - last_position_event_timestamp, 0, UINT16_MAX);
+    last_position_event_timestamp = timestamp;
+
+    struct position_event_entry entry = {
+        .ev =
+            {
+                .sequence = position_event_sequence++,
+                .position = position | (state ? ZMK_SPLIT_POSITION_EVENT_PRESSED : 0),
+                .dt = dt,
+            },
+        .timestamp = timestamp,
+    };
+
+    int err = k_msgq_put(&position_event_msgq, &entry, K_NO_WAIT);
+    if (err) {
+        // The central notices the gap in the sequence numbers and reads the position state to
+        // recover from the dropped event.
+        if (position_events_subscribed) {
+            LOG_WRN("Position event message queue full, popping first message and queueing again");
+        }
+        struct position_event_entry discarded_entry;
+        k_msgq_get(&position_event_msgq, &discarded_entry, K_NO_WAIT);
+        zmk_split_stats_inc(ZMK_SPLIT_STATS_CENTRAL_LINK, ZMK_SPLIT_STAT_QUEUE_DROP);
+        k_msgq_put(&position_event_msgq, &entry, K_NO_WAIT);
+    }
+
+    k_work_submit_to_queue(&service_work_q, &service_position_events_notify_work);
+
+    return 0;
+}
+
+int zmk_split_bt_position_pressed(uint32_t position, int64_t timestamp) {
     WRITE_BIT(position_state[position / 8], position % 8, true);
+    send_position_event(position, true, timestamp);
     return send_position_state();
 }
 
-int zmk_split_bt_position_released(uint8_t position) {
+int zmk_split_bt_position_released(uint32_t position, int64_t timestamp) {
     WRITE_BIT(position_state[position / 8], position % 8, false);
+    send_position_event(position, false, timestamp);
     return send_position_state();
 }
 
 #if ZMK_KEYMAP_HAS_SENSORS
-K_MSGQ_DEFINE(sensor_state_msgq, sizeof(struct sensor_event),
-              CONFIG_ZMK_SPLIT_BLE_PERIPHERAL_POSITION_QUEUE_SIZE, 4);
 
-void send_sensor_state_callback(struct k_work *work) {
-    while (k_msgq_get(&sensor_state_msgq, &last_sensor_event, K_NO_WAIT) == 0) {
-        int err = bt_gatt_notify(NULL, &split_svc.attrs[8], &last_sensor_event,
-                                 sizeof(last_sensor_event));
-        if (err) {
-            LOG_DBG("Error notifying %d", err);
-        }
-    }
+// Sensor data not yet sent to the central. Deltas reported while a notification is pending are
+// added up per sensor, so fast encoder spins never overflow a queue and no steps are lost.
+struct pending_sensor_event {
+    struct sensor_event ev;
+    bool pending;
 };
 
-K_WORK_DEFINE(service_sensor_notify_work, send_sensor_state_callback);
+static struct pending_sensor_event pending_sensor_events[ZMK_KEYMAP_SENSORS_LEN];
+static struct k_spinlock pending_sensor_events_lock;
+// Where the next notification starts looking for pending sensors, so a single busy sensor cannot
+// starve the others when not all of them fit in one notification.
+static uint8_t next_pending_sensor;
 
-int send_sensor_state(struct sensor_event ev) {
-    int err = k_msgq_put(&sensor_state_msgq, &ev, K_MSEC(100));
-    if (err) {
-        // retry...
-        switch (err) {
-        case -EAGAIN: {
-            LOG_WRN("Sensor state message queue full, popping first message and queueing again");
-            struct sensor_event discarded_state;
-            k_msgq_get(&sensor_state_msgq, &discarded_state, K_NO_WAIT);
-            return send_sensor_state(ev);
+static void min_conn_mtu(struct bt_conn *conn, void *data) {
+    uint16_t *mtu = data;
+    *mtu = MIN(*mtu, bt_gatt_get_mtu(conn));
+}
+
+// Notifications go to every connection, so a batch has to fit the smallest negotiated MTU. Each
+// sensor has at most one pending event, so a batch never needs more than one per sensor.
+static size_t sensor_events_per_notification(void) {
+    uint16_t mtu = UINT16_MAX;
+    bt_conn_foreach(BT_CONN_TYPE_LE, min_conn_mtu, &mtu);
+    mtu = MAX(mtu, BT_ATT_DEFAULT_LE_MTU);
+
+    return CLAMP((mtu - 3) / sizeof(struct sensor_event), 1, ZMK_KEYMAP_SENSORS_LEN);
+}
+
+static void send_sensor_state_callback(struct k_work *work) {
+    struct sensor_event events[ZMK_KEYMAP_SENSORS_LEN];
+    const size_t max_count = sensor_events_per_notification();
+    size_t count;
+
+    do {
+        count = 0;
+
+        k_spinlock_key_t key = k_spin_lock(&pending_sensor_events_lock);
+
+        for (size_t i = 0; i < ZMK_KEYMAP_SENSORS_LEN && count < max_count; i++) {
+            struct pending_sensor_event *pending =
+                &pending_sensor_events[(next_pending_sensor + i) % ZMK_KEYMAP_SENSORS_LEN];
+            if (pending->pending) {
+                events[count++] = pending->ev;
+                pending->pending = false;
+            }
         }
-        default:
-            LOG_WRN("Failed to queue sensor state to send (%d)", err);
-            return err;
+
+        next_pending_sensor = (next_pending_sensor + 1) % ZMK_KEYMAP_SENSORS_LEN;
+        k_spin_unlock(&pending_sensor_events_lock, key);
+
+        if (count == 0) {
+            break;
         }
-    }
 
-    k_work_submit_to_queue(&service_work_q, &service_sensor_notify_work);
-    return 0;
-}
+        last_sensor_event = events[count - 1];
+
+        int err = bt_gatt_notify(NULL, &split_svc.attrs[SENSOR_STATE_ATTR_INDEX], events,
+                                 count * sizeof(events[0]));
+        count_notify_result(err);
+    } while (count == max_count);
+};
+
+K_WORK_DEFINE(service_sensor_notify_work, send_sensor_state_callback);
 
 int zmk_split_bt_sensor_triggered(uint8_t sensor_index,
                                   const struct zmk_sensor_channel_data channel_data[],
                                   size_t channel_data_size) {
-    if (channel_data_size > ZMK_SENSOR_EVENT_MAX_CHANNELS) {
+    if (channel_data_size > ZMK_SENSOR_EVENT_MAX_CHANNELS ||
+        sensor_index >= ZMK_KEYMAP_SENSORS_LEN) {
         return -EINVAL;
     }
 
-    struct sensor_event ev =
-        (struct sensor_event){.sensor_index = sensor_index, .channel_data_size = channel_data_size};
-    memcpy(ev.channel_data, channel_data,
-           channel_data_size * sizeof(struct zmk_sensor_channel_data));
-    return send_sensor_state(ev);
+    struct pending_sensor_event *pending = &pending_sensor_events[sensor_index];
+    k_spinlock_key_t key = k_spin_lock(&pending_sensor_events_lock);
+
+    if (!pending->pending ||
+        !zmk_sensor_channel_data_add(pending->ev.channel_data, pending->ev.channel_data_size,
+                                     channel_data, channel_data_size)) {
+        // Data for other channels than the unsent data can't be added up, so it replaces it.
+        pending->ev.sensor_index = sensor_index;
+        pending->ev.channel_data_size = channel_data_size;
+        memcpy(pending->ev.channel_data, channel_data,
+               channel_data_size * sizeof(struct zmk_sensor_channel_data));
+        pending->pending = true;
+    }
+
+    k_spin_unlock(&pending_sensor_events_lock, key);
+
+    k_work_submit_to_queue(&service_work_q, &service_sensor_notify_work);
+    return 0;
 }
 #endif /* ZMK_KEYMAP_HAS_SENSORS */
 
+static int split_bt_send_position_event(uint32_t position, bool pressed, int64_t timestamp) {
+    return pressed ? zmk_split_bt_position_pressed(position, timestamp)
+                   : zmk_split_bt_position_released(position, timestamp);
+}
+
+#if ZMK_KEYMAP_HAS_SENSORS
+static int split_bt_send_sensor_event(const struct zmk_sensor_event *ev) {
+    return zmk_split_bt_sensor_triggered(ev->sensor_index, ev->channel_data,
+                                         ev->channel_data_size);
+}
+#endif /* ZMK_KEYMAP_HAS_SENSORS */
+
+static const struct zmk_split_transport_peripheral_api split_bt_peripheral_api = {
+    .send_position_event = split_bt_send_position_event,
+#if ZMK_KEYMAP_HAS_SENSORS
+    .send_sensor_event = split_bt_send_sensor_event,
+#endif /* ZMK_KEYMAP_HAS_SENSORS */
+};
+
+ZMK_SPLIT_TRANSPORT_PERIPHERAL_REGISTER(ble, &split_bt_peripheral_api);
+
 static int service_init(void) {
     static const struct k_work_queue_config queue_config = {
         .name = "Split Peripheral Notification Queue"};
@@ -0,0 +1,201 @@
+/*
+ * Copyright (c) 2023 The ZMK Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <zephyr/kernel.h>
+#include <zephyr/sys/atomic.h>
+#include <zephyr/logging/log.h>
+
+LOG_MODULE_DECLARE(zmk, CONFIG_ZMK_LOG_LEVEL);
+
+#include <zmk/event_manager.h>
+#include <zmk/events/position_state_changed.h>
+#include <zmk/events/sensor_event.h>
+#include <zmk/sensors.h>
+#include <zmk/split/central.h>
+#include <zmk/split/stats.h>
+#include <zmk/split/transport.h>
+#include <zmk/workqueue.h>
+
+int zmk_split_central_invoke_behavior(uint8_t source, struct zmk_behavior_binding *binding,
+                                      struct zmk_behavior_binding_event event, bool state) {
+    const struct zmk_split_transport_central *transport = zmk_split_transport_central_get();
+    if (!transport) {
+        return -ENOTSUP;
+    }
+
+    return transport->api->invoke_behavior(source, binding, event, state);
+}
+
+#if IS_ENABLED(CONFIG_ZMK_SPLIT_PERIPHERAL_HID_INDICATORS)
+
+int zmk_split_central_update_hid_indicator(zmk_hid_indicators_t indicators) {
+    const struct zmk_split_transport_central *transport = zmk_split_transport_central_get();
+    if (!transport || !transport->api->update_hid_indicator) {
+        return -ENOTSUP;
+    }
+
+    return transport->api->update_hid_indicator(indicators);
+}
+
+#endif // IS_ENABLED(CONFIG_ZMK_SPLIT_PERIPHERAL_HID_INDICATORS)
+
+// Position events of one peripheral, handed from the transport's receive context to the input work
+// queue, zmk_workqueue_input_work_q(). The transport is the only producer and the work item the
+// only consumer, so the ring needs no lock. One slot is always left empty to tell a full ring from
+// an empty one.
+struct peripheral_event_ring {
+    struct zmk_position_state_changed events[CONFIG_ZMK_SPLIT_CENTRAL_POSITION_QUEUE_SIZE + 1];
+    // Index of the next event to write. Only written by the producer.
+    atomic_t head;
+    // Index of the next event to read. Only written by the consumer.
+    atomic_t tail;
+    atomic_t dropped;
+};
+
+static struct peripheral_event_ring peripheral_event_rings[ZMK_SPLIT_CENTRAL_PERIPHERAL_COUNT];
+
+static atomic_val_t ring_next(atomic_val_t index) {
+    return (index + 1) % ARRAY_SIZE(peripheral_event_rings[0].events);
+}
+
+static struct zmk_position_state_changed *ring_peek(struct peripheral_event_ring *ring) {
+    const atomic_val_t tail = atomic_get(&ring->tail);
+    return tail == atomic_get(&ring->head) ? NULL : &ring->events[tail];
+}
+
+static void peripheral_event_work_callback(struct k_work *work) {
+    // Raise the events of all peripherals in the order they happened.
+    while (true) {
+        struct peripheral_event_ring *next = NULL;
+        struct zmk_position_state_changed *next_ev = NULL;
+
+        for (size_t i = 0; i < ARRAY_SIZE(peripheral_event_rings); i++) {
+            struct zmk_position_state_changed *ev = ring_peek(&peripheral_event_rings[i]);
+            if (ev && (!next_ev || ev->timestamp < next_ev->timestamp)) {
+                next = &peripheral_event_rings[i];
+                next_ev = ev;
+            }
+        }
+
+        if (!next) {
+            break;
+        }
+
+        struct zmk_position_state_changed ev = *next_ev;
+        atomic_set(&next->tail, ring_next(atomic_get(&next->tail)));
+
+        LOG_DBG("Trigger key position state change for %d", ev.position);
+        raise_zmk_position_state_changed(ev);
+    }
+
+    const struct zmk_split_transport_central *transport = zmk_split_transport_central_get();
+    if (transport && transport->api->position_events_drained) {
+        for (size_t i = 0; i < ARRAY_SIZE(peripheral_event_rings); i++) {
+            transport->api->position_events_drained(i);
+        }
+    }
+}
+
+static K_WORK_DEFINE(peripheral_event_work, peripheral_event_work_callback);
+
+int zmk_split_central_position_state_changed(uint8_t source, uint32_t position, bool pressed,
+                                             int64_t timestamp) {
+    if (source >= ARRAY_SIZE(peripheral_event_rings)) {
+        return -EINVAL;
+    }
+
+    struct peripheral_event_ring *ring = &peripheral_event_rings[source];
+    const atomic_val_t head = atomic_get(&ring->head);
+    if (ring_next(head) == atomic_get(&ring->tail)) {
+        atomic_inc(&ring->dropped);
+        zmk_split_stats_inc(source, ZMK_SPLIT_STAT_QUEUE_DROP);
+        LOG_WRN("Position event queue of peripheral %d full, dropping event for %d", source,
+                position);
+        return -ENOMEM;
+    }
+
+    ring->events[head] = (struct zmk_position_state_changed){
+        .source = source,
+        .position = position,
+        .state = pressed,
+        .timestamp = timestamp,
+#if IS_ENABLED(CONFIG_ZMK_POSITION_TIMESTAMP_TICKS)
+        // Peripherals only report millisecond timestamps.
+        .timestamp_ticks = k_ms_to_ticks_floor64(timestamp),
+#endif
+    };
+    atomic_set(&ring->head, ring_next(head));
+
+    return 0;
+}
+
+void zmk_split_central_position_events_ready(void) {
+    k_work_submit_to_queue(zmk_workqueue_input_work_q(), &peripheral_event_work);
+}
+
+uint32_t zmk_split_central_dropped_position_events(uint8_t source) {
+    if (source >= ARRAY_SIZE(peripheral_event_rings)) {
+        return 0;
+    }
+
+    return atomic_get(&peripheral_event_rings[source].dropped);
+}
+
+#if ZMK_KEYMAP_HAS_SENSORS
+
+// Peripheral sensor events not raised yet. Deltas that arrive before the input work queue gets to
+// them are added up per sensor, as the peripheral does before sending them, so none are dropped.
+struct pending_sensor_event {
+    struct zmk_sensor_event ev;
+    bool pending;
+};
+
+static struct pending_sensor_event pending_sensor_events[ZMK_KEYMAP_SENSORS_LEN];
+static struct k_spinlock pending_sensor_events_lock;
+
+static void peripheral_sensor_event_work_callback(struct k_work *work) {
+    for (size_t i = 0; i < ARRAY_SIZE(pending_sensor_events); i++) {
+        k_spinlock_key_t key = k_spin_lock(&pending_sensor_events_lock);
+        const bool pending = pending_sensor_events[i].pending;
+        const struct zmk_sensor_event ev = pending_sensor_events[i].ev;
+        pending_sensor_events[i].pending = false;
+        k_spin_unlock(&pending_sensor_events_lock, key);
+
+        if (pending) {
+            LOG_DBG("Trigger sensor change for %d", ev.sensor_index);
+            raise_zmk_sensor_event(ev);
+        }
+    }
+}
+
+static K_WORK_DEFINE(peripheral_sensor_event_work, peripheral_sensor_event_work_callback);
+
+void zmk_split_central_sensor_event(uint8_t source, const struct zmk_sensor_event *ev) {
+    if (ev->sensor_index >= ARRAY_SIZE(pending_sensor_events)) {
+        LOG_WRN("Ignoring event of peripheral %d for unknown sensor %d", source,
+                ev->sensor_index);
+        return;
+    }
+
+    struct pending_sensor_event *pending = &pending_sensor_events[ev->sensor_index];
+    k_spinlock_key_t key = k_spin_lock(&pending_sensor_events_lock);
+
+    if (pending->pending &&
+        zmk_sensor_channel_data_add(pending->ev.channel_data, pending->ev.channel_data_size,
+                                    ev->channel_data, ev->channel_data_size)) {
+        pending->ev.timestamp = ev->timestamp;
+    } else {
+        // Data for other channels than the pending data can't be added up, so it replaces it.
+        pending->ev = *ev;
+        pending->pending = true;
+    }
+
+    k_spin_unlock(&pending_sensor_events_lock, key);
+
+    k_work_submit_to_queue(zmk_workqueue_input_work_q(), &peripheral_sensor_event_work);
+}
+
+#endif /* ZMK_KEYMAP_HAS_SENSORS */
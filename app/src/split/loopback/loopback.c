@@ -0,0 +1,118 @@
+/*
+ * Copyright (c) 2023 The ZMK Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#define DT_DRV_COMPAT zmk_split_loopback
+
+#include <zephyr/device.h>
+#include <zephyr/init.h>
+#include <zephyr/kernel.h>
+#include <zephyr/drivers/kscan.h>
+#include <zephyr/sys/util.h>
+#include <zephyr/logging/log.h>
+
+LOG_MODULE_DECLARE(zmk, CONFIG_ZMK_LOG_LEVEL);
+
+#include <drivers/behavior.h>
+#include <zmk/behavior.h>
+#include <zmk/matrix.h>
+#include <zmk/matrix_transform.h>
+#include <zmk/split/central.h>
+#include <zmk/split/transport.h>
+
+// The simulated peripheral is the only one.
+#define PERIPHERAL_SOURCE 0
+
+static const struct device *kscan = DEVICE_DT_GET(DT_INST_PHANDLE(0, kscan));
+
+// Like a real peripheral, only changes in the position state are sent to the central.
+static uint8_t position_state[DIV_ROUND_UP(ZMK_KEYMAP_LEN, 8)];
+
+static int loopback_send_position_event(uint32_t position, bool pressed, int64_t timestamp) {
+    if (((position_state[position / 8] & BIT(position % 8)) != 0) == pressed) {
+        return 0;
+    }
+
+    LOG_DBG("Peripheral position %d %s", position, pressed ? "pressed" : "released");
+    int err =
+        zmk_split_central_position_state_changed(PERIPHERAL_SOURCE, position, pressed, timestamp);
+    if (err == 0) {
+        WRITE_BIT(position_state[position / 8], position % 8, pressed);
+    }
+
+    zmk_split_central_position_events_ready();
+    return err;
+}
+
+#if ZMK_KEYMAP_HAS_SENSORS
+static int loopback_send_sensor_event(const struct zmk_sensor_event *ev) {
+    LOG_DBG("Peripheral sensor %d", ev->sensor_index);
+    zmk_split_central_sensor_event(PERIPHERAL_SOURCE, ev);
+    return 0;
+}
+#endif /* ZMK_KEYMAP_HAS_SENSORS */
+
+static const struct zmk_split_transport_peripheral_api loopback_peripheral_api = {
+    .send_position_event = loopback_send_position_event,
+#if ZMK_KEYMAP_HAS_SENSORS
+    .send_sensor_event = loopback_send_sensor_event,
+#endif /* ZMK_KEYMAP_HAS_SENSORS */
+};
+
+// The central and peripheral share a build, so the peripheral side is driven directly from its
+// kscan rather than through the generic peripheral listener.
+static void loopback_kscan_callback(const struct device *dev, uint32_t row, uint32_t column,
+                                    bool pressed) {
+    int32_t position = zmk_matrix_transform_row_column_to_position(row, column);
+    if (position < 0) {
+        LOG_WRN("Not found in transform: row: %d, col: %d", row, column);
+        return;
+    }
+
+    loopback_peripheral_api.send_position_event(position, pressed, k_uptime_get());
+}
+
+static int loopback_invoke_behavior(uint8_t source, struct zmk_behavior_binding *binding,
+                                    struct zmk_behavior_binding_event event, bool state) {
+    if (source != PERIPHERAL_SOURCE) {
+        return -EINVAL;
+    }
+
+    LOG_DBG("Peripheral running %s with params %d %d: pressed? %d", binding->behavior_dev,
+            binding->param1, binding->param2, state);
+
+    return state ? behavior_keymap_binding_pressed(binding, event)
+                 : behavior_keymap_binding_released(binding, event);
+}
+
+#if IS_ENABLED(CONFIG_ZMK_SPLIT_PERIPHERAL_HID_INDICATORS)
+static int loopback_update_hid_indicator(zmk_hid_indicators_t indicators) {
+    LOG_DBG("Peripheral HID indicators %x", indicators);
+    return 0;
+}
+#endif // IS_ENABLED(CONFIG_ZMK_SPLIT_PERIPHERAL_HID_INDICATORS)
+
+static const struct zmk_split_transport_central_api loopback_central_api = {
+    .invoke_behavior = loopback_invoke_behavior,
+#if IS_ENABLED(CONFIG_ZMK_SPLIT_PERIPHERAL_HID_INDICATORS)
+    .update_hid_indicator = loopback_update_hid_indicator,
+#endif // IS_ENABLED(CONFIG_ZMK_SPLIT_PERIPHERAL_HID_INDICATORS)
+};
+
+ZMK_SPLIT_TRANSPORT_CENTRAL_REGISTER(loopback, &loopback_central_api);
+
+static int zmk_split_loopback_init(void) {
+    if (!device_is_ready(kscan)) {
+        LOG_ERR("Loopback peripheral kscan %s is not ready", kscan->name);
+        return -ENODEV;
+    }
+
+    kscan_config(kscan, loopback_kscan_callback);
+    kscan_enable_callback(kscan);
+
+    return 0;
+}
+
+SYS_INIT(zmk_split_loopback_init, APPLICATION, CONFIG_APPLICATION_INIT_PRIORITY);
@@ -0,0 +1,45 @@
+/*
+ * Copyright (c) 2023 The ZMK Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+
+LOG_MODULE_DECLARE(zmk, CONFIG_ZMK_LOG_LEVEL);
+
+#include <zmk/event_manager.h>
+#include <zmk/events/position_state_changed.h>
+#include <zmk/events/sensor_event.h>
+#include <zmk/sensors.h>
+#include <zmk/split/transport.h>
+
+static int split_peripheral_listener(const zmk_event_t *eh) {
+    const struct zmk_split_transport_peripheral *transport = zmk_split_transport_peripheral_get();
+    if (!transport) {
+        return ZMK_EV_EVENT_BUBBLE;
+    }
+
+    const struct zmk_position_state_changed *pos_ev;
+    if ((pos_ev = as_zmk_position_state_changed(eh)) != NULL) {
+        return transport->api->send_position_event(pos_ev->position, pos_ev->state,
+                                                   pos_ev->timestamp);
+    }
+
+#if ZMK_KEYMAP_HAS_SENSORS
+    const struct zmk_sensor_event *sensor_ev;
+    if ((sensor_ev = as_zmk_sensor_event(eh)) != NULL && transport->api->send_sensor_event) {
+        return transport->api->send_sensor_event(sensor_ev);
+    }
+#endif /* ZMK_KEYMAP_HAS_SENSORS */
+
+    return ZMK_EV_EVENT_BUBBLE;
+}
+
+ZMK_LISTENER(split_peripheral_listener, split_peripheral_listener);
+ZMK_SUBSCRIPTION(split_peripheral_listener, zmk_position_state_changed);
+
+#if ZMK_KEYMAP_HAS_SENSORS
+ZMK_SUBSCRIPTION(split_peripheral_listener, zmk_sensor_event);
+#endif /* ZMK_KEYMAP_HAS_SENSORS */
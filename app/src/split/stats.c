@@ -0,0 +1,218 @@
+/*
+ * Copyright (c) 2023 The ZMK Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <string.h>
+#include <zephyr/init.h>
+#include <zephyr/kernel.h>
+#include <zephyr/sys/atomic.h>
+#include <zephyr/logging/log.h>
+
+LOG_MODULE_DECLARE(zmk, CONFIG_ZMK_LOG_LEVEL);
+
+#include <zmk/split/stats.h>
+#include <zmk/workqueue.h>
+
+#if IS_ENABLED(CONFIG_ZMK_SPLIT_STATS_EVENT)
+#include <zmk/events/split_link_stats_changed.h>
+#endif // IS_ENABLED(CONFIG_ZMK_SPLIT_STATS_EVENT)
+
+#if IS_ENABLED(CONFIG_SHELL)
+#include <zephyr/shell/shell.h>
+#endif // IS_ENABLED(CONFIG_SHELL)
+
+struct link_stats {
+    // Updated from whichever context the transport runs in, so only touched atomically.
+    atomic_t counts[ZMK_SPLIT_STAT_COUNT];
+    atomic_t rssi;
+    atomic_t latency_us;
+};
+
+static struct link_stats links[ZMK_SPLIT_STATS_LINK_COUNT];
+
+static ATOMIC_DEFINE(links_up, ZMK_SPLIT_STATS_LINK_COUNT);
+static zmk_split_stats_refresh_cb refresh_callbacks[ZMK_SPLIT_STATS_LINK_COUNT];
+
+static void stats_work_callback(struct k_work *work);
+
+static K_WORK_DELAYABLE_DEFINE(stats_work, stats_work_callback);
+
+void zmk_split_stats_inc(uint8_t link, enum zmk_split_stat stat) {
+    if (link >= ARRAY_SIZE(links) || stat >= ZMK_SPLIT_STAT_COUNT) {
+        return;
+    }
+
+    atomic_inc(&links[link].counts[stat]);
+}
+
+void zmk_split_stats_set_rssi(uint8_t link, int8_t rssi) {
+    if (link < ARRAY_SIZE(links)) {
+        atomic_set(&links[link].rssi, rssi);
+    }
+}
+
+void zmk_split_stats_set_latency(uint8_t link, int32_t latency_us) {
+    if (link < ARRAY_SIZE(links)) {
+        atomic_set(&links[link].latency_us, latency_us);
+    }
+}
+
+static void forget_link_quality(uint8_t link) {
+    zmk_split_stats_set_rssi(link, ZMK_SPLIT_STATS_RSSI_UNKNOWN);
+    zmk_split_stats_set_latency(link, -1);
+}
+
+void zmk_split_stats_link_up(uint8_t link, zmk_split_stats_refresh_cb refresh) {
+    if (link >= ARRAY_SIZE(links)) {
+        return;
+    }
+
+    refresh_callbacks[link] = refresh;
+    atomic_set_bit(links_up, link);
+    k_work_reschedule_for_queue(zmk_workqueue_lowprio_work_q(), &stats_work, K_NO_WAIT);
+}
+
+void zmk_split_stats_link_down(uint8_t link) {
+    if (link >= ARRAY_SIZE(links)) {
+        return;
+    }
+
+    atomic_clear_bit(links_up, link);
+    forget_link_quality(link);
+    // Runs once more to report the link going down, and stops if no other link is up.
+    k_work_reschedule_for_queue(zmk_workqueue_lowprio_work_q(), &stats_work, K_NO_WAIT);
+}
+
+int zmk_split_stats_get(uint8_t link, struct zmk_split_link_stats *stats) {
+    if (link >= ARRAY_SIZE(links)) {
+        return -EINVAL;
+    }
+
+    for (int i = 0; i < ZMK_SPLIT_STAT_COUNT; i++) {
+        stats->counts[i] = atomic_get(&links[link].counts[i]);
+    }
+    stats->rssi = atomic_get(&links[link].rssi);
+    stats->latency_us = atomic_get(&links[link].latency_us);
+
+    return 0;
+}
+
+void zmk_split_stats_reset(void) {
+    for (int link = 0; link < ARRAY_SIZE(links); link++) {
+        for (int i = 0; i < ZMK_SPLIT_STAT_COUNT; i++) {
+            atomic_clear(&links[link].counts[i]);
+        }
+    }
+}
+
+#if IS_ENABLED(CONFIG_ZMK_SPLIT_STATS_EVENT)
+
+// The statistics of the last event raised for each link.
+static struct zmk_split_link_stats raised_stats[ZMK_SPLIT_STATS_LINK_COUNT];
+
+static bool stats_equal(const struct zmk_split_link_stats *a,
+                        const struct zmk_split_link_stats *b) {
+    return memcmp(a->counts, b->counts, sizeof(a->counts)) == 0 && a->rssi == b->rssi &&
+           a->latency_us == b->latency_us;
+}
+
+static void raise_changed_stats(void) {
+    for (int link = 0; link < ARRAY_SIZE(links); link++) {
+        struct zmk_split_link_stats_changed ev = {.link = link};
+        zmk_split_stats_get(link, &ev.stats);
+        if (stats_equal(&ev.stats, &raised_stats[link])) {
+            continue;
+        }
+
+        raised_stats[link] = ev.stats;
+        raise_zmk_split_link_stats_changed(ev);
+    }
+}
+
+#endif // IS_ENABLED(CONFIG_ZMK_SPLIT_STATS_EVENT)
+
+// Runs on the low priority work queue while any link is up, since refreshing the RSSI waits for
+// the controller.
+static void stats_work_callback(struct k_work *work) {
+    bool any_up = false;
+
+    for (int link = 0; link < ARRAY_SIZE(links); link++) {
+        if (!atomic_test_bit(links_up, link)) {
+            continue;
+        }
+
+        any_up = true;
+        if (refresh_callbacks[link]) {
+            refresh_callbacks[link](link);
+        }
+    }
+
+#if IS_ENABLED(CONFIG_ZMK_SPLIT_STATS_EVENT)
+    raise_changed_stats();
+#endif // IS_ENABLED(CONFIG_ZMK_SPLIT_STATS_EVENT)
+
+    if (any_up) {
+        k_work_schedule_for_queue(zmk_workqueue_lowprio_work_q(), &stats_work,
+                                  K_MSEC(CONFIG_ZMK_SPLIT_STATS_INTERVAL));
+    }
+}
+
+#if IS_ENABLED(CONFIG_SHELL)
+
+static int cmd_split_stats(const struct shell *sh, size_t argc, char **argv) {
+    for (int link = 0; link < ARRAY_SIZE(links); link++) {
+        struct zmk_split_link_stats stats;
+        zmk_split_stats_get(link, &stats);
+
+        shell_print(sh, "Link %d:", link);
+        shell_print(sh, "  sent: %u, send errors: %u", stats.counts[ZMK_SPLIT_STAT_TX],
+                    stats.counts[ZMK_SPLIT_STAT_TX_ERROR]);
+        shell_print(sh, "  received: %u, queue drops: %u", stats.counts[ZMK_SPLIT_STAT_RX],
+                    stats.counts[ZMK_SPLIT_STAT_QUEUE_DROP]);
+        shell_print(sh, "  connection parameter updates: %u",
+                    stats.counts[ZMK_SPLIT_STAT_CONN_PARAM_UPDATE]);
+
+        if (stats.rssi == ZMK_SPLIT_STATS_RSSI_UNKNOWN) {
+            shell_print(sh, "  rssi: unknown");
+        } else {
+            shell_print(sh, "  rssi: %d dBm", stats.rssi);
+        }
+
+        if (stats.latency_us < 0) {
+            shell_print(sh, "  latency: unknown");
+        } else {
+            shell_print(sh, "  latency: %d us", stats.latency_us);
+        }
+    }
+
+    return 0;
+}
+
+static int cmd_split_stats_reset(const struct shell *sh, size_t argc, char **argv) {
+    zmk_split_stats_reset();
+    return 0;
+}
+
+SHELL_STATIC_SUBCMD_SET_CREATE(sub_split_stats,
+                               SHELL_CMD(reset, NULL, "Reset the counters", cmd_split_stats_reset),
+                               SHELL_SUBCMD_SET_END);
+
+SHELL_STATIC_SUBCMD_SET_CREATE(sub_split, SHELL_CMD(stats, &sub_split_stats,
+                                                    "Show split link statistics", cmd_split_stats),
+                               SHELL_SUBCMD_SET_END);
+
+SHELL_CMD_REGISTER(split, &sub_split, "Split keyboard commands", NULL);
+
+#endif // IS_ENABLED(CONFIG_SHELL)
+
+static int zmk_split_stats_init(void) {
+    for (int link = 0; link < ARRAY_SIZE(links); link++) {
+        forget_link_quality(link);
+    }
+
+    return 0;
+}
+
+SYS_INIT(zmk_split_stats_init, APPLICATION, CONFIG_APPLICATION_INIT_PRIORITY);
@@ -0,0 +1,49 @@
+/*
+ * Copyright (c) 2023 The ZMK Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <zephyr/init.h>
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+
+LOG_MODULE_DECLARE(zmk, CONFIG_ZMK_LOG_LEVEL);
+
+#include <zmk/split/transport.h>
+
+const struct zmk_split_transport_central *zmk_split_transport_central_get(void) {
+    STRUCT_SECTION_FOREACH(zmk_split_transport_central, transport) {
+        return transport;
+    }
+
+    return NULL;
+}
+
+const struct zmk_split_transport_peripheral *zmk_split_transport_peripheral_get(void) {
+    STRUCT_SECTION_FOREACH(zmk_split_transport_peripheral, transport) {
+        return transport;
+    }
+
+    return NULL;
+}
+
+static int zmk_split_transport_init(void) {
+    size_t count;
+
+#if IS_ENABLED(CONFIG_ZMK_SPLIT_ROLE_CENTRAL)
+    STRUCT_SECTION_COUNT(zmk_split_transport_central, &count);
+#else
+    STRUCT_SECTION_COUNT(zmk_split_transport_peripheral, &count);
+#endif
+
+    if (count == 0) {
+        LOG_ERR("No split transport is registered");
+    } else if (count > 1) {
+        LOG_WRN("%zu split transports are registered. Only the first one is used.", count);
+    }
+
+    return 0;
+}
+
+SYS_INIT(zmk_split_transport_init, APPLICATION, CONFIG_APPLICATION_INIT_PRIORITY);
@@ -0,0 +1,178 @@
+/*
+ * Copyright (c) 2023 The ZMK Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <string.h>
+#include <zephyr/init.h>
+#include <zephyr/kernel.h>
+#include <zephyr/sys/util.h>
+#include <zephyr/logging/log.h>
+
+LOG_MODULE_DECLARE(zmk, CONFIG_ZMK_LOG_LEVEL);
+
+#include <zmk/behavior.h>
+#include <zmk/sensors.h>
+#include <zmk/events/sensor_event.h>
+#include <zmk/split/central.h>
+#include <zmk/split/transport.h>
+#include <zmk/split/wired/central.h>
+#include <zmk/split/wired/wired.h>
+
+// There is only ever a single peripheral on the other end of the cable.
+#define PERIPHERAL_SOURCE 0
+
+// Positions currently held on the peripheral, so they can be released if the link goes down.
+static uint8_t position_state[ZMK_SPLIT_WIRED_POSITION_STATE_LEN];
+
+static void set_position_state(uint32_t position, bool pressed, int64_t timestamp) {
+    if (position >= ZMK_KEYMAP_LEN) {
+        LOG_WRN("Ignoring event for out of range position %d", position);
+        return;
+    }
+
+    if (((position_state[position / 8] & BIT(position % 8)) != 0) == pressed) {
+        return;
+    }
+
+    // Only remember the new state once it is queued, so a dropped change is raised again by the
+    // next position state message.
+    if (zmk_split_central_position_state_changed(PERIPHERAL_SOURCE, position, pressed,
+                                                 timestamp) == 0) {
+        WRITE_BIT(position_state[position / 8], position % 8, pressed);
+    }
+}
+
+static void handle_position_event(const uint8_t *data, size_t len) {
+    struct zmk_split_wired_position_event ev;
+    if (len != sizeof(ev)) {
+        LOG_WRN("Ignoring position event with invalid length (%zu)", len);
+        return;
+    }
+
+    memcpy(&ev, data, sizeof(ev));
+    set_position_state(ev.position & ~ZMK_SPLIT_WIRED_POSITION_PRESSED,
+                       (ev.position & ZMK_SPLIT_WIRED_POSITION_PRESSED) != 0, k_uptime_get());
+    zmk_split_central_position_events_ready();
+}
+
+static void handle_position_state(const uint8_t *data, size_t len) {
+    const int64_t timestamp = k_uptime_get();
+
+    for (uint32_t position = 0; position < ZMK_KEYMAP_LEN; position++) {
+        const bool pressed = position / 8 < len && (data[position / 8] & BIT(position % 8)) != 0;
+        set_position_state(position, pressed, timestamp);
+    }
+
+    zmk_split_central_position_events_ready();
+}
+
+#if ZMK_KEYMAP_HAS_SENSORS
+static void handle_sensor_event(const uint8_t *data, size_t len) {
+    struct zmk_split_wired_sensor_event sensor_event = {0};
+    if (len < offsetof(struct zmk_split_wired_sensor_event, channel_data)) {
+        LOG_WRN("Ignoring sensor event with insufficient data length (%zu)", len);
+        return;
+    }
+
+    memcpy(&sensor_event, data, MIN(len, sizeof(sensor_event)));
+    struct zmk_sensor_event ev = {
+        .sensor_index = sensor_event.sensor_index,
+        .channel_data_size = MIN(sensor_event.channel_data_size, ZMK_SENSOR_EVENT_MAX_CHANNELS),
+        .timestamp = k_uptime_get()};
+
+    memcpy(ev.channel_data, sensor_event.channel_data,
+           sizeof(struct zmk_sensor_channel_data) * ev.channel_data_size);
+    zmk_split_central_sensor_event(PERIPHERAL_SOURCE, &ev);
+}
+#endif /* ZMK_KEYMAP_HAS_SENSORS */
+
+static void wired_central_receive(uint8_t type, const uint8_t *data, size_t len) {
+    switch (type) {
+    case ZMK_SPLIT_WIRED_MSG_POSITION_EVENT:
+        handle_position_event(data, len);
+        break;
+    case ZMK_SPLIT_WIRED_MSG_POSITION_STATE:
+        handle_position_state(data, len);
+        break;
+#if ZMK_KEYMAP_HAS_SENSORS
+    case ZMK_SPLIT_WIRED_MSG_SENSOR_EVENT:
+        handle_sensor_event(data, len);
+        break;
+#endif /* ZMK_KEYMAP_HAS_SENSORS */
+    default:
+        LOG_WRN("Ignoring unexpected message type %d", type);
+        break;
+    }
+}
+
+#if IS_ENABLED(CONFIG_ZMK_SPLIT_PERIPHERAL_HID_INDICATORS)
+static zmk_hid_indicators_t hid_indicators = 0;
+#endif // IS_ENABLED(CONFIG_ZMK_SPLIT_PERIPHERAL_HID_INDICATORS)
+
+static void wired_central_link_changed(bool connected) {
+    if (!connected) {
+        // Release any positions still held on the peripheral.
+        handle_position_state(NULL, 0);
+        return;
+    }
+
+#if IS_ENABLED(CONFIG_ZMK_SPLIT_PERIPHERAL_HID_INDICATORS)
+    zmk_split_wired_send(ZMK_SPLIT_WIRED_MSG_HID_INDICATORS, &hid_indicators,
+                         sizeof(hid_indicators));
+#endif // IS_ENABLED(CONFIG_ZMK_SPLIT_PERIPHERAL_HID_INDICATORS)
+}
+
+int zmk_split_wired_invoke_behavior(uint8_t source, struct zmk_behavior_binding *binding,
+                                    struct zmk_behavior_binding_event event, bool state) {
+    if (source != PERIPHERAL_SOURCE) {
+        return -EINVAL;
+    }
+
+    struct {
+        struct zmk_split_wired_run_behavior data;
+        char behavior_dev[ZMK_SPLIT_WIRED_BEHAVIOR_NAME_MAX_LEN];
+    } __packed payload = {.data = {
+                              .position = event.position,
+                              .state = state ? 1 : 0,
+                              .param1 = binding->param1,
+                              .param2 = binding->param2,
+                          }};
+
+    const size_t name_len = strlen(binding->behavior_dev);
+    if (name_len > sizeof(payload.behavior_dev)) {
+        LOG_ERR("Behavior label %s is too long to invoke on the peripheral", binding->behavior_dev);
+        return -EMSGSIZE;
+    }
+
+    memcpy(payload.behavior_dev, binding->behavior_dev, name_len);
+
+    return zmk_split_wired_send(ZMK_SPLIT_WIRED_MSG_RUN_BEHAVIOR, &payload,
+                                sizeof(payload.data) + name_len);
+}
+
+#if IS_ENABLED(CONFIG_ZMK_SPLIT_PERIPHERAL_HID_INDICATORS)
+
+int zmk_split_wired_update_hid_indicator(zmk_hid_indicators_t indicators) {
+    hid_indicators = indicators;
+    return zmk_split_wired_send(ZMK_SPLIT_WIRED_MSG_HID_INDICATORS, &hid_indicators,
+                                sizeof(hid_indicators));
+}
+
+#endif // IS_ENABLED(CONFIG_ZMK_SPLIT_PERIPHERAL_HID_INDICATORS)
+
+static const struct zmk_split_transport_central_api split_wired_central_api = {
+    .invoke_behavior = zmk_split_wired_invoke_behavior,
+#if IS_ENABLED(CONFIG_ZMK_SPLIT_PERIPHERAL_HID_INDICATORS)
+    .update_hid_indicator = zmk_split_wired_update_hid_indicator,
+#endif // IS_ENABLED(CONFIG_ZMK_SPLIT_PERIPHERAL_HID_INDICATORS)
+};
+
+ZMK_SPLIT_TRANSPORT_CENTRAL_REGISTER(wired, &split_wired_central_api);
+
+static int zmk_split_wired_central_init(void) {
+    return zmk_split_wired_init(wired_central_receive, wired_central_link_changed);
+}
+
+SYS_INIT(zmk_split_wired_central_init, APPLICATION, CONFIG_APPLICATION_INIT_PRIORITY);
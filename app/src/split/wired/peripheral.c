@@ -0,0 +1,211 @@
+/*
+ * Copyright (c) 2023 The ZMK Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <string.h>
+#include <zephyr/init.h>
+#include <zephyr/kernel.h>
+#include <zephyr/sys/atomic.h>
+#include <zephyr/sys/util.h>
+#include <zephyr/logging/log.h>
+
+LOG_MODULE_DECLARE(zmk, CONFIG_ZMK_LOG_LEVEL);
+
+#include <drivers/behavior.h>
+#include <zmk/behavior.h>
+#include <zmk/sensors.h>
+#include <zmk/event_manager.h>
+#include <zmk/events/sensor_event.h>
+#include <zmk/events/split_peripheral_status_changed.h>
+#include <zmk/split/transport.h>
+#include <zmk/split/wired/peripheral.h>
+#include <zmk/split/wired/wired.h>
+#include <zmk/workqueue.h>
+
+#if IS_ENABLED(CONFIG_ZMK_SPLIT_PERIPHERAL_HID_INDICATORS)
+#include <zmk/events/hid_indicators_changed.h>
+#endif // IS_ENABLED(CONFIG_ZMK_SPLIT_PERIPHERAL_HID_INDICATORS)
+
+BUILD_ASSERT(ZMK_KEYMAP_LEN <= ZMK_SPLIT_WIRED_POSITION_PRESSED,
+             "The wired split protocol supports at most 32768 key positions");
+
+// Kept up to date while the link is down, so the central gets the current state once it is back.
+static uint8_t position_state[ZMK_SPLIT_WIRED_POSITION_STATE_LEN];
+
+static bool is_connected;
+
+// Set while the central needs the whole position state, either because the link just came up or
+// because a position event did not fit the send queue. Position events are not sent on their own
+// then, so they can't overtake the state. Sent from the input work queue, which also runs
+// send_position_event(), so no change can be missed between taking the state and clearing this.
+static atomic_t position_state_pending;
+
+static void send_position_state_callback(struct k_work *work);
+
+static K_WORK_DELAYABLE_DEFINE(send_position_state_work, send_position_state_callback);
+
+static void send_position_state_callback(struct k_work *work) {
+    if (!atomic_get(&position_state_pending)) {
+        return;
+    }
+
+    int err = zmk_split_wired_send(ZMK_SPLIT_WIRED_MSG_POSITION_STATE, position_state,
+                                   sizeof(position_state));
+    if (err == -ENOMSG) {
+        // Try again once the queued messages had time to go out.
+        k_work_schedule_for_queue(zmk_workqueue_input_work_q(), &send_position_state_work,
+                                  K_USEC(CONFIG_ZMK_SPLIT_WIRED_RETRANSMIT_TIMEOUT_US));
+        return;
+    }
+
+    // The state is sent again by the next link up if the link is down.
+    atomic_set(&position_state_pending, false);
+}
+
+static void request_position_state(k_timeout_t delay) {
+    atomic_set(&position_state_pending, true);
+    k_work_schedule_for_queue(zmk_workqueue_input_work_q(), &send_position_state_work, delay);
+}
+
+static void handle_run_behavior(const uint8_t *data, size_t len) {
+    struct zmk_split_wired_run_behavior run;
+    char behavior_dev[ZMK_SPLIT_WIRED_BEHAVIOR_NAME_MAX_LEN + 1];
+
+    if (len <= sizeof(run) || len - sizeof(run) >= sizeof(behavior_dev)) {
+        LOG_WRN("Ignoring run behavior message with invalid length (%zu)", len);
+        return;
+    }
+
+    memcpy(&run, data, sizeof(run));
+    memcpy(behavior_dev, data + sizeof(run), len - sizeof(run));
+    behavior_dev[len - sizeof(run)] = '\0';
+
+    struct zmk_behavior_binding binding = {
+        .param1 = run.param1,
+        .param2 = run.param2,
+        .behavior_dev = behavior_dev,
+    };
+    LOG_DBG("%s with params %d %d: pressed? %d", binding.behavior_dev, binding.param1,
+            binding.param2, run.state);
+    struct zmk_behavior_binding_event event = {.position = run.position,
+                                               .timestamp = k_uptime_get()};
+    int err;
+    if (run.state > 0) {
+        err = behavior_keymap_binding_pressed(&binding, event);
+    } else {
+        err = behavior_keymap_binding_released(&binding, event);
+    }
+
+    if (err) {
+        LOG_ERR("Failed to invoke behavior %s: %d", binding.behavior_dev, err);
+    }
+}
+
+#if IS_ENABLED(CONFIG_ZMK_SPLIT_PERIPHERAL_HID_INDICATORS)
+
+static zmk_hid_indicators_t hid_indicators = 0;
+
+static void update_indicators_callback(struct k_work *work) {
+    LOG_DBG("Raising HID indicators changed event: %x", hid_indicators);
+    raise_zmk_hid_indicators_changed(
+        (struct zmk_hid_indicators_changed){.indicators = hid_indicators});
+}
+
+static K_WORK_DEFINE(update_indicators_work, update_indicators_callback);
+
+static void handle_hid_indicators(const uint8_t *data, size_t len) {
+    if (len != sizeof(hid_indicators)) {
+        LOG_WRN("Ignoring HID indicators with invalid length (%zu)", len);
+        return;
+    }
+
+    memcpy(&hid_indicators, data, sizeof(hid_indicators));
+    k_work_submit(&update_indicators_work);
+}
+
+#endif // IS_ENABLED(CONFIG_ZMK_SPLIT_PERIPHERAL_HID_INDICATORS)
+
+static void wired_peripheral_receive(uint8_t type, const uint8_t *data, size_t len) {
+    switch (type) {
+    case ZMK_SPLIT_WIRED_MSG_RUN_BEHAVIOR:
+        handle_run_behavior(data, len);
+        break;
+#if IS_ENABLED(CONFIG_ZMK_SPLIT_PERIPHERAL_HID_INDICATORS)
+    case ZMK_SPLIT_WIRED_MSG_HID_INDICATORS:
+        handle_hid_indicators(data, len);
+        break;
+#endif // IS_ENABLED(CONFIG_ZMK_SPLIT_PERIPHERAL_HID_INDICATORS)
+    default:
+        LOG_WRN("Ignoring unexpected message type %d", type);
+        break;
+    }
+}
+
+static void status_changed_callback(struct k_work *work) {
+    raise_zmk_split_peripheral_status_changed(
+        (struct zmk_split_peripheral_status_changed){.connected = is_connected});
+}
+
+static K_WORK_DEFINE(status_changed_work, status_changed_callback);
+
+static void wired_peripheral_link_changed(bool connected) {
+    is_connected = connected;
+    k_work_submit(&status_changed_work);
+
+    if (connected) {
+        request_position_state(K_NO_WAIT);
+    }
+}
+
+bool zmk_split_wired_peripheral_is_connected(void) { return is_connected; }
+
+static int send_position_event(uint32_t position, bool pressed, int64_t timestamp) {
+    WRITE_BIT(position_state[position / 8], position % 8, pressed);
+
+    if (atomic_get(&position_state_pending)) {
+        return 0;
+    }
+
+    const struct zmk_split_wired_position_event ev = {
+        .position = position | (pressed ? ZMK_SPLIT_WIRED_POSITION_PRESSED : 0),
+    };
+
+    int err = zmk_split_wired_send(ZMK_SPLIT_WIRED_MSG_POSITION_EVENT, &ev, sizeof(ev));
+    if (err == -ENOMSG) {
+        // Never drop a position change, send the whole state once the queue has room again.
+        request_position_state(K_USEC(CONFIG_ZMK_SPLIT_WIRED_RETRANSMIT_TIMEOUT_US));
+        return 0;
+    }
+    return err == -ENOTCONN ? 0 : err;
+}
+
+#if ZMK_KEYMAP_HAS_SENSORS
+static int send_sensor_event(const struct zmk_sensor_event *sensor_ev) {
+    struct zmk_split_wired_sensor_event ev = {
+        .sensor_index = sensor_ev->sensor_index,
+        .channel_data_size = MIN(sensor_ev->channel_data_size, ZMK_SENSOR_EVENT_MAX_CHANNELS),
+    };
+    memcpy(ev.channel_data, sensor_ev->channel_data,
+           sizeof(struct zmk_sensor_channel_data) * ev.channel_data_size);
+
+    int err = zmk_split_wired_send(ZMK_SPLIT_WIRED_MSG_SENSOR_EVENT, &ev, sizeof(ev));
+    return err == -ENOTCONN ? 0 : err;
+}
+#endif /* ZMK_KEYMAP_HAS_SENSORS */
+
+static const struct zmk_split_transport_peripheral_api split_wired_peripheral_api = {
+    .send_position_event = send_position_event,
+#if ZMK_KEYMAP_HAS_SENSORS
+    .send_sensor_event = send_sensor_event,
+#endif /* ZMK_KEYMAP_HAS_SENSORS */
+};
+
+ZMK_SPLIT_TRANSPORT_PERIPHERAL_REGISTER(wired, &split_wired_peripheral_api);
+
+static int zmk_split_wired_peripheral_init(void) {
+    return zmk_split_wired_init(wired_peripheral_receive, wired_peripheral_link_changed);
+}
+
+SYS_INIT(zmk_split_wired_peripheral_init, APPLICATION, CONFIG_APPLICATION_INIT_PRIORITY);
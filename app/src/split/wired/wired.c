@@ -0,0 +1,604 @@
+/*
+ * Copyright (c) 2023 The ZMK Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#define DT_DRV_COMPAT zmk_wired_split
+
+#include <string.h>
+#include <zephyr/device.h>
+#include <zephyr/kernel.h>
+#include <zephyr/drivers/uart.h>
+#include <zephyr/sys/atomic.h>
+#include <zephyr/sys/byteorder.h>
+#include <zephyr/sys/crc.h>
+#include <zephyr/logging/log.h>
+
+LOG_MODULE_DECLARE(zmk, CONFIG_ZMK_LOG_LEVEL);
+
+#include <zmk/split/stats.h>
+#include <zmk/split/wired/wired.h>
+
+#if DT_NUM_INST_STATUS_OKAY(DT_DRV_COMPAT) != 1
+#error "Exactly one zmk,wired-split node is required"
+#endif
+
+static const struct device *uart = DEVICE_DT_GET(DT_INST_PHANDLE(0, device));
+
+#define FRAME_HEADER_LEN 2
+#define FRAME_CRC_LEN 2
+#define FRAME_CRC_SEED 0xFFFF
+
+#define RAW_FRAME_LEN(payload_len) (FRAME_HEADER_LEN + (payload_len) + FRAME_CRC_LEN)
+// COBS adds one byte for every 254 bytes of data, plus one more. The zero byte terminating the
+// frame is added after that.
+#define ENCODED_FRAME_LEN(payload_len)                                                             \
+    (RAW_FRAME_LEN(payload_len) + RAW_FRAME_LEN(payload_len) / 254 + 2)
+
+#define RAW_FRAME_MAX_LEN RAW_FRAME_LEN(ZMK_SPLIT_WIRED_MAX_PAYLOAD_LEN)
+#define ENCODED_FRAME_MAX_LEN ENCODED_FRAME_LEN(ZMK_SPLIT_WIRED_MAX_PAYLOAD_LEN)
+
+#define NO_SEQUENCE -1
+
+// There is only a single link, on both halves.
+#define STATS_LINK 0
+
+// Time without receiving anything before the peripheral considers the central gone.
+#define PERIPHERAL_LINK_TIMEOUT_MS (3 * CONFIG_ZMK_SPLIT_WIRED_KEEPALIVE_INTERVAL)
+
+struct wired_msg {
+    uint8_t type;
+    uint16_t len;
+    uint8_t data[ZMK_SPLIT_WIRED_MAX_PAYLOAD_LEN];
+};
+
+struct wired_rx_frame {
+    uint16_t len;
+    uint8_t data[RAW_FRAME_MAX_LEN];
+};
+
+K_MSGQ_DEFINE(wired_tx_msgq, sizeof(struct wired_msg), CONFIG_ZMK_SPLIT_WIRED_TX_QUEUE_SIZE, 4);
+
+K_MSGQ_DEFINE(wired_rx_msgq, sizeof(struct wired_rx_frame), CONFIG_ZMK_SPLIT_WIRED_RX_QUEUE_SIZE,
+              4);
+
+K_THREAD_STACK_DEFINE(wired_work_q_stack, CONFIG_ZMK_SPLIT_WIRED_STACK_SIZE);
+
+static struct k_work_q wired_work_q;
+
+static zmk_split_wired_receive_cb receive_callback;
+static zmk_split_wired_link_cb link_callback;
+
+// Everything below is only used from the wired split work queue, except where noted.
+static bool connected;
+// Uptime in ticks of the last frame received and sent.
+static int64_t last_rx_ticks;
+static int64_t last_tx_ticks;
+
+static uint8_t tx_sequence;
+static int16_t last_rx_sequence = NO_SEQUENCE;
+
+// The message waiting to be acknowledged by the other half.
+static struct {
+    bool active;
+    bool needs_send;
+    uint8_t type;
+    uint8_t sequence;
+    uint8_t retries;
+    size_t len;
+    uint8_t frame[ENCODED_FRAME_MAX_LEN];
+} in_flight;
+
+static bool ack_pending;
+static uint8_t ack_sequence;
+static uint8_t ack_frame[ENCODED_FRAME_LEN(0)];
+
+// Set while the UART is sending, cleared from the UART callback.
+static atomic_t tx_busy;
+static bool awaiting_data_tx_done;
+
+static size_t cobs_encode(const uint8_t *src, size_t len, uint8_t *dst) {
+    size_t code_index = 0;
+    size_t out = 1;
+    uint8_t code = 1;
+
+    for (size_t i = 0; i < len; i++) {
+        if (src[i] != 0) {
+            dst[out++] = src[i];
+            code++;
+        }
+
+        if (src[i] == 0 || code == 0xFF) {
+            dst[code_index] = code;
+            code_index = out++;
+            code = 1;
+        }
+    }
+
+    dst[code_index] = code;
+    dst[out++] = 0;
+
+    return out;
+}
+
+static int cobs_decode(const uint8_t *src, size_t len, uint8_t *dst, size_t size) {
+    size_t in = 0;
+    size_t out = 0;
+
+    while (in < len) {
+        const uint8_t code = src[in++];
+        if (code == 0 || in + code - 1 > len || out + code - 1 > size) {
+            return -EINVAL;
+        }
+
+        for (uint8_t i = 1; i < code; i++) {
+            dst[out++] = src[in++];
+        }
+
+        if (code != 0xFF && in < len) {
+            if (out >= size) {
+                return -EINVAL;
+            }
+            dst[out++] = 0;
+        }
+    }
+
+    return out;
+}
+
+static size_t encode_frame(uint8_t type, uint8_t sequence, const uint8_t *payload, size_t len,
+                           uint8_t *dst) {
+    static uint8_t raw[RAW_FRAME_MAX_LEN];
+
+    raw[0] = type;
+    raw[1] = sequence;
+    if (len > 0) {
+        memcpy(&raw[FRAME_HEADER_LEN], payload, len);
+    }
+
+    const size_t data_len = FRAME_HEADER_LEN + len;
+    sys_put_le16(crc16_ccitt(FRAME_CRC_SEED, raw, data_len), &raw[data_len]);
+
+    return cobs_encode(raw, data_len + FRAME_CRC_LEN, dst);
+}
+
+static void wired_tx_done(void);
+static void wired_rx_bytes(const uint8_t *data, size_t len);
+
+#if IS_ENABLED(CONFIG_ZMK_SPLIT_WIRED_UART_MODE_ASYNC)
+
+// Time without new bytes after which received data is handed over, in microseconds.
+#define ASYNC_RX_TIMEOUT_US 100
+
+static uint8_t async_rx_bufs[2][CONFIG_ZMK_SPLIT_WIRED_ASYNC_RX_BUF_SIZE];
+static uint8_t async_rx_next_buf;
+
+static int wired_async_rx_enable(void) {
+    async_rx_next_buf = 1;
+    return uart_rx_enable(uart, async_rx_bufs[0], sizeof(async_rx_bufs[0]), ASYNC_RX_TIMEOUT_US);
+}
+
+static void wired_async_callback(const struct device *dev, struct uart_event *evt,
+                                 void *user_data) {
+    switch (evt->type) {
+    case UART_TX_DONE:
+    case UART_TX_ABORTED:
+        wired_tx_done();
+        break;
+    case UART_RX_RDY:
+        wired_rx_bytes(evt->data.rx.buf + evt->data.rx.offset, evt->data.rx.len);
+        break;
+    case UART_RX_BUF_REQUEST:
+        uart_rx_buf_rsp(dev, async_rx_bufs[async_rx_next_buf], sizeof(async_rx_bufs[0]));
+        async_rx_next_buf ^= 1;
+        break;
+    case UART_RX_STOPPED:
+        LOG_WRN("UART receive stopped (reason %d)", evt->data.rx_stop.reason);
+        break;
+    case UART_RX_DISABLED:
+        wired_async_rx_enable();
+        break;
+    default:
+        break;
+    }
+}
+
+static int wired_uart_start(void) {
+    int err = uart_callback_set(uart, wired_async_callback, NULL);
+    if (err) {
+        return err;
+    }
+
+    return wired_async_rx_enable();
+}
+
+static int wired_uart_tx(const uint8_t *buf, size_t len) {
+    return uart_tx(uart, buf, len, SYS_FOREVER_US);
+}
+
+#else // IS_ENABLED(CONFIG_ZMK_SPLIT_WIRED_UART_MODE_ASYNC)
+
+static const uint8_t *irq_tx_buf;
+static size_t irq_tx_len;
+static size_t irq_tx_pos;
+
+static void wired_uart_isr(const struct device *dev, void *user_data) {
+    if (!uart_irq_update(dev)) {
+        return;
+    }
+
+    if (uart_irq_rx_ready(dev)) {
+        uint8_t buf[16];
+        int len;
+        while ((len = uart_fifo_read(dev, buf, sizeof(buf))) > 0) {
+            wired_rx_bytes(buf, len);
+        }
+    }
+
+    if (uart_irq_tx_ready(dev)) {
+        if (irq_tx_pos < irq_tx_len) {
+            irq_tx_pos += uart_fifo_fill(dev, irq_tx_buf + irq_tx_pos, irq_tx_len - irq_tx_pos);
+        } else {
+            uart_irq_tx_disable(dev);
+            wired_tx_done();
+        }
+    }
+}
+
+static int wired_uart_start(void) {
+    int err = uart_irq_callback_user_data_set(uart, wired_uart_isr, NULL);
+    if (err) {
+        return err;
+    }
+
+    uart_irq_rx_enable(uart);
+    return 0;
+}
+
+static int wired_uart_tx(const uint8_t *buf, size_t len) {
+    irq_tx_buf = buf;
+    irq_tx_len = len;
+    irq_tx_pos = 0;
+    uart_irq_tx_enable(uart);
+    return 0;
+}
+
+#endif // IS_ENABLED(CONFIG_ZMK_SPLIT_WIRED_UART_MODE_ASYNC)
+
+static void wired_tx_work_callback(struct k_work *work);
+static void wired_rx_work_callback(struct k_work *work);
+static void wired_retransmit_work_callback(struct k_work *work);
+static void wired_keepalive_work_callback(struct k_work *work);
+
+static K_WORK_DEFINE(wired_tx_work, wired_tx_work_callback);
+static K_WORK_DEFINE(wired_rx_work, wired_rx_work_callback);
+static K_WORK_DELAYABLE_DEFINE(wired_retransmit_work, wired_retransmit_work_callback);
+static K_WORK_DELAYABLE_DEFINE(wired_keepalive_work, wired_keepalive_work_callback);
+
+// Called from the UART callback.
+static void wired_tx_done(void) {
+    atomic_clear(&tx_busy);
+    k_work_submit_to_queue(&wired_work_q, &wired_tx_work);
+}
+
+static int wired_start_tx(const uint8_t *buf, size_t len) {
+    atomic_set(&tx_busy, true);
+
+    int err = wired_uart_tx(buf, len);
+    if (err) {
+        LOG_ERR("Failed to send to the other half (err %d)", err);
+        atomic_clear(&tx_busy);
+    }
+
+    return err;
+}
+
+static void set_connected(bool value) {
+    if (connected == value) {
+        return;
+    }
+
+    connected = value;
+    LOG_INF("Wired split link %s", value ? "up" : "down");
+
+    if (value) {
+        zmk_split_stats_link_up(STATS_LINK, NULL);
+    } else {
+        zmk_split_stats_link_down(STATS_LINK);
+    }
+
+    if (link_callback) {
+        link_callback(value);
+    }
+}
+
+static void wired_drop_pending(void) {
+    in_flight.active = false;
+    k_work_cancel_delayable(&wired_retransmit_work);
+    k_msgq_purge(&wired_tx_msgq);
+}
+
+static void wired_tx_work_callback(struct k_work *work) {
+    if (atomic_get(&tx_busy)) {
+        // Called again once the UART is done.
+        return;
+    }
+
+    if (awaiting_data_tx_done) {
+        // Only start waiting for the acknowledgement once the message has actually been sent, so
+        // slow baud rates don't cause needless retransmissions.
+        awaiting_data_tx_done = false;
+        if (in_flight.active) {
+            k_work_reschedule_for_queue(&wired_work_q, &wired_retransmit_work,
+                                        K_USEC(CONFIG_ZMK_SPLIT_WIRED_RETRANSMIT_TIMEOUT_US));
+        }
+    }
+
+    // Acknowledgements go first, so the other half can move on to its next message.
+    if (ack_pending) {
+        ack_pending = false;
+        const size_t len = encode_frame(ZMK_SPLIT_WIRED_MSG_ACK, ack_sequence, NULL, 0, ack_frame);
+        wired_start_tx(ack_frame, len);
+        return;
+    }
+
+    if (!in_flight.active) {
+        struct wired_msg msg;
+        if (k_msgq_get(&wired_tx_msgq, &msg, K_NO_WAIT) != 0) {
+            return;
+        }
+
+        in_flight.active = true;
+        in_flight.needs_send = true;
+        in_flight.type = msg.type;
+        in_flight.sequence = tx_sequence++;
+        in_flight.retries = 0;
+        in_flight.len =
+            encode_frame(msg.type, in_flight.sequence, msg.data, msg.len, in_flight.frame);
+    }
+
+    if (in_flight.needs_send) {
+        in_flight.needs_send = false;
+        last_tx_ticks = k_uptime_ticks();
+
+        if (wired_start_tx(in_flight.frame, in_flight.len) == 0) {
+            awaiting_data_tx_done = true;
+        } else {
+            k_work_reschedule_for_queue(&wired_work_q, &wired_retransmit_work,
+                                        K_USEC(CONFIG_ZMK_SPLIT_WIRED_RETRANSMIT_TIMEOUT_US));
+        }
+    }
+}
+
+static void wired_retransmit_work_callback(struct k_work *work) {
+    if (!in_flight.active) {
+        return;
+    }
+
+    if (in_flight.retries++ >= CONFIG_ZMK_SPLIT_WIRED_MAX_RETRIES) {
+        if (connected) {
+            LOG_WRN("Other half stopped acknowledging messages");
+        }
+        wired_drop_pending();
+        set_connected(false);
+        return;
+    }
+
+    LOG_DBG("Sending message %d again", in_flight.sequence);
+    zmk_split_stats_inc(STATS_LINK, ZMK_SPLIT_STAT_TX_ERROR);
+    in_flight.needs_send = true;
+    wired_tx_work_callback(NULL);
+}
+
+static void wired_handle_frame(const uint8_t *frame, size_t len) {
+    if (len < RAW_FRAME_LEN(0)) {
+        LOG_WRN("Ignoring frame that is too short (%zu)", len);
+        return;
+    }
+
+    const size_t data_len = len - FRAME_CRC_LEN;
+    if (crc16_ccitt(FRAME_CRC_SEED, frame, data_len) != sys_get_le16(&frame[data_len])) {
+        LOG_WRN("Ignoring frame with invalid CRC");
+        return;
+    }
+
+    const uint8_t type = frame[0];
+    const uint8_t sequence = frame[1];
+    last_rx_ticks = k_uptime_ticks();
+
+    if (type == ZMK_SPLIT_WIRED_MSG_ACK) {
+        if (!in_flight.active || sequence != in_flight.sequence) {
+            return;
+        }
+
+        in_flight.active = false;
+        k_work_cancel_delayable(&wired_retransmit_work);
+
+        // The acknowledgement is sent as soon as the other half has the message, so half the
+        // time since the last send is a good estimate of the one-way latency.
+        zmk_split_stats_inc(STATS_LINK, ZMK_SPLIT_STAT_TX);
+        zmk_split_stats_set_latency(STATS_LINK,
+                                    k_ticks_to_us_floor32((last_rx_ticks - last_tx_ticks) / 2));
+
+        if (in_flight.type == ZMK_SPLIT_WIRED_MSG_HELLO) {
+            last_rx_sequence = NO_SEQUENCE;
+            set_connected(true);
+        }
+
+        wired_tx_work_callback(NULL);
+        return;
+    }
+
+    ack_pending = true;
+    ack_sequence = sequence;
+
+    if (type == ZMK_SPLIT_WIRED_MSG_HELLO) {
+        // The central (re)started the link, so anything queued for it before is stale. Report the
+        // link as up even if it already was, so the current state is sent again.
+        wired_drop_pending();
+        last_rx_sequence = sequence;
+        wired_tx_work_callback(NULL);
+
+        connected = false;
+        set_connected(true);
+        return;
+    }
+
+    wired_tx_work_callback(NULL);
+
+    if (sequence == last_rx_sequence) {
+        LOG_DBG("Ignoring repeated message %d", sequence);
+        return;
+    }
+
+    last_rx_sequence = sequence;
+    zmk_split_stats_inc(STATS_LINK, ZMK_SPLIT_STAT_RX);
+
+    if (!connected) {
+        // The central only accepts messages after its hello has been acknowledged, while the
+        // peripheral treats any message from the central as the link coming back.
+        if (IS_ENABLED(CONFIG_ZMK_SPLIT_ROLE_CENTRAL)) {
+            return;
+        }
+        set_connected(true);
+    }
+
+    if (type == ZMK_SPLIT_WIRED_MSG_PING) {
+        return;
+    }
+
+    if (receive_callback) {
+        receive_callback(type, &frame[FRAME_HEADER_LEN], data_len - FRAME_HEADER_LEN);
+    }
+}
+
+static void wired_rx_work_callback(struct k_work *work) {
+    struct wired_rx_frame frame;
+
+    while (k_msgq_get(&wired_rx_msgq, &frame, K_NO_WAIT) == 0) {
+        wired_handle_frame(frame.data, frame.len);
+    }
+}
+
+static uint8_t rx_encoded[ENCODED_FRAME_MAX_LEN];
+static size_t rx_encoded_len;
+static bool rx_discard;
+
+// Called from the UART callback. Collects bytes up to the next frame delimiter and queues the
+// decoded frame. Frames that are dropped here are recovered by the retransmission.
+static void wired_rx_bytes(const uint8_t *data, size_t len) {
+    for (size_t i = 0; i < len; i++) {
+        if (data[i] != 0) {
+            if (rx_encoded_len < sizeof(rx_encoded)) {
+                rx_encoded[rx_encoded_len++] = data[i];
+            } else {
+                rx_discard = true;
+            }
+            continue;
+        }
+
+        if (rx_encoded_len > 0 && !rx_discard) {
+            struct wired_rx_frame frame;
+            const int frame_len =
+                cobs_decode(rx_encoded, rx_encoded_len, frame.data, sizeof(frame.data));
+
+            if (frame_len > 0) {
+                frame.len = frame_len;
+                if (k_msgq_put(&wired_rx_msgq, &frame, K_NO_WAIT) == 0) {
+                    k_work_submit_to_queue(&wired_work_q, &wired_rx_work);
+                } else {
+                    zmk_split_stats_inc(STATS_LINK, ZMK_SPLIT_STAT_QUEUE_DROP);
+                }
+            }
+        }
+
+        rx_encoded_len = 0;
+        rx_discard = false;
+    }
+}
+
+static int wired_queue_msg(uint8_t type, const void *data, size_t len) {
+    struct wired_msg msg = {.type = type, .len = len};
+    if (len > 0) {
+        memcpy(msg.data, data, len);
+    }
+
+    // Queued messages are never discarded to make room, since they may be key releases. The new
+    // message is dropped instead, and position events are resent as a position state by the
+    // peripheral.
+    int err = k_msgq_put(&wired_tx_msgq, &msg, K_NO_WAIT);
+    if (err) {
+        LOG_WRN("Failed to queue message to send (%d)", err);
+        if (type != ZMK_SPLIT_WIRED_MSG_POSITION_EVENT) {
+            zmk_split_stats_inc(STATS_LINK, ZMK_SPLIT_STAT_QUEUE_DROP);
+        }
+        return err;
+    }
+
+    k_work_submit_to_queue(&wired_work_q, &wired_tx_work);
+
+    return 0;
+}
+
+static void wired_keepalive_work_callback(struct k_work *work) {
+    const int64_t now = k_uptime_ticks();
+
+#if IS_ENABLED(CONFIG_ZMK_SPLIT_ROLE_CENTRAL)
+    if (!in_flight.active && k_msgq_num_used_get(&wired_tx_msgq) == 0) {
+        if (!connected) {
+            wired_queue_msg(ZMK_SPLIT_WIRED_MSG_HELLO, NULL, 0);
+        } else if (now - last_tx_ticks >=
+                   k_ms_to_ticks_ceil64(CONFIG_ZMK_SPLIT_WIRED_KEEPALIVE_INTERVAL)) {
+            wired_queue_msg(ZMK_SPLIT_WIRED_MSG_PING, NULL, 0);
+        }
+    }
+#else
+    if (connected && now - last_rx_ticks > k_ms_to_ticks_ceil64(PERIPHERAL_LINK_TIMEOUT_MS)) {
+        LOG_WRN("Central stopped sending messages");
+        wired_drop_pending();
+        set_connected(false);
+    }
+#endif
+
+    k_work_reschedule_for_queue(&wired_work_q, &wired_keepalive_work,
+                                K_MSEC(CONFIG_ZMK_SPLIT_WIRED_KEEPALIVE_INTERVAL));
+}
+
+int zmk_split_wired_send(uint8_t type, const void *data, size_t len) {
+    if (!connected) {
+        return -ENOTCONN;
+    }
+
+    if (len > ZMK_SPLIT_WIRED_MAX_PAYLOAD_LEN) {
+        return -EMSGSIZE;
+    }
+
+    return wired_queue_msg(type, data, len);
+}
+
+bool zmk_split_wired_is_connected(void) { return connected; }
+
+int zmk_split_wired_init(zmk_split_wired_receive_cb receive_cb, zmk_split_wired_link_cb link_cb) {
+    receive_callback = receive_cb;
+    link_callback = link_cb;
+
+    if (!device_is_ready(uart)) {
+        LOG_ERR("UART %s is not ready", uart->name);
+        return -ENODEV;
+    }
+
+    k_work_queue_start(&wired_work_q, wired_work_q_stack,
+                       K_THREAD_STACK_SIZEOF(wired_work_q_stack), CONFIG_ZMK_SPLIT_WIRED_PRIORITY,
+                       NULL);
+
+    int err = wired_uart_start();
+    if (err) {
+        LOG_ERR("Failed to start receiving from UART %s (err %d)", uart->name, err);
+        return err;
+    }
+
+    k_work_reschedule_for_queue(&wired_work_q, &wired_keepalive_work, K_NO_WAIT);
+
+    return 0;
+}
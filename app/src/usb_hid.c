@@ -17,6 +17,9 @@
 #include <zmk/hid_indicators.h>
 #endif // IS_ENABLED(CONFIG_ZMK_HID_INDICATORS)
 #include <zmk/event_manager.h>
+#if IS_ENABLED(CONFIG_ZMK_MOUSE)
+#include <zmk/mouse.h>
+#endif // IS_ENABLED(CONFIG_ZMK_MOUSE)
 
 LOG_MODULE_DECLARE(zmk, CONFIG_ZMK_LOG_LEVEL);
 
@@ -54,9 +57,55 @@ static uint8_t *get_keyboard_report(size_t *len) {
     return (uint8_t *)report;
 }
 
+#if IS_ENABLED(CONFIG_ZMK_MOUSE_SMOOTH_SCROLLING)
+static struct zmk_hid_mouse_resolution_feature_report mouse_resolution_report = {
+    .report_id = ZMK_HID_REPORT_ID_MOUSE};
+
+static int get_mouse_resolution_report(int32_t *len, uint8_t **data) {
+    struct zmk_endpoint_instance endpoint = {
+        .transport = ZMK_TRANSPORT_USB,
+    };
+    struct zmk_mouse_resolution_multipliers multipliers =
+        zmk_mouse_resolution_multipliers_get_profile(endpoint);
+
+    mouse_resolution_report.body.wheel_res = multipliers.wheel;
+    mouse_resolution_report.body.hwheel_res = multipliers.hor_wheel;
+
+    *data = (uint8_t *)&mouse_resolution_report;
+    *len = sizeof(mouse_resolution_report);
+    return 0;
+}
+
+static int set_mouse_resolution_report(int32_t *len, uint8_t **data) {
+    if (*len != sizeof(struct zmk_hid_mouse_resolution_feature_report)) {
+        LOG_ERR("Mouse resolution set report is malformed: length=%d", *len);
+        return -EINVAL;
+    }
+
+    struct zmk_hid_mouse_resolution_feature_report *report =
+        (struct zmk_hid_mouse_resolution_feature_report *)*data;
+    struct zmk_endpoint_instance endpoint = {
+        .transport = ZMK_TRANSPORT_USB,
+    };
+    zmk_mouse_resolution_multipliers_process_report(&report->body, endpoint);
+    return 0;
+}
+
+static bool is_mouse_resolution_report(struct usb_setup_packet *setup) {
+    return (setup->wValue & HID_GET_REPORT_TYPE_MASK) == HID_REPORT_TYPE_FEATURE &&
+           (setup->wValue & HID_GET_REPORT_ID_MASK) == ZMK_HID_REPORT_ID_MOUSE;
+}
+#endif // IS_ENABLED(CONFIG_ZMK_MOUSE_SMOOTH_SCROLLING)
+
 static int get_report_cb(const struct device *dev, struct usb_setup_packet *setup, int32_t *len,
                          uint8_t **data) {
 
+#if IS_ENABLED(CONFIG_ZMK_MOUSE_SMOOTH_SCROLLING)
+    if (is_mouse_resolution_report(setup)) {
+        return get_mouse_resolution_report(len, data);
+    }
+#endif // IS_ENABLED(CONFIG_ZMK_MOUSE_SMOOTH_SCROLLING)
+
     /*
      * 7.2.1 of the HID v1.11 spec is unclear about handling requests for reports that do not exist
      * For requested reports that aren't input reports, return -ENOTSUP like the Zephyr subsys does
@@ -78,6 +127,14 @@ static int get_report_cb(const struct device *dev, struct usb_setup_packet *setu
         *len = sizeof(*report);
         break;
     }
+#if IS_ENABLED(CONFIG_ZMK_MOUSE)
+    case ZMK_HID_REPORT_ID_MOUSE: {
+        struct zmk_hid_mouse_report *report = zmk_hid_get_mouse_report();
+        *data = (uint8_t *)report;
+        *len = sizeof(*report);
+        break;
+    }
+#endif // IS_ENABLED(CONFIG_ZMK_MOUSE)
     default:
         LOG_ERR("Invalid report ID %d requested", setup->wValue & HID_GET_REPORT_ID_MASK);
         return -EINVAL;
@@ -88,6 +145,12 @@ static int get_report_cb(const struct device *dev, struct usb_setup_packet *setu
 
 static int set_report_cb(const struct device *dev, struct usb_setup_packet *setup, int32_t *len,
                          uint8_t **data) {
+#if IS_ENABLED(CONFIG_ZMK_MOUSE_SMOOTH_SCROLLING)
+    if (is_mouse_resolution_report(setup)) {
+        return set_mouse_resolution_report(len, data);
+    }
+#endif // IS_ENABLED(CONFIG_ZMK_MOUSE_SMOOTH_SCROLLING)
+
     if ((setup->wValue & HID_GET_REPORT_TYPE_MASK) != HID_REPORT_TYPE_OUTPUT) {
         LOG_ERR("Unsupported report type %d requested",
                 (setup->wValue & HID_GET_REPORT_TYPE_MASK) >> 8);
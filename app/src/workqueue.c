@@ -9,6 +9,8 @@
 
 #include <zmk/workqueue.h>
 
+#if IS_ENABLED(CONFIG_ZMK_LOW_PRIORITY_WORK_QUEUE)
+
 K_THREAD_STACK_DEFINE(lowprio_q_stack, CONFIG_ZMK_LOW_PRIORITY_THREAD_STACK_SIZE);
 
 static struct k_work_q lowprio_work_q;
@@ -17,10 +19,42 @@ struct k_work_q *zmk_workqueue_lowprio_work_q(void) {
     return &lowprio_work_q;
 }
 
+#endif // IS_ENABLED(CONFIG_ZMK_LOW_PRIORITY_WORK_QUEUE)
+
+#if IS_ENABLED(CONFIG_ZMK_INPUT_WORK_QUEUE)
+
+// Input work must not preempt system work queue items that may touch the same state part way
+// through, so it only ever runs when the current item finishes or yields.
+BUILD_ASSERT(CONFIG_ZMK_INPUT_THREAD_PRIORITY < 0,
+             "The input thread must have a cooperative priority");
+
+K_THREAD_STACK_DEFINE(input_q_stack, CONFIG_ZMK_INPUT_THREAD_STACK_SIZE);
+
+static struct k_work_q input_work_q;
+
+#endif // IS_ENABLED(CONFIG_ZMK_INPUT_WORK_QUEUE)
+
+struct k_work_q *zmk_workqueue_input_work_q(void) {
+#if IS_ENABLED(CONFIG_ZMK_INPUT_WORK_QUEUE)
+    return &input_work_q;
+#else
+    return &k_sys_work_q;
+#endif
+}
+
 static int workqueue_init(void) {
+#if IS_ENABLED(CONFIG_ZMK_LOW_PRIORITY_WORK_QUEUE)
     static const struct k_work_queue_config queue_config = {.name = "Low Priority Work Queue"};
     k_work_queue_start(&lowprio_work_q, lowprio_q_stack, K_THREAD_STACK_SIZEOF(lowprio_q_stack),
                        CONFIG_ZMK_LOW_PRIORITY_THREAD_PRIORITY, &queue_config);
+#endif // IS_ENABLED(CONFIG_ZMK_LOW_PRIORITY_WORK_QUEUE)
+
+#if IS_ENABLED(CONFIG_ZMK_INPUT_WORK_QUEUE)
+    static const struct k_work_queue_config input_queue_config = {.name = "Input Work Queue"};
+    k_work_queue_start(&input_work_q, input_q_stack, K_THREAD_STACK_SIZEOF(input_q_stack),
+                       CONFIG_ZMK_INPUT_THREAD_PRIORITY, &input_queue_config);
+#endif // IS_ENABLED(CONFIG_ZMK_INPUT_WORK_QUEUE)
+
     return 0;
 }
 
@@ -68,6 +68,7 @@ module.exports = {
       "config/encoders",
       "config/keymap",
       "config/kscan",
+      "config/pointing",
       "config/power",
       "config/underglow",
       "config/system",